@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cluster-routing-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+
+#include <set>
+
+namespace ns3 {
+
+ClusterRoutingHelper::ClusterRoutingHelper () {
+  m_agentFactory.SetTypeId ("ns3::ClusterRoutingProtocol");
+}
+
+ClusterRoutingHelper *ClusterRoutingHelper::Copy (void) const {
+  return new ClusterRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol> ClusterRoutingHelper::Create (Ptr<Node> node) const {
+  return m_agentFactory.Create<ClusterRoutingProtocol> ();
+}
+
+void ClusterRoutingHelper::Set (std::string name, const AttributeValue &value) {
+  m_agentFactory.Set (name, value);
+}
+
+int64_t ClusterRoutingHelper::AssignStreams (const NodeContainer &nodes, int64_t stream) {
+  int64_t start = stream;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i) {
+    Ptr<ClusterRoutingProtocol> routing = GetRouting (*i);
+    if (routing != 0) {
+      stream += routing->AssignStreams (stream);
+    }
+  }
+  return stream - start;
+}
+
+void ClusterRoutingHelper::Configure (const HierarchyTopologyHelper &topology) {
+  // Roles first, since backbone devices only go to heads
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    if (channel.kind != HierarchyChannel::CLUSTER) {
+      continue;
+    }
+    Ptr<Node> head = topology.GetClusterHead (channel.cluster);
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      Ptr<ClusterRoutingProtocol> routing = GetRouting (channel.nodes.Get (i));
+      NS_ABORT_MSG_IF (routing == 0, "Node " << channel.nodes.Get (i)->GetId () << " does not run cluster routing");
+      routing->SetCluster (channel.cluster, channel.nodes.Get (i) == head, channel.devices.Get (i));
+    }
+  }
+  std::set<uint32_t> heads;
+  for (uint32_t i = 0; i < topology.GetNClusters (); i++) {
+    heads.insert (topology.GetClusterHead (i)->GetId ());
+  }
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    if (channel.kind == HierarchyChannel::CLUSTER) {
+      continue;
+    }
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      if (heads.count (channel.nodes.Get (i)->GetId ())) {
+        GetRouting (channel.nodes.Get (i))->AddBackboneDevice (channel.devices.Get (i));
+      }
+    }
+  }
+}
+
+Ptr<ClusterRoutingProtocol> ClusterRoutingHelper::GetRouting (Ptr<Node> node) {
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ABORT_MSG_IF (ipv4 == 0, "Node " << node->GetId () << " has no Ipv4 stack");
+  Ptr<Ipv4RoutingProtocol> routing = ipv4->GetRoutingProtocol ();
+  Ptr<ClusterRoutingProtocol> cluster = DynamicCast<ClusterRoutingProtocol> (routing);
+  if (cluster != 0) {
+    return cluster;
+  }
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (routing);
+  if (list == 0) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < list->GetNRoutingProtocols (); i++) {
+    int16_t priority;
+    cluster = DynamicCast<ClusterRoutingProtocol> (list->GetRoutingProtocol (i, priority));
+    if (cluster != 0) {
+      return cluster;
+    }
+  }
+  return 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CLUSTER_ROUTING_HELPER_H
+#define CLUSTER_ROUTING_HELPER_H
+
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "cluster-routing-protocol.h"
+#include "hierarchy-topology-helper.h"
+
+#include <string>
+
+namespace ns3 {
+
+/*
+ * Creates ClusterRoutingProtocol instances for InternetStackHelper and sets
+ * their roles from a HierarchyTopologyHelper: every node joins the cluster
+ * it is a member of, and heads take their layer-1 and upper-layer devices as
+ * backbone for the summaries.
+ */
+class ClusterRoutingHelper : public Ipv4RoutingHelper {
+public:
+  ClusterRoutingHelper ();
+
+  ClusterRoutingHelper *Copy (void) const override;
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override;
+  void Set (std::string name, const AttributeValue &value);
+  int64_t AssignStreams (const NodeContainer &nodes, int64_t stream);
+
+  // Before the simulation starts; addresses may still be unassigned.
+  static void Configure (const HierarchyTopologyHelper &topology);
+  // Zero if the node does not run the protocol.
+  static Ptr<ClusterRoutingProtocol> GetRouting (Ptr<Node> node);
+
+private:
+  ObjectFactory m_agentFactory;
+};
+
+} // namespace ns3
+
+#endif /* CLUSTER_ROUTING_HELPER_H */
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "control-overhead-monitor.h"
+
+#include "ns3/ipv4.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ControlOverheadMonitor");
+
+bool ControlOverheadMonitor::Key::operator< (const Key &other) const {
+  if (node != other.node) {
+    return node < other.node;
+  }
+  if (interface != other.interface) {
+    return interface < other.interface;
+  }
+  return type < other.type;
+}
+
+bool ControlOverheadMonitor::Counters::operator== (const Counters &other) const {
+  return txPackets == other.txPackets && txBytes == other.txBytes
+         && rxPackets == other.rxPackets && rxBytes == other.rxBytes;
+}
+
+ControlOverheadMonitor::ControlOverheadMonitor () {
+  m_unknown.layer = 0;
+  m_unknown.channel = "none";
+}
+
+ControlOverheadMonitor::Counters ControlOverheadMonitor::Zero (void) {
+  Counters counters;
+  counters.txPackets = 0;
+  counters.txBytes = 0;
+  counters.rxPackets = 0;
+  counters.rxBytes = 0;
+  return counters;
+}
+
+void ControlOverheadMonitor::SetTopology (const HierarchyTopologyHelper &topology) {
+  m_slots.clear ();
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    Slot slot;
+    slot.layer = channel.layer;
+    slot.channel = channel.kind == HierarchyChannel::FLAT ? "flat"
+      : channel.kind == HierarchyChannel::CLUSTER ? "cluster" : "upper";
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      Ptr<Ipv4> ipv4 = channel.nodes.Get (i)->GetObject<Ipv4> ();
+      int32_t interface = ipv4->GetInterfaceForDevice (channel.devices.Get (i));
+      if (interface >= 0) {
+        m_slots[std::make_pair (channel.nodes.Get (i)->GetId (), static_cast<uint32_t> (interface))] = slot;
+      }
+    }
+  }
+}
+
+void ControlOverheadMonitor::AddColumns (Ptr<MetricsSink> sink) {
+  sink->AddColumn ("SimulationSecond", MetricsSink::DOUBLE);
+  sink->AddColumn ("Node", MetricsSink::INTEGER);
+  sink->AddColumn ("Interface", MetricsSink::INTEGER);
+  sink->AddColumn ("Layer", MetricsSink::INTEGER);
+  sink->AddColumn ("Channel", MetricsSink::STRING);
+  sink->AddColumn ("MessageType", MetricsSink::STRING);
+  sink->AddColumn ("TxPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("TxBytes", MetricsSink::INTEGER);
+  sink->AddColumn ("RxPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("RxBytes", MetricsSink::INTEGER);
+}
+
+void ControlOverheadMonitor::SetSink (Ptr<MetricsSink> sink) {
+  m_sink = sink;
+}
+
+ControlOverheadMonitor::Entry &ControlOverheadMonitor::GetEntry (uint32_t node, uint32_t interface,
+                                                                  RoutingProtocolFactory::ControlType type) {
+  Key key;
+  key.node = node;
+  key.interface = interface;
+  key.type = type;
+  std::map<Key, Entry>::iterator it = m_entries.find (key);
+  if (it == m_entries.end ()) {
+    Entry entry;
+    entry.total = Zero ();
+    entry.exported = Zero ();
+    it = m_entries.insert (std::make_pair (key, entry)).first;
+  }
+  return it->second;
+}
+
+const ControlOverheadMonitor::Slot &ControlOverheadMonitor::GetSlot (uint32_t node, uint32_t interface) const {
+  std::map<std::pair<uint32_t, uint32_t>, Slot>::const_iterator it = m_slots.find (std::make_pair (node, interface));
+  return it == m_slots.end () ? m_unknown : it->second;
+}
+
+void ControlOverheadMonitor::Tx (uint32_t node, uint32_t interface,
+                                 const std::vector<RoutingProtocolFactory::ControlMessage> &messages) {
+  for (std::size_t i = 0; i < messages.size (); i++) {
+    Counters &counters = GetEntry (node, interface, messages[i].type).total;
+    counters.txPackets++;
+    counters.txBytes += messages[i].bytes;
+  }
+}
+
+void ControlOverheadMonitor::Rx (uint32_t node, uint32_t interface,
+                                 const std::vector<RoutingProtocolFactory::ControlMessage> &messages) {
+  for (std::size_t i = 0; i < messages.size (); i++) {
+    Counters &counters = GetEntry (node, interface, messages[i].type).total;
+    counters.rxPackets++;
+    counters.rxBytes += messages[i].bytes;
+  }
+}
+
+void ControlOverheadMonitor::Export (void) {
+  double now = Simulator::Now ().GetSeconds ();
+  for (std::map<Key, Entry>::iterator it = m_entries.begin (); it != m_entries.end (); ++it) {
+    Entry &entry = it->second;
+    if (entry.total == entry.exported) {
+      continue;
+    }
+    if (m_sink != 0) {
+      const Slot &slot = GetSlot (it->first.node, it->first.interface);
+      m_sink->BeginRow ();
+      m_sink->Add (now);
+      m_sink->Add (static_cast<int64_t> (it->first.node));
+      m_sink->Add (static_cast<int64_t> (it->first.interface));
+      m_sink->Add (static_cast<int64_t> (slot.layer));
+      m_sink->Add (slot.channel);
+      m_sink->Add (RoutingProtocolFactory::GetControlTypeName (it->first.type));
+      m_sink->Add (static_cast<int64_t> (entry.total.txPackets - entry.exported.txPackets));
+      m_sink->Add (static_cast<int64_t> (entry.total.txBytes - entry.exported.txBytes));
+      m_sink->Add (static_cast<int64_t> (entry.total.rxPackets - entry.exported.rxPackets));
+      m_sink->Add (static_cast<int64_t> (entry.total.rxBytes - entry.exported.rxBytes));
+      m_sink->EndRow ();
+    }
+    entry.exported = entry.total;
+  }
+}
+
+void ControlOverheadMonitor::Summarize (void) const {
+  std::map<std::string, Counters> totals;
+  for (std::map<Key, Entry>::const_iterator it = m_entries.begin (); it != m_entries.end (); ++it) {
+    const Slot &slot = GetSlot (it->first.node, it->first.interface);
+    std::ostringstream name;
+    name << "layer " << slot.layer << " " << slot.channel << " "
+         << RoutingProtocolFactory::GetControlTypeName (it->first.type);
+    std::map<std::string, Counters>::iterator total = totals.find (name.str ());
+    if (total == totals.end ()) {
+      total = totals.insert (std::make_pair (name.str (), Zero ())).first;
+    }
+    total->second.txPackets += it->second.total.txPackets;
+    total->second.txBytes += it->second.total.txBytes;
+    total->second.rxPackets += it->second.total.rxPackets;
+    total->second.rxBytes += it->second.total.rxBytes;
+  }
+  for (std::map<std::string, Counters>::const_iterator it = totals.begin (); it != totals.end (); ++it) {
+    NS_LOG_UNCOND ("Routing control on " << it->first << ": " << it->second.txPackets << " sent ("
+                   << it->second.txBytes << " bytes), " << it->second.rxPackets << " received ("
+                   << it->second.rxBytes << " bytes)");
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CONTROL_OVERHEAD_MONITOR_H
+#define CONTROL_OVERHEAD_MONITOR_H
+
+#include "ns3/ptr.h"
+#include "hierarchy-topology-helper.h"
+#include "metrics-sink.h"
+#include "routing-protocol-factory.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Counts the routing control traffic per node, interface and message type,
+ * fed from Ipv4L3Protocol's Tx and Rx traces. Every control packet sent is
+ * received once per neighbor on the channel, and each reception costs PHY,
+ * MAC and IP events there, so the Rx counts stand for the event load a
+ * message type causes.
+ *
+ * Export writes one row per counter that changed since the previous call,
+ * tagged with the layer and channel kind of the interface. Summarize prints
+ * the totals per layer, channel kind and message type.
+ */
+class ControlOverheadMonitor {
+public:
+  ControlOverheadMonitor ();
+
+  // Layer and channel of every interface; after the addresses are assigned.
+  void SetTopology (const HierarchyTopologyHelper &topology);
+
+  // Adds the monitor's columns to a sink that is not open yet.
+  static void AddColumns (Ptr<MetricsSink> sink);
+  // 0 only keeps the totals.
+  void SetSink (Ptr<MetricsSink> sink);
+
+  void Tx (uint32_t node, uint32_t interface, const std::vector<RoutingProtocolFactory::ControlMessage> &messages);
+  void Rx (uint32_t node, uint32_t interface, const std::vector<RoutingProtocolFactory::ControlMessage> &messages);
+
+  void Export (void);
+  void Summarize (void) const;
+
+private:
+  struct Key {
+    uint32_t node;
+    uint32_t interface;
+    RoutingProtocolFactory::ControlType type;
+
+    bool operator< (const Key &other) const;
+  };
+
+  struct Counters {
+    uint64_t txPackets;
+    uint64_t txBytes;
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+
+    bool operator== (const Counters &other) const;
+  };
+
+  struct Entry {
+    Counters total;
+    Counters exported;
+  };
+
+  struct Slot {
+    uint32_t layer;
+    std::string channel;
+  };
+
+  static Counters Zero (void);
+  Entry &GetEntry (uint32_t node, uint32_t interface, RoutingProtocolFactory::ControlType type);
+  const Slot &GetSlot (uint32_t node, uint32_t interface) const;
+
+  Ptr<MetricsSink> m_sink;
+  std::map<std::pair<uint32_t, uint32_t>, Slot> m_slots;   // (node, interface)
+  std::map<Key, Entry> m_entries;
+  Slot m_unknown;
+};
+
+} // namespace ns3
+
+#endif /* CONTROL_OVERHEAD_MONITOR_H */
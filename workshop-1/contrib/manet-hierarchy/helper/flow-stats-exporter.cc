@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flow-stats-exporter.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowStatsExporter");
+
+FlowStatsExporter::FlowStatsExporter ()
+  : m_interval (Seconds (1.0)),
+    m_lossTimeout (Seconds (10.0)),
+    m_maxInFlight (0),
+    m_cappedLost (0),
+    m_maxTracked (0)
+{
+}
+
+void FlowStatsExporter::SetInterval (Time interval) {
+  m_interval = interval;
+}
+
+void FlowStatsExporter::SetLossTimeout (Time timeout) {
+  m_lossTimeout = timeout;
+}
+
+void FlowStatsExporter::SetMaxInFlight (uint64_t packets) {
+  m_maxInFlight = packets;
+}
+
+void FlowStatsExporter::AddColumns (Ptr<MetricsSink> sink) {
+  sink->AddColumn ("SimulationSecond", MetricsSink::DOUBLE);
+  sink->AddColumn ("FlowId", MetricsSink::INTEGER);
+  sink->AddColumn ("Source", MetricsSink::STRING);
+  sink->AddColumn ("Destination", MetricsSink::STRING);
+  sink->AddColumn ("TxPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("RxPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("TxBytes", MetricsSink::INTEGER);
+  sink->AddColumn ("RxBytes", MetricsSink::INTEGER);
+  sink->AddColumn ("DelaySum", MetricsSink::DOUBLE);
+  sink->AddColumn ("JitterSum", MetricsSink::DOUBLE);
+  sink->AddColumn ("LostPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("DroppedPackets", MetricsSink::INTEGER);
+  sink->AddColumn ("InFlight", MetricsSink::INTEGER);
+}
+
+void FlowStatsExporter::SetSink (Ptr<MetricsSink> sink) {
+  m_sink = sink;
+}
+
+void FlowStatsExporter::Start (Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier) {
+  NS_ABORT_MSG_IF (!m_interval.IsStrictlyPositive (), "Flow statistics need a positive interval");
+  NS_ABORT_MSG_IF (m_sink == 0, "Flow statistics need a sink");
+  m_monitor = monitor;
+  m_classifier = classifier;
+  m_last.clear ();
+  m_lastExport = Simulator::Now ();
+  m_cappedLost = 0;
+  m_maxTracked = 0;
+  m_event = Simulator::Schedule (m_interval, &FlowStatsExporter::Export, this);
+}
+
+void FlowStatsExporter::Stop (void) {
+  if (m_monitor == 0) {
+    return;
+  }
+  m_event.Cancel ();
+  if (Simulator::Now () > m_lastExport) {
+    Export ();
+    m_event.Cancel ();
+  }
+  m_monitor = 0;
+  m_classifier = 0;
+}
+
+uint64_t FlowStatsExporter::GetCappedLost (void) const {
+  return m_cappedLost;
+}
+
+uint64_t FlowStatsExporter::GetMaxTracked (void) const {
+  return m_maxTracked;
+}
+
+FlowStatsExporter::Totals FlowStatsExporter::GetTotals (const FlowMonitor::FlowStats &stats) {
+  Totals totals;
+  totals.txPackets = stats.txPackets;
+  totals.rxPackets = stats.rxPackets;
+  totals.txBytes = stats.txBytes;
+  totals.rxBytes = stats.rxBytes;
+  totals.delaySum = stats.delaySum.GetNanoSeconds ();
+  totals.jitterSum = stats.jitterSum.GetNanoSeconds ();
+  totals.lostPackets = stats.lostPackets;
+  totals.droppedPackets = 0;
+  for (std::size_t i = 0; i < stats.packetsDropped.size (); i++) {
+    totals.droppedPackets += stats.packetsDropped[i];
+  }
+  return totals;
+}
+
+// Packets FlowMonitor still tracks: sent, but neither received, dropped nor lost
+static uint64_t GetInFlight (const FlowMonitor::FlowStats &stats) {
+  uint64_t done = stats.rxPackets + stats.lostPackets;
+  for (std::size_t i = 0; i < stats.packetsDropped.size (); i++) {
+    done += stats.packetsDropped[i];
+  }
+  return stats.txPackets > done ? stats.txPackets - done : 0;
+}
+
+static uint64_t CountInFlight (const FlowMonitor::FlowStatsContainer &stats) {
+  uint64_t inFlight = 0;
+  for (FlowMonitor::FlowStatsContainer::const_iterator it = stats.begin (); it != stats.end (); ++it) {
+    inFlight += GetInFlight (it->second);
+  }
+  return inFlight;
+}
+
+void FlowStatsExporter::Sweep (void) {
+  m_monitor->CheckForLostPackets (m_lossTimeout);
+  const FlowMonitor::FlowStatsContainer &stats = m_monitor->GetFlowStats ();
+  uint64_t inFlight = CountInFlight (stats);
+  m_maxTracked = std::max (m_maxTracked, inFlight);
+
+  Time timeout = m_lossTimeout;
+  while (m_maxInFlight > 0 && inFlight > m_maxInFlight && timeout > MilliSeconds (1)) {
+    timeout = NanoSeconds (timeout.GetNanoSeconds () / 2);
+    m_monitor->CheckForLostPackets (timeout);
+    uint64_t left = CountInFlight (stats);
+    m_cappedLost += inFlight - left;
+    inFlight = left;
+  }
+}
+
+void FlowStatsExporter::Export (void) {
+  Sweep ();
+  double now = Simulator::Now ().GetSeconds ();
+  const FlowMonitor::FlowStatsContainer &stats = m_monitor->GetFlowStats ();
+  for (FlowMonitor::FlowStatsContainer::const_iterator it = stats.begin (); it != stats.end (); ++it) {
+    Totals totals = GetTotals (it->second);
+    std::map<FlowId, Totals>::iterator last = m_last.find (it->first);
+    Totals previous = Totals ();
+    if (last != m_last.end ()) {
+      previous = last->second;
+    }
+    if (totals.txPackets == previous.txPackets && totals.rxPackets == previous.rxPackets
+        && totals.lostPackets == previous.lostPackets && totals.droppedPackets == previous.droppedPackets) {
+      continue;
+    }
+
+    Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow (it->first);
+    std::ostringstream source;
+    std::ostringstream destination;
+    source << t.sourceAddress << ":" << t.sourcePort;
+    destination << t.destinationAddress << ":" << t.destinationPort;
+
+    m_sink->BeginRow ();
+    m_sink->Add (now);
+    m_sink->Add (static_cast<int64_t> (it->first));
+    m_sink->Add (source.str ());
+    m_sink->Add (destination.str ());
+    m_sink->Add (static_cast<int64_t> (totals.txPackets - previous.txPackets));
+    m_sink->Add (static_cast<int64_t> (totals.rxPackets - previous.rxPackets));
+    m_sink->Add (static_cast<int64_t> (totals.txBytes - previous.txBytes));
+    m_sink->Add (static_cast<int64_t> (totals.rxBytes - previous.rxBytes));
+    m_sink->Add ((totals.delaySum - previous.delaySum) * 1e-9);
+    m_sink->Add ((totals.jitterSum - previous.jitterSum) * 1e-9);
+    m_sink->Add (static_cast<int64_t> (totals.lostPackets - previous.lostPackets));
+    m_sink->Add (static_cast<int64_t> (totals.droppedPackets - previous.droppedPackets));
+    m_sink->Add (static_cast<int64_t> (GetInFlight (it->second)));
+    m_sink->EndRow ();
+    m_last[it->first] = totals;
+  }
+  m_lastExport = Simulator::Now ();
+  m_event = Simulator::Schedule (m_interval, &FlowStatsExporter::Export, this);
+}
+
+} // namespace ns3
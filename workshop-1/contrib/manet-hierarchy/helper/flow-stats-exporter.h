@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOW_STATS_EXPORTER_H
+#define FLOW_STATS_EXPORTER_H
+
+#include "ns3/event-id.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "metrics-sink.h"
+
+#include <map>
+
+namespace ns3 {
+
+/*
+ * Streams FlowMonitor statistics while the run is going: every Interval it
+ * sweeps for lost packets with LossTimeout and writes one row per flow that
+ * changed, holding the tx/rx packets and bytes, delay and jitter sums, lost
+ * and dropped packets since the previous row.
+ *
+ * FlowMonitor tracks every packet in flight until it is received, dropped or
+ * swept as lost. With MaxInFlight set, sweeps are repeated with a halved
+ * timeout while more packets than that are still tracked, so memory stays
+ * bounded on long runs at the price of counting slow packets as lost.
+ */
+class FlowStatsExporter {
+public:
+  FlowStatsExporter ();
+
+  void SetInterval (Time interval);
+  void SetLossTimeout (Time timeout);
+  // 0 tracks every packet for the full LossTimeout.
+  void SetMaxInFlight (uint64_t packets);
+
+  // Adds the exporter's columns to a sink that is not open yet.
+  static void AddColumns (Ptr<MetricsSink> sink);
+  // Replaces the output, e.g. in a forked child.
+  void SetSink (Ptr<MetricsSink> sink);
+
+  void Start (Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier);
+  // Writes the last partial interval and stops the sweeps.
+  void Stop (void);
+
+  // Packets swept as lost because of MaxInFlight.
+  uint64_t GetCappedLost (void) const;
+  // Most packets tracked at once after a regular sweep.
+  uint64_t GetMaxTracked (void) const;
+
+private:
+  struct Totals {
+    uint64_t txPackets;
+    uint64_t rxPackets;
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    int64_t delaySum;   // ns
+    int64_t jitterSum;  // ns
+    uint64_t lostPackets;
+    uint64_t droppedPackets;
+  };
+
+  static Totals GetTotals (const FlowMonitor::FlowStats &stats);
+  void Sweep (void);
+  void Export (void);
+
+  Time m_interval;
+  Time m_lossTimeout;
+  uint64_t m_maxInFlight;
+  Ptr<FlowMonitor> m_monitor;
+  Ptr<Ipv4FlowClassifier> m_classifier;
+  Ptr<MetricsSink> m_sink;
+  std::map<FlowId, Totals> m_last;
+  Time m_lastExport;
+  EventId m_event;
+  uint64_t m_cappedLost;
+  uint64_t m_maxTracked;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_STATS_EXPORTER_H */
@@ -0,0 +1,358 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "hierarchy-topology-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/cached-propagation-loss-model.h"
+#include "ns3/double.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/log.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/pointer.h"
+#include "ns3/position-allocator.h"
+#include "ns3/spatial-yans-wifi-channel.h"
+#include "ns3/string.h"
+
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HierarchyTopologyHelper");
+
+HierarchyTopologyHelper::HierarchyTopologyHelper ()
+  : m_txp (7.5),
+    m_phyMode ("DsssRate11Mbps"),
+    m_width (500.0),
+    m_height (500.0),
+    m_nodeSpeed (20.0),
+    m_nodePause (0.0),
+    m_minSpeed (0.0),
+    m_steadyState (false),
+    m_spatialCulling (false),
+    m_lossCacheErrorDb (0.0),
+    m_batchRxPower (false),
+    m_verifyBatch (false)
+{
+  m_headRng = CreateObject<UniformRandomVariable> ();
+}
+
+void HierarchyTopologyHelper::SetLayerSpec (const LayerSpec &spec) {
+  m_spec = spec;
+}
+
+void HierarchyTopologyHelper::SetTxPower (double txp) {
+  m_txp = txp;
+}
+
+void HierarchyTopologyHelper::SetPhyMode (std::string phyMode) {
+  m_phyMode = phyMode;
+}
+
+void HierarchyTopologyHelper::SetArea (double width, double height) {
+  m_width = width;
+  m_height = height;
+}
+
+void HierarchyTopologyHelper::SetMobility (double nodeSpeed, double nodePause) {
+  m_nodeSpeed = nodeSpeed;
+  m_nodePause = nodePause;
+}
+
+void HierarchyTopologyHelper::SetMinSpeed (double minSpeed) {
+  m_minSpeed = minSpeed;
+}
+
+void HierarchyTopologyHelper::SetSteadyStateMobility (bool steady) {
+  m_steadyState = steady;
+}
+
+void HierarchyTopologyHelper::SetSpatialCulling (bool culling) {
+  m_spatialCulling = culling;
+}
+
+void HierarchyTopologyHelper::SetLossCache (double maxErrorDb) {
+  m_lossCacheErrorDb = maxErrorDb;
+}
+
+void HierarchyTopologyHelper::SetBatchRxPower (bool batch, bool verify) {
+  m_batchRxPower = batch;
+  m_verifyBatch = verify;
+}
+
+int64_t HierarchyTopologyHelper::Create (int64_t stream) {
+  NS_ABORT_MSG_IF (m_spec.GetNTiers () == 0, "No layer spec set");
+  NS_LOG_INFO ("Building hierarchy " << m_spec.ToString () << " with " << m_spec.GetNTotalNodes () << " nodes");
+
+  uint32_t nTotalNodes = m_spec.GetNTotalNodes ();
+  uint32_t nClusters = m_spec.GetNClusters ();
+  uint32_t nTiers = m_spec.GetNTiers ();
+
+  m_nodes.Create (nTotalNodes);
+  m_clusters.reserve (nClusters);
+  m_clusterTier.reserve (nClusters);
+  m_clusterHead.reserve (nClusters);
+  m_nodeCluster.resize (nTotalNodes);
+  m_channels.reserve (1 + nClusters + nTiers);
+  m_layerChannel.assign (m_spec.GetNLayers () + 1, 0);
+
+  // Only random heads take a stream, so the first-node presets keep the
+  // original scenarios' mobility streams from 0
+  if (m_spec.GetHeadSelection () == LayerSpec::HEAD_RANDOM) {
+    m_headRng->SetStream (stream++);
+  }
+
+  // Tiers are consecutive blocks of nodes, clusters consecutive slices of a tier
+  std::vector<uint32_t> tierFirstNode;
+  uint32_t next = 0;
+  for (uint32_t t = 0; t < nTiers; t++) {
+    const ClusterTier &tier = m_spec.GetTier (t);
+    tierFirstNode.push_back (next);
+    for (uint32_t c = 0; c < tier.nClusters; c++) {
+      NodeContainer cluster;
+      for (uint32_t i = 0; i < tier.nNodes; i++) {
+        cluster.Add (m_nodes.Get (next));
+        m_nodeCluster[next] = m_clusters.size ();
+        next++;
+      }
+      uint32_t head = 0;
+      if (m_spec.GetHeadSelection () == LayerSpec::HEAD_RANDOM) {
+        head = m_headRng->GetInteger (0, tier.nNodes - 1);
+      }
+      m_clusters.push_back (cluster);
+      m_clusterTier.push_back (t);
+      m_clusterHead.push_back (head);
+    }
+  }
+  tierFirstNode.push_back (next);
+
+  m_wifi.SetStandard (WIFI_STANDARD_80211b);
+  m_wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                  "DataMode", StringValue (m_phyMode),
+                                  "ControlMode", StringValue (m_phyMode));
+  m_mac.SetType ("ns3::AdhocWifiMac");
+  m_phy.Set ("TxPowerStart", DoubleValue (m_txp));
+  m_phy.Set ("TxPowerEnd", DoubleValue (m_txp));
+  m_channelHelper.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  if (m_lossCacheErrorDb > 0) {
+    m_channelHelper.AddPropagationLoss ("ns3::CachedPropagationLossModel",
+                                        "Model", StringValue ("ns3::FriisPropagationLossModel"),
+                                        "MaxErrorDb", DoubleValue (m_lossCacheErrorDb));
+  }
+  else {
+    m_channelHelper.AddPropagationLoss ("ns3::FriisPropagationLossModel");
+  }
+  // Only the layer-1 channel is ever spatial
+  m_channelHelper.SetChannelAttribute ("Culling", BooleanValue (m_spatialCulling));
+  m_channelHelper.SetChannelAttribute ("BatchRxPower", BooleanValue (m_batchRxPower));
+  m_channelHelper.SetChannelAttribute ("VerifyBatch", BooleanValue (m_verifyBatch));
+
+  AddChannel (HierarchyChannel::FLAT, 1, 0, m_nodes);
+  for (uint32_t c = 0; c < nClusters; c++) {
+    AddChannel (HierarchyChannel::CLUSTER, m_clusterTier[c] + 1, c, m_clusters[c]);
+  }
+  // Every tier after the first is a layer of its own
+  for (uint32_t t = 1; t < nTiers; t++) {
+    NodeContainer layer;
+    for (uint32_t i = tierFirstNode[t]; i < tierFirstNode[t + 1]; i++) {
+      layer.Add (m_nodes.Get (i));
+    }
+    AddChannel (HierarchyChannel::UPPER, t + 1, 0, layer);
+  }
+  // The heads of the last tier form the top layer
+  NodeContainer top;
+  for (uint32_t c = 0; c < nClusters; c++) {
+    if (m_clusterTier[c] == nTiers - 1) {
+      top.Add (GetClusterHead (c));
+    }
+  }
+  AddChannel (HierarchyChannel::UPPER, nTiers + 1, 0, top);
+
+  InstallMobility (stream);
+  return stream;
+}
+
+void HierarchyTopologyHelper::AddChannel (HierarchyChannel::Kind kind, uint32_t layer, uint32_t cluster, const NodeContainer &nodes) {
+  HierarchyChannel ch;
+  ch.kind = kind;
+  ch.layer = layer;
+  ch.cluster = cluster;
+  ch.nodes = nodes;
+  m_channelHelper.SetCulling (kind == HierarchyChannel::FLAT && (m_spatialCulling || m_batchRxPower));
+  ch.channel = m_channelHelper.Create (ch.loss);
+  m_phy.SetChannel (ch.channel);
+  ch.devices = m_wifi.Install (m_phy, m_mac, nodes);
+  if (kind != HierarchyChannel::CLUSTER) {
+    m_layerChannel[layer] = m_channels.size ();
+  }
+  m_channels.push_back (ch);
+}
+
+void HierarchyTopologyHelper::InstallMobility (int64_t &stream) {
+  MobilityHelper mobilityAdhoc;
+
+  std::ostringstream ssX;
+  ssX << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_width << "]";
+  std::ostringstream ssY;
+  ssY << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_height << "]";
+
+  ObjectFactory pos;
+  pos.SetTypeId ("ns3::RandomRectanglePositionAllocator");
+  pos.Set ("X", StringValue (ssX.str ()));
+  pos.Set ("Y", StringValue (ssY.str ()));
+  Ptr<PositionAllocator> taPositionAlloc = pos.Create ()->GetObject<PositionAllocator> ();
+  stream += taPositionAlloc->AssignStreams (stream);
+  m_positionAlloc = taPositionAlloc;
+
+  NS_ABORT_MSG_IF (m_minSpeed < 0 || m_minSpeed > m_nodeSpeed,
+                   "Minimum speed " << m_minSpeed << " outside [0, " << m_nodeSpeed << "] m/s");
+  if (m_steadyState) {
+    // The model draws the initial position, first destination and speed from
+    // the stationary distribution when it starts; the speed density 1/v has
+    // no finite mean down to 0, hence the floor.
+    NS_ABORT_MSG_IF (m_minSpeed <= 0, "Steady-state RandomWaypoint needs a positive minimum speed");
+    mobilityAdhoc.SetMobilityModel ("ns3::SteadyStateRandomWaypointMobilityModel",
+                                    "MinSpeed", DoubleValue (m_minSpeed),
+                                    "MaxSpeed", DoubleValue (m_nodeSpeed),
+                                    "MinPause", DoubleValue (m_nodePause),
+                                    "MaxPause", DoubleValue (m_nodePause),
+                                    "MinX", DoubleValue (0.0),
+                                    "MaxX", DoubleValue (m_width),
+                                    "MinY", DoubleValue (0.0),
+                                    "MaxY", DoubleValue (m_height));
+  }
+  else {
+    std::ostringstream ssSpeed;
+    ssSpeed << "ns3::UniformRandomVariable[Min=" << m_minSpeed << "|Max=" << m_nodeSpeed << "]";
+    std::ostringstream ssPause;
+    ssPause << "ns3::ConstantRandomVariable[Constant=" << m_nodePause << "]";
+    mobilityAdhoc.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+                                    "Speed", StringValue (ssSpeed.str ()),
+                                    "Pause", StringValue (ssPause.str ()),
+                                    "PositionAllocator", PointerValue (taPositionAlloc));
+  }
+  mobilityAdhoc.SetPositionAllocator (taPositionAlloc);
+  mobilityAdhoc.Install (m_nodes);
+  stream += mobilityAdhoc.AssignStreams (m_nodes, stream);
+
+  m_mobilityStore = CreateObject<MobilityStore> ();
+  m_mobilityStore->SetBounds (Box (0.0, m_width, 0.0, m_height,
+                                   -std::numeric_limits<double>::infinity (), std::numeric_limits<double>::infinity ()));
+  for (NodeContainer::Iterator i = m_nodes.Begin (); i != m_nodes.End (); ++i) {
+    m_mobilityStore->Add ((*i)->GetObject<MobilityModel> ());
+  }
+  for (std::vector<HierarchyChannel>::const_iterator ch = m_channels.begin (); ch != m_channels.end (); ++ch) {
+    Ptr<SpatialYansWifiChannel> spatial = DynamicCast<SpatialYansWifiChannel> (ch->channel);
+    if (spatial != 0) {
+      spatial->SetMobilityStore (m_mobilityStore);
+    }
+  }
+}
+
+int64_t HierarchyTopologyHelper::Reseed (int64_t stream) {
+  stream += m_positionAlloc->AssignStreams (stream);
+  MobilityHelper mobility;
+  stream += mobility.AssignStreams (m_nodes, stream);
+  // Setting a position would restart a steady-state model on a plain leg
+  if (!m_steadyState) {
+    for (NodeContainer::Iterator i = m_nodes.Begin (); i != m_nodes.End (); ++i) {
+      (*i)->GetObject<MobilityModel> ()->SetPosition (m_positionAlloc->GetNext ());
+    }
+  }
+  for (std::vector<HierarchyChannel>::const_iterator ch = m_channels.begin (); ch != m_channels.end (); ++ch) {
+    stream += m_wifi.AssignStreams (ch->devices, stream);
+  }
+  return stream;
+}
+
+void HierarchyTopologyHelper::AssignAddresses (void) {
+  Ipv4AddressHelper ipv4;
+  uint32_t network = Ipv4Address ("10.1.1.0").Get ();
+  for (std::vector<HierarchyChannel>::iterator ch = m_channels.begin (); ch != m_channels.end (); ++ch) {
+    // Smallest aligned block that fits the channel, never below a /24
+    uint32_t size = 256;
+    while (size < ch->nodes.GetN () + 2) {
+      size <<= 1;
+    }
+    network = (network + size - 1) & ~(size - 1);
+    ipv4.SetBase (Ipv4Address (network), Ipv4Mask (~(size - 1)));
+    ch->interfaces = ipv4.Assign (ch->devices);
+    network += size;
+  }
+}
+
+const NodeContainer &HierarchyTopologyHelper::GetNodes (void) const {
+  return m_nodes;
+}
+
+uint32_t HierarchyTopologyHelper::GetNLayers (void) const {
+  return m_spec.GetNLayers ();
+}
+
+const NodeContainer &HierarchyTopologyHelper::GetLayerNodes (uint32_t layer) const {
+  NS_ABORT_MSG_IF (layer < 1 || layer > GetNLayers (), "No layer " << layer);
+  return m_channels[m_layerChannel[layer]].nodes;
+}
+
+const Ipv4InterfaceContainer &HierarchyTopologyHelper::GetLayerInterfaces (uint32_t layer) const {
+  NS_ABORT_MSG_IF (layer < 1 || layer > GetNLayers (), "No layer " << layer);
+  return m_channels[m_layerChannel[layer]].interfaces;
+}
+
+uint32_t HierarchyTopologyHelper::GetNClusters (void) const {
+  return m_clusters.size ();
+}
+
+const NodeContainer &HierarchyTopologyHelper::GetCluster (uint32_t cluster) const {
+  return m_clusters.at (cluster);
+}
+
+Ptr<Node> HierarchyTopologyHelper::GetClusterHead (uint32_t cluster) const {
+  return m_clusters.at (cluster).Get (m_clusterHead[cluster]);
+}
+
+uint32_t HierarchyTopologyHelper::GetClusterTier (uint32_t cluster) const {
+  return m_clusterTier.at (cluster);
+}
+
+uint32_t HierarchyTopologyHelper::GetNodeCluster (uint32_t node) const {
+  return m_nodeCluster.at (node);
+}
+
+Ptr<MobilityStore> HierarchyTopologyHelper::GetMobilityStore (void) const {
+  return m_mobilityStore;
+}
+
+uint32_t HierarchyTopologyHelper::GetNChannels (void) const {
+  return m_channels.size ();
+}
+
+const HierarchyChannel &HierarchyTopologyHelper::GetChannel (uint32_t i) const {
+  return m_channels.at (i);
+}
+
+void HierarchyTopologyHelper::GetLossCacheStats (uint64_t &hits, uint64_t &misses) const {
+  hits = 0;
+  misses = 0;
+  for (std::vector<HierarchyChannel>::const_iterator ch = m_channels.begin (); ch != m_channels.end (); ++ch) {
+    Ptr<CachedPropagationLossModel> cache = DynamicCast<CachedPropagationLossModel> (ch->loss);
+    if (cache != 0) {
+      hits += cache->GetHits ();
+      misses += cache->GetMisses ();
+    }
+  }
+}
+
+void HierarchyTopologyHelper::GetBatchStats (uint64_t &batched, uint64_t &mismatches) const {
+  batched = 0;
+  mismatches = 0;
+  for (std::vector<HierarchyChannel>::const_iterator ch = m_channels.begin (); ch != m_channels.end (); ++ch) {
+    Ptr<SpatialYansWifiChannel> spatial = DynamicCast<SpatialYansWifiChannel> (ch->channel);
+    if (spatial != 0) {
+      batched += spatial->GetBatchedReceptions ();
+      mismatches += spatial->GetBatchMismatches ();
+    }
+  }
+}
+
+} // namespace ns3
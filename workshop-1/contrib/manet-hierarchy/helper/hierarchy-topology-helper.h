@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef HIERARCHY_TOPOLOGY_HELPER_H
+#define HIERARCHY_TOPOLOGY_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/wifi-helper.h"
+#include "ns3/wifi-mac-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "layer-spec.h"
+#include "mobility-store.h"
+#include "spatial-yans-wifi-helper.h"
+
+#include <vector>
+
+namespace ns3 {
+
+// One Wi-Fi channel of the hierarchy and everything attached to it.
+struct HierarchyChannel {
+  enum Kind {
+    FLAT,     // layer 1, every node
+    CLUSTER,  // one cluster of a tier
+    UPPER     // layer 2 and above
+  };
+
+  Kind kind;
+  uint32_t layer;
+  uint32_t cluster;   // global cluster index, CLUSTER channels only
+  NodeContainer nodes;
+  NetDeviceContainer devices;
+  Ipv4InterfaceContainer interfaces;
+  Ptr<YansWifiChannel> channel;
+  Ptr<PropagationLossModel> loss;
+};
+
+/*
+ * Builds the containers, channels, devices, mobility and addressing of a
+ * LayerSpec in loops. Channels are created in the same order the original
+ * scenarios used (layer 1, every cluster, then the upper layers), so the
+ * 2-layer and 3-layer shapes keep their 10.1.N.0/24 numbering; subnets grow
+ * past /24 only when a channel has more than 254 members.
+ */
+class HierarchyTopologyHelper {
+public:
+  HierarchyTopologyHelper ();
+
+  void SetLayerSpec (const LayerSpec &spec);
+  void SetTxPower (double txp);
+  void SetPhyMode (std::string phyMode);
+  void SetArea (double width, double height);
+  void SetMobility (double nodeSpeed, double nodePause);
+  // Lower bound of the leg speeds, 0 by default.
+  void SetMinSpeed (double minSpeed);
+  // Start every node from the stationary RandomWaypoint distribution
+  // (SteadyStateRandomWaypointMobilityModel); needs a positive MinSpeed.
+  void SetSteadyStateMobility (bool steady);
+  // Use a SpatialYansWifiChannel for the all-nodes layer-1 channel.
+  void SetSpatialCulling (bool culling);
+  // Wrap Friis in a CachedPropagationLossModel with this error bound, 0 off.
+  void SetLossCache (double maxErrorDb);
+  // Batch the layer-1 rx power through FriisBatchKernel, optionally checking
+  // every batch against the per-pair models.
+  void SetBatchRxPower (bool batch, bool verify = false);
+
+  // Creates nodes, channels, devices and mobility. Returns the next unused
+  // random stream index.
+  int64_t Create (int64_t stream);
+  // Re-assigns the mobility and Wi-Fi streams from the given index under the
+  // current RngRun and re-draws every initial position. Cluster heads keep
+  // their draw. Steady-state models draw their start again on their own.
+  // Returns the next unused stream index.
+  int64_t Reseed (int64_t stream);
+  // Assigns one subnet per channel; the Internet stack must be installed.
+  void AssignAddresses (void);
+
+  const NodeContainer &GetNodes (void) const;
+  uint32_t GetNLayers (void) const;
+  const NodeContainer &GetLayerNodes (uint32_t layer) const;
+  const Ipv4InterfaceContainer &GetLayerInterfaces (uint32_t layer) const;
+
+  uint32_t GetNClusters (void) const;
+  const NodeContainer &GetCluster (uint32_t cluster) const;
+  Ptr<Node> GetClusterHead (uint32_t cluster) const;
+  uint32_t GetClusterTier (uint32_t cluster) const;
+  // Cluster of the node at the given index of GetNodes ().
+  uint32_t GetNodeCluster (uint32_t node) const;
+
+  // Legs of every node, indexed like GetNodes ().
+  Ptr<MobilityStore> GetMobilityStore (void) const;
+
+  uint32_t GetNChannels (void) const;
+  const HierarchyChannel &GetChannel (uint32_t i) const;
+  // Summed over all channels; zero when the cache is off.
+  void GetLossCacheStats (uint64_t &hits, uint64_t &misses) const;
+  // Zero unless layer 1 is on a SpatialYansWifiChannel.
+  void GetBatchStats (uint64_t &batched, uint64_t &mismatches) const;
+
+private:
+  void AddChannel (HierarchyChannel::Kind kind, uint32_t layer, uint32_t cluster, const NodeContainer &nodes);
+  void InstallMobility (int64_t &stream);
+
+  LayerSpec m_spec;
+  double m_txp;
+  std::string m_phyMode;
+  double m_width;
+  double m_height;
+  double m_nodeSpeed;
+  double m_nodePause;
+  double m_minSpeed;
+  bool m_steadyState;
+  bool m_spatialCulling;
+  double m_lossCacheErrorDb;
+  bool m_batchRxPower;
+  bool m_verifyBatch;
+
+  WifiHelper m_wifi;
+  WifiMacHelper m_mac;
+  SpatialYansWifiPhyHelper m_phy;
+  SpatialYansWifiChannelHelper m_channelHelper;
+  Ptr<UniformRandomVariable> m_headRng;
+  Ptr<MobilityStore> m_mobilityStore;
+  Ptr<PositionAllocator> m_positionAlloc;
+
+  NodeContainer m_nodes;
+  std::vector<NodeContainer> m_clusters;
+  std::vector<uint32_t> m_clusterTier;
+  std::vector<uint32_t> m_clusterHead;   // member index of the head
+  std::vector<uint32_t> m_nodeCluster;
+  std::vector<HierarchyChannel> m_channels;
+  std::vector<uint32_t> m_layerChannel;  // layer -> channel index
+};
+
+} // namespace ns3
+
+#endif /* HIERARCHY_TOPOLOGY_HELPER_H */
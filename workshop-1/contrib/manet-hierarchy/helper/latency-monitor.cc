@@ -0,0 +1,225 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "latency-monitor.h"
+
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+#include "ns3/workload-tag.h"
+
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LatencyMonitor");
+
+// Per flow there can be thousands, so they get coarser buckets, about 6%
+LatencyMonitor::Histograms::Histograms ()
+  : delay (5, 32),
+    jitter (5, 32),
+    hops (6, 7)
+{
+}
+
+LatencyMonitor::Flow::Flow ()
+  : layer (0),
+    scope (-1),
+    lastDelay (-1),
+    delay (4, 32),
+    jitter (4, 32),
+    hops (6, 7)
+{
+}
+
+LatencyMonitor::LatencyMonitor ()
+  : m_initialTtl (64),
+    m_nLayers (0)
+{
+}
+
+void LatencyMonitor::SetTopology (const HierarchyTopologyHelper &topology) {
+  m_addressLayer.clear ();
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    for (uint32_t i = 0; i < channel.interfaces.GetN (); i++) {
+      m_addressLayer[channel.interfaces.GetAddress (i)] = channel.layer;
+    }
+  }
+  Ptr<Ipv4L3Protocol> ipv4 = topology.GetNodes ().Get (0)->GetObject<Ipv4L3Protocol> ();
+  if (ipv4 != 0) {
+    UintegerValue ttl;
+    ipv4->GetAttribute ("DefaultTtl", ttl);
+    m_initialTtl = ttl.Get ();
+  }
+  m_nLayers = topology.GetNLayers ();
+  m_scopes.clear ();
+  m_scopes.resize (m_nLayers);
+  for (uint32_t l = 0; l < m_nLayers; l++) {
+    std::ostringstream name;
+    name << "layer" << l + 1;
+    m_scopes[l].name = name.str ();
+  }
+  m_flows.clear ();
+}
+
+uint32_t LatencyMonitor::AddFlow (const std::string &name, Ipv4Address destination, bool intervalRows) {
+  Flow flow;
+  flow.name = name;
+  std::map<Ipv4Address, uint32_t>::const_iterator layer = m_addressLayer.find (destination);
+  flow.layer = layer == m_addressLayer.end () ? 0 : layer->second;
+  if (intervalRows) {
+    flow.scope = m_scopes.size ();
+    m_scopes.push_back (Scope ());
+    m_scopes.back ().name = name;
+  }
+  m_flows.push_back (flow);
+  return m_flows.size () - 1;
+}
+
+void LatencyMonitor::AddColumns (Ptr<MetricsSink> sink) {
+  sink->AddColumn ("SimulationSecond", MetricsSink::DOUBLE);
+  sink->AddColumn ("Span", MetricsSink::STRING);
+  sink->AddColumn ("Scope", MetricsSink::STRING);
+  sink->AddColumn ("Packets", MetricsSink::INTEGER);
+  sink->AddColumn ("DelayMean", MetricsSink::DOUBLE);
+  sink->AddColumn ("DelayP50", MetricsSink::DOUBLE);
+  sink->AddColumn ("DelayP99", MetricsSink::DOUBLE);
+  sink->AddColumn ("DelayP999", MetricsSink::DOUBLE);
+  sink->AddColumn ("JitterP50", MetricsSink::DOUBLE);
+  sink->AddColumn ("JitterP99", MetricsSink::DOUBLE);
+  sink->AddColumn ("JitterP999", MetricsSink::DOUBLE);
+  sink->AddColumn ("HopsMean", MetricsSink::DOUBLE);
+  sink->AddColumn ("HopsP99", MetricsSink::INTEGER);
+}
+
+void LatencyMonitor::SetSink (Ptr<MetricsSink> sink) {
+  m_sink = sink;
+}
+
+void LatencyMonitor::Record (uint32_t index, Ptr<const Packet> packet) {
+  WorkloadTag sent;
+  if (!packet->PeekPacketTag (sent)) {
+    return;
+  }
+  Flow &flow = m_flows[index];
+  int64_t delay = (Simulator::Now () - sent.GetSent ()).GetMicroSeconds ();
+  int64_t jitter = -1;
+  if (flow.lastDelay >= 0) {
+    jitter = delay > flow.lastDelay ? delay - flow.lastDelay : flow.lastDelay - delay;
+  }
+  flow.lastDelay = delay;
+  SocketIpTtlTag ttl;
+  int32_t hops = -1;
+  if (packet->PeekPacketTag (ttl) && ttl.GetTtl () <= m_initialTtl) {
+    hops = m_initialTtl - ttl.GetTtl () + 1;
+  }
+
+  flow.delay.Add (delay);
+  if (jitter >= 0) {
+    flow.jitter.Add (jitter);
+  }
+  if (hops >= 0) {
+    flow.hops.Add (hops);
+  }
+  Histograms *targets[3] = {0, 0, 0};
+  if (flow.layer >= 1 && flow.layer <= m_nLayers) {
+    targets[0] = &m_scopes[flow.layer - 1].interval;
+    targets[1] = &m_scopes[flow.layer - 1].run;
+  }
+  if (flow.scope >= 0) {
+    targets[2] = &m_scopes[flow.scope].interval;
+  }
+  for (uint32_t t = 0; t < 3; t++) {
+    if (targets[t] == 0) {
+      continue;
+    }
+    targets[t]->delay.Add (delay);
+    if (jitter >= 0) {
+      targets[t]->jitter.Add (jitter);
+    }
+    if (hops >= 0) {
+      targets[t]->hops.Add (hops);
+    }
+  }
+}
+
+bool LatencyMonitor::GetIntervalDelay (uint32_t flow, double &mean) const {
+  int32_t scope = m_flows.at (flow).scope;
+  if (scope < 0 || m_scopes[scope].interval.delay.GetCount () == 0) {
+    return false;
+  }
+  mean = m_scopes[scope].interval.delay.GetMean () * 1e-6;
+  return true;
+}
+
+void LatencyMonitor::WriteRow (const std::string &span, const std::string &scope, const Histograms &histograms) {
+  m_sink->BeginRow ();
+  m_sink->Add (Simulator::Now ().GetSeconds ());
+  m_sink->Add (span);
+  m_sink->Add (scope);
+  m_sink->Add (static_cast<int64_t> (histograms.delay.GetCount ()));
+  m_sink->Add (histograms.delay.GetMean () * 1e-6);
+  m_sink->Add (histograms.delay.GetQuantile (0.5) * 1e-6);
+  m_sink->Add (histograms.delay.GetQuantile (0.99) * 1e-6);
+  m_sink->Add (histograms.delay.GetQuantile (0.999) * 1e-6);
+  m_sink->Add (histograms.jitter.GetQuantile (0.5) * 1e-6);
+  m_sink->Add (histograms.jitter.GetQuantile (0.99) * 1e-6);
+  m_sink->Add (histograms.jitter.GetQuantile (0.999) * 1e-6);
+  m_sink->Add (histograms.hops.GetMean ());
+  m_sink->Add (static_cast<int64_t> (histograms.hops.GetQuantile (0.99)));
+  m_sink->EndRow ();
+}
+
+void LatencyMonitor::Export (void) {
+  for (std::size_t s = 0; s < m_scopes.size (); s++) {
+    Scope &scope = m_scopes[s];
+    if (scope.interval.delay.GetCount () == 0) {
+      continue;
+    }
+    if (m_sink != 0) {
+      WriteRow ("interval", scope.name, scope.interval);
+    }
+    scope.interval.delay.Reset ();
+    scope.interval.jitter.Reset ();
+    scope.interval.hops.Reset ();
+  }
+}
+
+void LatencyMonitor::ExportRun (void) {
+  Export ();
+  if (m_sink == 0) {
+    return;
+  }
+  for (uint32_t l = 0; l < m_nLayers; l++) {
+    if (m_scopes[l].run.delay.GetCount () > 0) {
+      WriteRow ("run", m_scopes[l].name, m_scopes[l].run);
+    }
+  }
+  for (std::size_t f = 0; f < m_flows.size (); f++) {
+    const Flow &flow = m_flows[f];
+    if (flow.delay.GetCount () == 0) {
+      continue;
+    }
+    Histograms histograms;
+    histograms.delay = flow.delay;
+    histograms.jitter = flow.jitter;
+    histograms.hops = flow.hops;
+    WriteRow ("run", flow.name, histograms);
+  }
+}
+
+void LatencyMonitor::Summarize (void) const {
+  for (uint32_t l = 0; l < m_nLayers; l++) {
+    const Histograms &run = m_scopes[l].run;
+    if (run.delay.GetCount () == 0) {
+      continue;
+    }
+    NS_LOG_UNCOND ("Latency to " << m_scopes[l].name << ": " << run.delay.GetCount () << " packets, delay p50 "
+                   << run.delay.GetQuantile (0.5) * 1e-3 << " ms, p99 " << run.delay.GetQuantile (0.99) * 1e-3
+                   << " ms, p99.9 " << run.delay.GetQuantile (0.999) * 1e-3 << " ms, jitter p99 "
+                   << run.jitter.GetQuantile (0.99) * 1e-3 << " ms, " << run.hops.GetMean () << " hops on average");
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LATENCY_MONITOR_H
+#define LATENCY_MONITOR_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "hierarchy-topology-helper.h"
+#include "log-linear-histogram.h"
+#include "metrics-sink.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * One-way delay, jitter and hop count of the packets received at the sinks,
+ * from the send time in their WorkloadTag and the TTL in their
+ * SocketIpTtlTag. Jitter is the difference between the delays of two
+ * consecutive packets of a flow; hops are taken against the default TTL.
+ *
+ * Samples go into LogLinearHistograms: per layer of the destination
+ * address, per flow, and per interval for the layers and the flows that
+ * asked for it. Export writes the percentiles of each interval and empties
+ * the interval histograms; ExportRun writes those of the whole run, per
+ * flow included.
+ */
+class LatencyMonitor {
+public:
+  LatencyMonitor ();
+
+  // Layer of every address; after the addresses are assigned.
+  void SetTopology (const HierarchyTopologyHelper &topology);
+  // Returns the index Record takes. Flows with intervalRows get interval
+  // rows of their own next to the layers'.
+  uint32_t AddFlow (const std::string &name, Ipv4Address destination, bool intervalRows);
+
+  static void AddColumns (Ptr<MetricsSink> sink);
+  void SetSink (Ptr<MetricsSink> sink);
+
+  // Packets without a WorkloadTag are ignored, without a TTL tag they only
+  // miss their hop count.
+  void Record (uint32_t flow, Ptr<const Packet> packet);
+  // Mean delay in s since the last Export of a flow with interval rows;
+  // false without packets.
+  bool GetIntervalDelay (uint32_t flow, double &mean) const;
+
+  void Export (void);
+  void ExportRun (void);
+  void Summarize (void) const;
+
+private:
+  // Delays and jitter in microseconds
+  struct Histograms {
+    Histograms ();
+
+    LogLinearHistogram delay;
+    LogLinearHistogram jitter;
+    LogLinearHistogram hops;
+  };
+
+  struct Scope {
+    std::string name;
+    Histograms interval;
+    Histograms run;         // layers only, flows keep theirs in Flow
+  };
+
+  struct Flow {
+    Flow ();
+
+    std::string name;
+    uint32_t layer;
+    int32_t scope;          // own interval rows, -1 for none
+    int64_t lastDelay;      // -1 before the first packet
+    LogLinearHistogram delay;
+    LogLinearHistogram jitter;
+    LogLinearHistogram hops;
+  };
+
+  void WriteRow (const std::string &span, const std::string &scope, const Histograms &histograms);
+
+  Ptr<MetricsSink> m_sink;
+  std::map<Ipv4Address, uint32_t> m_addressLayer;
+  uint8_t m_initialTtl;
+  std::vector<Scope> m_scopes;       // layer L at L - 1, then the flows'
+  uint32_t m_nLayers;
+  std::vector<Flow> m_flows;
+};
+
+} // namespace ns3
+
+#endif /* LATENCY_MONITOR_H */
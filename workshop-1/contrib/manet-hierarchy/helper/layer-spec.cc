@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "layer-spec.h"
+
+#include "ns3/abort.h"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace ns3 {
+
+LayerSpec::LayerSpec ()
+  : m_headSelection (HEAD_FIRST)
+{
+}
+
+LayerSpec LayerSpec::Parse (const std::string &spec) {
+  LayerSpec result;
+  std::istringstream in (spec);
+  std::string item;
+  while (std::getline (in, item, ',')) {
+    std::string::size_type x = item.find ('x');
+    NS_ABORT_MSG_IF (x == std::string::npos, "Bad layer spec '" << spec << "', expected <clusters>x<nodes>[,...]");
+    long clusters = std::strtol (item.substr (0, x).c_str (), 0, 10);
+    long nodes = std::strtol (item.substr (x + 1).c_str (), 0, 10);
+    NS_ABORT_MSG_IF (clusters <= 0 || nodes <= 0, "Bad tier '" << item << "' in layer spec '" << spec << "'");
+    result.AddTier (clusters, nodes);
+  }
+  NS_ABORT_MSG_IF (result.GetNTiers () == 0, "Empty layer spec");
+  return result;
+}
+
+LayerSpec::HeadSelection LayerSpec::ParseHeadSelection (const std::string &rule) {
+  if (rule == "first") {
+    return HEAD_FIRST;
+  }
+  if (rule == "random") {
+    return HEAD_RANDOM;
+  }
+  NS_ABORT_MSG ("Unknown head selection rule '" << rule << "', expected first|random");
+  return HEAD_FIRST;
+}
+
+void LayerSpec::AddTier (uint32_t nClusters, uint32_t nNodes) {
+  ClusterTier tier;
+  tier.nClusters = nClusters;
+  tier.nNodes = nNodes;
+  m_tiers.push_back (tier);
+}
+
+void LayerSpec::SetHeadSelection (HeadSelection rule) {
+  m_headSelection = rule;
+}
+
+uint32_t LayerSpec::GetNTiers (void) const {
+  return m_tiers.size ();
+}
+
+const ClusterTier &LayerSpec::GetTier (uint32_t tier) const {
+  return m_tiers.at (tier);
+}
+
+uint32_t LayerSpec::GetNLayers (void) const {
+  return m_tiers.size () + 1;
+}
+
+uint32_t LayerSpec::GetNClusters (void) const {
+  uint32_t n = 0;
+  for (std::vector<ClusterTier>::const_iterator i = m_tiers.begin (); i != m_tiers.end (); ++i) {
+    n += i->nClusters;
+  }
+  return n;
+}
+
+uint32_t LayerSpec::GetNTotalNodes (void) const {
+  uint32_t n = 0;
+  for (std::vector<ClusterTier>::const_iterator i = m_tiers.begin (); i != m_tiers.end (); ++i) {
+    n += i->nClusters * i->nNodes;
+  }
+  return n;
+}
+
+LayerSpec::HeadSelection LayerSpec::GetHeadSelection (void) const {
+  return m_headSelection;
+}
+
+std::string LayerSpec::ToString (void) const {
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_tiers.size (); i++) {
+    if (i > 0) {
+      oss << ",";
+    }
+    oss << m_tiers[i].nClusters << "x" << m_tiers[i].nNodes;
+  }
+  return oss.str ();
+}
+
+} // namespace ns3
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LAYER_SPEC_H
+#define LAYER_SPEC_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// A block of nodes split into equally sized clusters.
+struct ClusterTier {
+  uint32_t nClusters;
+  uint32_t nNodes;   // nodes per cluster
+};
+
+/*
+ * Shape of a layered hierarchy.
+ *
+ * Every node of every tier shares layer 1. Each tier after the first is also
+ * a layer of its own (layer 2 in the 3-layer scenarios), and the heads of the
+ * last tier's clusters form the top layer. "6x6" is the 2-layer shape of
+ * scenario1-2l, "10x3,8x6" the 3-layer shape of scenario2-3l.
+ */
+class LayerSpec {
+public:
+  enum HeadSelection {
+    HEAD_FIRST,   // first node of the cluster, as in the original scenarios
+    HEAD_RANDOM   // uniformly drawn member
+  };
+
+  LayerSpec ();
+
+  // Parses "<clusters>x<nodes>[,<clusters>x<nodes>...]".
+  static LayerSpec Parse (const std::string &spec);
+  static HeadSelection ParseHeadSelection (const std::string &rule);
+
+  void AddTier (uint32_t nClusters, uint32_t nNodes);
+  void SetHeadSelection (HeadSelection rule);
+
+  uint32_t GetNTiers (void) const;
+  const ClusterTier &GetTier (uint32_t tier) const;
+  uint32_t GetNLayers (void) const;
+  uint32_t GetNClusters (void) const;
+  uint32_t GetNTotalNodes (void) const;
+  HeadSelection GetHeadSelection (void) const;
+  std::string ToString (void) const;
+
+private:
+  std::vector<ClusterTier> m_tiers;
+  HeadSelection m_headSelection;
+};
+
+} // namespace ns3
+
+#endif /* LAYER_SPEC_H */
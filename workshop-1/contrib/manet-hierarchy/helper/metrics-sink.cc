@@ -0,0 +1,277 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "metrics-sink.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+static const char g_magic[4] = {'M', 'C', 'O', 'L'};
+static const uint32_t g_version = 1;
+
+Ptr<MetricsSink> MetricsSink::Create (const std::string &format) {
+  if (format == "csv") {
+    return ns3::Create<CsvMetricsSink> ();
+  }
+  if (format == "columnar") {
+    return ns3::Create<ColumnarMetricsSink> ();
+  }
+  NS_ABORT_MSG ("Unknown metrics format \"" << format << "\", expected csv or columnar");
+  return 0;
+}
+
+std::string MetricsSink::GetExtension (const std::string &format) {
+  return format == "columnar" ? ".mcol" : ".csv";
+}
+
+MetricsSink::MetricsSink ()
+  : m_flushRows (0),
+    m_buffered (0),
+    m_cell (0),
+    m_rows (0),
+    m_open (false)
+{
+}
+
+MetricsSink::~MetricsSink () {
+}
+
+void MetricsSink::AddColumn (const std::string &name, ColumnType type) {
+  NS_ABORT_MSG_IF (m_open, "Columns must be added before Open");
+  Column column;
+  column.name = name;
+  column.type = type;
+  m_columns.push_back (column);
+}
+
+void MetricsSink::SetFlushRows (uint32_t rows) {
+  m_flushRows = rows;
+}
+
+void MetricsSink::Open (const std::string &fileName, bool append) {
+  NS_ABORT_MSG_IF (m_open, "Metrics sink already open");
+  DoOpen (fileName, append);
+  m_open = true;
+}
+
+void MetricsSink::Close (void) {
+  if (!m_open) {
+    return;
+  }
+  Flush ();
+  DoClose ();
+  m_open = false;
+}
+
+MetricsSink::Column &MetricsSink::NextCell (ColumnType type) {
+  NS_ASSERT_MSG (m_cell < m_columns.size (), "More cells than columns");
+  Column &column = m_columns[m_cell++];
+  NS_ASSERT_MSG (column.type == type, "Wrong cell type for column " << column.name);
+  return column;
+}
+
+void MetricsSink::BeginRow (void) {
+  m_cell = 0;
+}
+
+void MetricsSink::Add (double value) {
+  NextCell (DOUBLE).doubles.push_back (value);
+}
+
+void MetricsSink::Add (int64_t value) {
+  NextCell (INTEGER).integers.push_back (value);
+}
+
+void MetricsSink::Add (const std::string &value) {
+  NextCell (STRING).strings.push_back (value);
+}
+
+void MetricsSink::EndRow (void) {
+  NS_ASSERT_MSG (m_cell == m_columns.size (), "Row has " << m_cell << " of " << m_columns.size () << " cells");
+  m_buffered++;
+  m_rows++;
+  if (m_flushRows > 0 && m_buffered >= m_flushRows) {
+    Flush ();
+  }
+}
+
+void MetricsSink::Flush (void) {
+  if (m_buffered == 0 || !m_open) {
+    return;
+  }
+  DoWrite (m_columns, m_buffered);
+  for (std::vector<Column>::iterator i = m_columns.begin (); i != m_columns.end (); ++i) {
+    i->doubles.clear ();
+    i->integers.clear ();
+    i->strings.clear ();
+  }
+  m_buffered = 0;
+}
+
+uint64_t MetricsSink::GetRows (void) const {
+  return m_rows;
+}
+
+void CsvMetricsSink::DoOpen (const std::string &fileName, bool append) {
+  m_out.open (fileName.c_str (), append ? std::ios::app : std::ios::out);
+  NS_ABORT_MSG_IF (!m_out, "Cannot open metrics file " << fileName);
+  m_header = !append;
+}
+
+static void WriteCell (std::ostream &out, const std::vector<double> &doubles, const std::vector<int64_t> &integers,
+                       const std::vector<std::string> &strings, MetricsSink::ColumnType type, uint32_t row) {
+  switch (type) {
+    case MetricsSink::DOUBLE:
+      out << doubles[row];
+      break;
+    case MetricsSink::INTEGER:
+      out << integers[row];
+      break;
+    case MetricsSink::STRING:
+      out << strings[row];
+      break;
+  }
+}
+
+void CsvMetricsSink::DoWrite (const std::vector<Column> &columns, uint32_t rows) {
+  if (m_header) {
+    m_header = false;
+    for (std::size_t c = 0; c < columns.size (); c++) {
+      m_out << (c > 0 ? "," : "") << columns[c].name;
+    }
+    m_out << "\n";
+  }
+  for (uint32_t r = 0; r < rows; r++) {
+    for (std::size_t c = 0; c < columns.size (); c++) {
+      if (c > 0) {
+        m_out << ",";
+      }
+      WriteCell (m_out, columns[c].doubles, columns[c].integers, columns[c].strings, columns[c].type, r);
+    }
+    m_out << "\n";
+  }
+  m_out.flush ();
+}
+
+void CsvMetricsSink::DoClose (void) {
+  m_out.close ();
+}
+
+template <typename T>
+static void WriteRaw (std::ostream &out, const T &value) {
+  out.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+template <typename T>
+static bool ReadRaw (std::istream &in, T &value) {
+  return static_cast<bool> (in.read (reinterpret_cast<char *> (&value), sizeof (value)));
+}
+
+void ColumnarMetricsSink::DoOpen (const std::string &fileName, bool append) {
+  m_out.open (fileName.c_str (), std::ios::binary | (append ? std::ios::app : std::ios::out));
+  NS_ABORT_MSG_IF (!m_out, "Cannot open metrics file " << fileName);
+  m_header = !append;
+}
+
+void ColumnarMetricsSink::DoWrite (const std::vector<Column> &columns, uint32_t rows) {
+  if (m_header) {
+    m_header = false;
+    m_out.write (g_magic, sizeof (g_magic));
+    WriteRaw (m_out, g_version);
+    WriteRaw (m_out, static_cast<uint32_t> (columns.size ()));
+    for (std::size_t c = 0; c < columns.size (); c++) {
+      WriteRaw (m_out, static_cast<uint8_t> (columns[c].type));
+      WriteRaw (m_out, static_cast<uint32_t> (columns[c].name.size ()));
+      m_out.write (columns[c].name.data (), columns[c].name.size ());
+    }
+  }
+  WriteRaw (m_out, rows);
+  for (std::size_t c = 0; c < columns.size (); c++) {
+    const Column &column = columns[c];
+    switch (column.type) {
+      case DOUBLE:
+        m_out.write (reinterpret_cast<const char *> (column.doubles.data ()), rows * sizeof (double));
+        break;
+      case INTEGER:
+        m_out.write (reinterpret_cast<const char *> (column.integers.data ()), rows * sizeof (int64_t));
+        break;
+      case STRING:
+        for (uint32_t r = 0; r < rows; r++) {
+          WriteRaw (m_out, static_cast<uint32_t> (column.strings[r].size ()));
+          m_out.write (column.strings[r].data (), column.strings[r].size ());
+        }
+        break;
+    }
+  }
+  m_out.flush ();
+}
+
+void ColumnarMetricsSink::DoClose (void) {
+  m_out.close ();
+}
+
+uint64_t ColumnarMetricsSink::Decode (std::istream &in, std::ostream &out) {
+  char magic[4];
+  uint32_t version;
+  uint32_t nColumns;
+  in.read (magic, sizeof (magic));
+  NS_ABORT_MSG_IF (!in || std::memcmp (magic, g_magic, sizeof (magic)) != 0, "Not a columnar metrics file");
+  NS_ABORT_MSG_IF (!ReadRaw (in, version) || version != g_version, "Columnar metrics version " << version << " is not supported");
+  ReadRaw (in, nColumns);
+
+  std::vector<Column> columns (nColumns);
+  for (uint32_t c = 0; c < nColumns; c++) {
+    uint8_t type;
+    uint32_t length;
+    ReadRaw (in, type);
+    ReadRaw (in, length);
+    columns[c].type = static_cast<ColumnType> (type);
+    columns[c].name.resize (length);
+    in.read (&columns[c].name[0], length);
+    out << (c > 0 ? "," : "") << columns[c].name;
+  }
+  out << "\n";
+
+  uint64_t total = 0;
+  uint32_t rows;
+  while (ReadRaw (in, rows)) {
+    for (uint32_t c = 0; c < nColumns; c++) {
+      Column &column = columns[c];
+      switch (column.type) {
+        case DOUBLE:
+          column.doubles.resize (rows);
+          in.read (reinterpret_cast<char *> (column.doubles.data ()), rows * sizeof (double));
+          break;
+        case INTEGER:
+          column.integers.resize (rows);
+          in.read (reinterpret_cast<char *> (column.integers.data ()), rows * sizeof (int64_t));
+          break;
+        case STRING:
+          column.strings.resize (rows);
+          for (uint32_t r = 0; r < rows; r++) {
+            uint32_t length = 0;
+            ReadRaw (in, length);
+            column.strings[r].resize (length);
+            in.read (&column.strings[r][0], length);
+          }
+          break;
+      }
+    }
+    NS_ABORT_MSG_IF (!in, "Truncated columnar metrics block");
+    for (uint32_t r = 0; r < rows; r++) {
+      for (uint32_t c = 0; c < nColumns; c++) {
+        if (c > 0) {
+          out << ",";
+        }
+        WriteCell (out, columns[c].doubles, columns[c].integers, columns[c].strings, columns[c].type, r);
+      }
+      out << "\n";
+    }
+    total += rows;
+  }
+  return total;
+}
+
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef METRICS_SINK_H
+#define METRICS_SINK_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Long-lived output for per-interval metrics. Rows are buffered in memory by
+ * column and handed to the backend every FlushRows rows (0 only on Flush and
+ * Close), so the file stays open for the whole run instead of being reopened
+ * per row. Flush before forking, or the children inherit the buffered rows.
+ */
+class MetricsSink : public SimpleRefCount<MetricsSink> {
+public:
+  enum ColumnType {
+    DOUBLE,
+    INTEGER,
+    STRING
+  };
+
+  // "csv" or "columnar".
+  static Ptr<MetricsSink> Create (const std::string &format);
+  // File extension of a format, including the dot.
+  static std::string GetExtension (const std::string &format);
+
+  MetricsSink ();
+  virtual ~MetricsSink ();
+
+  void AddColumn (const std::string &name, ColumnType type);
+  void SetFlushRows (uint32_t rows);
+
+  // Writes the header unless appending to a file that already has one.
+  void Open (const std::string &fileName, bool append);
+  void Close (void);
+
+  // Cells are added in column order.
+  void BeginRow (void);
+  void Add (double value);
+  void Add (int64_t value);
+  void Add (const std::string &value);
+  void EndRow (void);
+
+  void Flush (void);
+  uint64_t GetRows (void) const;
+
+protected:
+  struct Column {
+    std::string name;
+    ColumnType type;
+    std::vector<double> doubles;
+    std::vector<int64_t> integers;
+    std::vector<std::string> strings;
+  };
+
+  virtual void DoOpen (const std::string &fileName, bool append) = 0;
+  virtual void DoWrite (const std::vector<Column> &columns, uint32_t rows) = 0;
+  virtual void DoClose (void) = 0;
+
+private:
+  Column &NextCell (ColumnType type);
+
+  std::vector<Column> m_columns;
+  uint32_t m_flushRows;
+  uint32_t m_buffered;
+  uint32_t m_cell;
+  uint64_t m_rows;
+  bool m_open;
+};
+
+// Comma separated, formatted like the original CheckThroughput rows.
+class CsvMetricsSink : public MetricsSink {
+private:
+  void DoOpen (const std::string &fileName, bool append) override;
+  void DoWrite (const std::vector<Column> &columns, uint32_t rows) override;
+  void DoClose (void) override;
+
+  std::ofstream m_out;
+  bool m_header;                // still to be written
+};
+
+/*
+ * Header with the column names and types, then one block per flush: the row
+ * count followed by each column's values back to back (8-byte doubles and
+ * integers, length-prefixed strings), in host byte order.
+ */
+class ColumnarMetricsSink : public MetricsSink {
+public:
+  // Prints a columnar file as CSV. Returns the number of rows.
+  static uint64_t Decode (std::istream &in, std::ostream &out);
+
+private:
+  void DoOpen (const std::string &fileName, bool append) override;
+  void DoWrite (const std::vector<Column> &columns, uint32_t rows) override;
+  void DoClose (void) override;
+
+  std::ofstream m_out;
+  bool m_header;                // still to be written
+};
+
+} // namespace ns3
+
+#endif /* METRICS_SINK_H */
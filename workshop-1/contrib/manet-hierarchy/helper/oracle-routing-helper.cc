@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "oracle-routing-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/cached-propagation-loss-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/log.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OracleRoutingHelper");
+
+OracleRoutingHelper::OracleRoutingHelper ()
+  : m_interval (Seconds (1.0)),
+    m_minRxPowerDbm (-82.0)
+{
+}
+
+OracleRoutingHelper *OracleRoutingHelper::Copy (void) const {
+  return new OracleRoutingHelper (*this);
+}
+
+Ptr<Ipv4RoutingProtocol> OracleRoutingHelper::Create (Ptr<Node> node) const {
+  return CreateObject<OracleRoutingProtocol> ();
+}
+
+void OracleRoutingHelper::SetInterval (Time interval) {
+  m_interval = interval;
+}
+
+void OracleRoutingHelper::SetMinRxPower (double minRxPowerDbm) {
+  m_minRxPowerDbm = minRxPowerDbm;
+}
+
+Ptr<OracleRoutingTable> OracleRoutingHelper::GetTable (void) const {
+  return m_table;
+}
+
+static Ptr<OracleRoutingProtocol> GetOracle (Ptr<Node> node) {
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (node->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  for (uint32_t i = 0; list != 0 && i < list->GetNRoutingProtocols (); i++) {
+    int16_t priority;
+    Ptr<OracleRoutingProtocol> oracle = DynamicCast<OracleRoutingProtocol> (list->GetRoutingProtocol (i, priority));
+    if (oracle != 0) {
+      return oracle;
+    }
+  }
+  return 0;
+}
+
+void OracleRoutingHelper::Configure (const HierarchyTopologyHelper &topology) {
+  Ptr<MobilityStore> store = topology.GetMobilityStore ();
+  m_table = CreateObject<OracleRoutingTable> ();
+  m_table->SetAttribute ("Interval", TimeValue (m_interval));
+  m_table->SetMobilityStore (store);
+
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> interfaces;
+    std::vector<Ipv4Address> addresses;
+    double txPower = -std::numeric_limits<double>::max ();
+    double margin = std::numeric_limits<double>::max ();
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      Ptr<Node> node = channel.nodes.Get (i);
+      vertices.push_back (store->GetIndex (node->GetObject<MobilityModel> ()));
+      interfaces.push_back (node->GetObject<Ipv4> ()->GetInterfaceForDevice (channel.devices.Get (i)));
+      addresses.push_back (channel.interfaces.GetAddress (i));
+      Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice> (channel.devices.Get (i))->GetPhy ();
+      txPower = std::max (txPower, phy->GetTxPowerEnd () + phy->GetTxGain ());
+      margin = std::min (margin, std::max (phy->GetRxSensitivity (), m_minRxPowerDbm) - phy->GetRxGain ());
+    }
+    double range = GetRange (channel.loss, txPower, margin);
+    NS_LOG_INFO ("Channel " << c << ": " << vertices.size () << " nodes, range " << range << " m");
+    m_table->AddChannel (vertices, interfaces, addresses, range);
+  }
+
+  const NodeContainer &nodes = topology.GetNodes ();
+  for (uint32_t n = 0; n < nodes.GetN (); n++) {
+    Ptr<OracleRoutingProtocol> oracle = GetOracle (nodes.Get (n));
+    NS_ABORT_MSG_IF (oracle == 0, "Node " << nodes.Get (n)->GetId () << " does not run oracle routing");
+    oracle->SetTable (m_table, store->GetIndex (nodes.Get (n)->GetObject<MobilityModel> ()));
+  }
+  m_table->Start ();
+}
+
+double OracleRoutingHelper::GetRange (Ptr<PropagationLossModel> loss, double txPowerDbm, double marginDbm) {
+  // As SpatialYansWifiChannel, assuming the loss grows with distance
+  Ptr<CachedPropagationLossModel> cache = DynamicCast<CachedPropagationLossModel> (loss);
+  if (cache != 0) {
+    cache->SetProbing (true);
+  }
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0.0, 0.0, 0.0));
+  double lo = 0.0;
+  double hi = 1.0;
+  b->SetPosition (Vector (hi, 0.0, 0.0));
+  while (loss->CalcRxPower (txPowerDbm, a, b) >= marginDbm && hi < 1e7) {
+    lo = hi;
+    hi *= 2;
+    b->SetPosition (Vector (hi, 0.0, 0.0));
+  }
+  for (int i = 0; i < 64 && hi - lo > 1e-3; i++) {
+    double mid = (lo + hi) / 2;
+    b->SetPosition (Vector (mid, 0.0, 0.0));
+    if (loss->CalcRxPower (txPowerDbm, a, b) >= marginDbm) {
+      lo = mid;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  if (cache != 0) {
+    cache->SetProbing (false);
+  }
+  // The last distance known to be received
+  return lo;
+}
+
+} // namespace ns3
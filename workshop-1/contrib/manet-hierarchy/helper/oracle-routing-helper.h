@@ -0,0 +1,49 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ORACLE_ROUTING_HELPER_H
+#define ORACLE_ROUTING_HELPER_H
+
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/nstime.h"
+#include "ns3/propagation-loss-model.h"
+#include "oracle-routing-protocol.h"
+#include "oracle-routing-table.h"
+#include "hierarchy-topology-helper.h"
+
+namespace ns3 {
+
+/*
+ * Creates OracleRoutingProtocol instances for InternetStackHelper and, once
+ * the topology is addressed, one OracleRoutingTable shared by all of them.
+ * Each channel's range is where its loss model drops the PHYs' transmit
+ * power below the weakest signal they can decode: the larger of their
+ * RxSensitivity and MinRxPower, by default the -82 dBm minimum RSSI of
+ * ThresholdPreambleDetectionModel. Below that frames may still be sensed
+ * and interfere, but are never received.
+ */
+class OracleRoutingHelper : public Ipv4RoutingHelper {
+public:
+  OracleRoutingHelper ();
+
+  OracleRoutingHelper *Copy (void) const override;
+  Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const override;
+
+  void SetInterval (Time interval);
+  // Weakest received power in dBm that still decodes, before RxGain.
+  void SetMinRxPower (double minRxPowerDbm);
+  // After the addresses are assigned; starts the table.
+  void Configure (const HierarchyTopologyHelper &topology);
+  // Zero before Configure.
+  Ptr<OracleRoutingTable> GetTable (void) const;
+
+  // Largest distance at which the received power stays at or above marginDbm.
+  static double GetRange (Ptr<PropagationLossModel> loss, double txPowerDbm, double marginDbm);
+
+private:
+  Time m_interval;
+  double m_minRxPowerDbm;
+  Ptr<OracleRoutingTable> m_table;
+};
+
+} // namespace ns3
+
+#endif /* ORACLE_ROUTING_HELPER_H */
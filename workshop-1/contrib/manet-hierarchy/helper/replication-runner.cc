@@ -0,0 +1,264 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "replication-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+ReplicationRunner::ReplicationRunner ()
+  : m_replications (1),
+    m_firstRun (1),
+    m_cores (0)
+{
+}
+
+void ReplicationRunner::SetReplications (uint32_t replications) {
+  m_replications = replications;
+}
+
+void ReplicationRunner::SetFirstRun (uint32_t run) {
+  m_firstRun = run;
+}
+
+void ReplicationRunner::SetCores (uint32_t cores) {
+  m_cores = cores;
+}
+
+std::vector<std::pair<uint32_t, FlowSummary> > ReplicationRunner::Run (Job job) {
+  uint32_t cores = m_cores;
+  if (cores == 0) {
+    long online = sysconf (_SC_NPROCESSORS_ONLN);
+    cores = online > 0 ? online : 1;
+  }
+  std::deque<uint32_t> queue;
+  for (uint32_t i = 0; i < m_replications; i++) {
+    queue.push_back (m_firstRun + i);
+  }
+  NS_LOG_UNCOND ("Running " << m_replications << " replications on " << cores << " cores");
+
+  struct Worker {
+    uint32_t run;
+    int fd;
+  };
+  std::map<pid_t, Worker> running;
+  std::map<uint32_t, FlowSummary> done;
+
+  while (!queue.empty () || !running.empty ()) {
+    while (!queue.empty () && running.size () < cores) {
+      uint32_t run = queue.front ();
+      queue.pop_front ();
+      // Keep buffered output from being written twice by the child
+      std::cout.flush ();
+      std::clog.flush ();
+      std::fflush (stdout);
+      int fds[2];
+      NS_ABORT_MSG_IF (pipe (fds) != 0, "Cannot create the pipe of run " << run);
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Cannot fork run " << run);
+      if (pid == 0) {
+        close (fds[0]);
+        FlowSummary summary = job (run);
+        // Smaller than PIPE_BUF, so the write is atomic and never blocks
+        ssize_t written = write (fds[1], &summary, sizeof (summary));
+        close (fds[1]);
+        // _exit skips the flush at exit, which would drop the run's log
+        std::cout.flush ();
+        std::clog.flush ();
+        std::fflush (stdout);
+        _exit (written == sizeof (summary) ? 0 : 1);
+      }
+      close (fds[1]);
+      Worker worker = {run, fds[0]};
+      running[pid] = worker;
+    }
+
+    int status;
+    pid_t pid = waitpid (-1, &status, 0);
+    if (pid < 0) {
+      NS_FATAL_ERROR ("waitpid failed with " << running.size () << " replications running");
+    }
+    std::map<pid_t, Worker>::iterator it = running.find (pid);
+    if (it == running.end ()) {
+      continue;
+    }
+    Worker worker = it->second;
+    running.erase (it);
+
+    FlowSummary summary;
+    ssize_t got = read (worker.fd, &summary, sizeof (summary));
+    close (worker.fd);
+    if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && got == sizeof (summary)) {
+      done[worker.run] = summary;
+    }
+    else {
+      NS_LOG_UNCOND ("Replication run " << worker.run << " failed, leaving it out");
+    }
+  }
+
+  NS_ABORT_MSG_IF (done.empty (), "Every replication failed");
+  return std::vector<std::pair<uint32_t, FlowSummary> > (done.begin (), done.end ());
+}
+
+double ReplicationRunner::StudentT95 (uint32_t df) {
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  NS_ABORT_MSG_IF (df == 0, "No degrees of freedom");
+  if (df <= 30) {
+    return table[df - 1];
+  }
+  // Cornish-Fisher expansion around the normal quantile
+  double z = 1.959964;
+  double z3 = z * z * z;
+  double z5 = z3 * z * z;
+  return z + (z3 + z) / (4.0 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df);
+}
+
+ReplicationEstimate ReplicationRunner::Estimate (const std::vector<double> &samples) {
+  ReplicationEstimate estimate = {0.0, 0.0, static_cast<uint32_t> (samples.size ())};
+  if (samples.empty ()) {
+    return estimate;
+  }
+  for (std::size_t i = 0; i < samples.size (); i++) {
+    estimate.mean += samples[i];
+  }
+  estimate.mean /= samples.size ();
+  if (samples.size () < 2) {
+    return estimate;
+  }
+  double ss = 0.0;
+  for (std::size_t i = 0; i < samples.size (); i++) {
+    ss += (samples[i] - estimate.mean) * (samples[i] - estimate.mean);
+  }
+  double sd = std::sqrt (ss / (samples.size () - 1));
+  estimate.ci95 = StudentT95 (samples.size () - 1) * sd / std::sqrt (static_cast<double> (samples.size ()));
+  return estimate;
+}
+
+void ReplicationRunner::MergeCsv (const std::vector<std::string> &files, const std::string &out) {
+  // Row index -> samples of each averaged column, plus the fixed columns
+  std::vector<std::vector<double> > second;
+  std::vector<std::vector<double> > rate;
+  std::vector<std::vector<double> > packets;
+  std::vector<std::string> fixed;
+
+  for (std::size_t f = 0; f < files.size (); f++) {
+    std::ifstream in (files[f].c_str ());
+    std::string line;
+    std::getline (in, line);  // header
+    for (std::size_t row = 0; std::getline (in, line); row++) {
+      std::istringstream cells (line);
+      std::string t, kbs, received, rest;
+      std::getline (cells, t, ',');
+      std::getline (cells, kbs, ',');
+      std::getline (cells, received, ',');
+      std::getline (cells, rest);
+      if (row >= second.size ()) {
+        second.resize (row + 1);
+        rate.resize (row + 1);
+        packets.resize (row + 1);
+        fixed.resize (row + 1, rest);
+      }
+      second[row].push_back (std::atof (t.c_str ()));
+      rate[row].push_back (std::atof (kbs.c_str ()));
+      packets[row].push_back (std::atof (received.c_str ()));
+    }
+  }
+
+  std::ofstream csv (out.c_str ());
+  csv << "SimulationSecond," <<
+  "ReceiveRate," <<
+  "ReceiveRateCi95," <<
+  "PacketsReceived," <<
+  "PacketsReceivedCi95," <<
+  "NumberOfSinks," <<
+  "RoutingProtocol," <<
+  "TransmissionPower," <<
+  "Replications" <<
+  std::endl;
+  for (std::size_t row = 0; row < second.size (); row++) {
+    ReplicationEstimate r = Estimate (rate[row]);
+    ReplicationEstimate p = Estimate (packets[row]);
+    csv << Estimate (second[row]).mean << ","
+        << r.mean << "," << r.ci95 << ","
+        << p.mean << "," << p.ci95 << ","
+        << fixed[row] << ","
+        << r.n
+        << std::endl;
+  }
+  csv.close ();
+}
+
+void ReplicationRunner::WriteFlowSummaries (const std::vector<std::pair<uint32_t, FlowSummary> > &summaries, const std::string &out) {
+  std::vector<double> tx, rx, lost, throughput, delay, warmup, postKbps, postDelay;
+  std::ofstream csv (out.c_str ());
+  csv << "Run,TxPackets,RxPackets,LostPackets,ThroughputKbps,MeanDelay,Warmup,PostWarmupKbps,PostWarmupDelay" << std::endl;
+  for (std::size_t i = 0; i < summaries.size (); i++) {
+    const FlowSummary &s = summaries[i].second;
+    csv << summaries[i].first << "," << s.txPackets << "," << s.rxPackets << ","
+        << s.lostPackets << "," << s.throughputKbps << "," << s.meanDelay << "," << s.warmup << ","
+        << s.postWarmupKbps << "," << s.postWarmupDelay << std::endl;
+    tx.push_back (s.txPackets);
+    rx.push_back (s.rxPackets);
+    lost.push_back (s.lostPackets);
+    throughput.push_back (s.throughputKbps);
+    delay.push_back (s.meanDelay);
+    // Runs without a detected warm-up end stay out of its estimate
+    if (s.warmup >= 0) {
+      warmup.push_back (s.warmup);
+    }
+    if (s.postWarmupKbps >= 0) {
+      postKbps.push_back (s.postWarmupKbps);
+    }
+    if (s.postWarmupDelay >= 0) {
+      postDelay.push_back (s.postWarmupDelay);
+    }
+  }
+  ReplicationEstimate e[] = {Estimate (tx), Estimate (rx), Estimate (lost), Estimate (throughput), Estimate (delay),
+                            Estimate (warmup), Estimate (postKbps), Estimate (postDelay)};
+  csv << "mean";
+  for (int i = 0; i < 8; i++) {
+    csv << "," << e[i].mean;
+  }
+  csv << std::endl << "ci95";
+  for (int i = 0; i < 8; i++) {
+    csv << "," << e[i].ci95;
+  }
+  csv << std::endl;
+  csv.close ();
+
+  NS_LOG_UNCOND ("Replications: " << summaries.size ());
+  NS_LOG_UNCOND ("Rx Packets: " << e[1].mean << " +- " << e[1].ci95);
+  NS_LOG_UNCOND ("Lost Packets: " << e[2].mean << " +- " << e[2].ci95);
+  NS_LOG_UNCOND ("Throughput: " << e[3].mean << " +- " << e[3].ci95 << " Kbps");
+  NS_LOG_UNCOND ("Mean delay: " << e[4].mean << " +- " << e[4].ci95 << " s");
+  if (e[6].n > 0) {
+    NS_LOG_UNCOND ("After the warm-up, over " << e[6].n << " runs: " << e[6].mean << " +- " << e[6].ci95
+                   << " Kbps received");
+  }
+  if (e[7].n > 0) {
+    NS_LOG_UNCOND ("After the warm-up, over " << e[7].n << " runs: " << e[7].mean << " +- " << e[7].ci95
+                   << " s mean delay");
+  }
+}
+
+} // namespace ns3
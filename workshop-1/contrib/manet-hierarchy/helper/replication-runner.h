@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Totals of the measured flows of one replica, sent back to the runner.
+struct FlowSummary {
+  uint64_t txPackets;
+  uint64_t rxPackets;
+  uint64_t lostPackets;
+  double throughputKbps;
+  double meanDelay;       // s, over received packets
+  double deliveredKbps;   // at the sink socket, from the sender start
+  uint64_t controlBytes;  // routing control sent at the IP layer, 0 unless counted
+  uint64_t events;        // simulator events executed
+  double warmup;          // s, detected end of the warm-up, -1 if none
+  // Means of the measured flow's per-second samples past the warm-up, -1
+  // without one: received payload kbit/s, and delay weighted by bytes
+  double postWarmupKbps;
+  double postWarmupDelay; // s, also -1 without --latencyStats
+};
+
+// Mean and 95% confidence half-width of a sample.
+struct ReplicationEstimate {
+  double mean;
+  double ci95;
+  uint32_t n;
+};
+
+/*
+ * Runs independent replicas in child processes, at most a core budget of them
+ * at a time, taking run numbers from a queue. The ns-3 Simulator is a process
+ * singleton, so each replica gets a fresh fork of the not yet simulated
+ * parent, runs its job and pipes its FlowSummary back.
+ */
+class ReplicationRunner {
+public:
+  // Called in the child with the RngRun of the replica.
+  typedef std::function<FlowSummary (uint32_t run)> Job;
+
+  ReplicationRunner ();
+
+  void SetReplications (uint32_t replications);
+  void SetFirstRun (uint32_t run);
+  // 0 uses every online core.
+  void SetCores (uint32_t cores);
+
+  // Returns the summaries of the replicas that finished, in run order.
+  std::vector<std::pair<uint32_t, FlowSummary> > Run (Job job);
+
+  static ReplicationEstimate Estimate (const std::vector<double> &samples);
+  // Two-sided 95% Student t quantile.
+  static double StudentT95 (uint32_t df);
+  // Averages per-second CSVs written by RoutingExperiment row by row into
+  // one CSV with a 95% confidence half-width next to each rate column.
+  static void MergeCsv (const std::vector<std::string> &files, const std::string &out);
+  static void WriteFlowSummaries (const std::vector<std::pair<uint32_t, FlowSummary> > &summaries, const std::string &out);
+
+private:
+  uint32_t m_replications;
+  uint32_t m_firstRun;
+  uint32_t m_cores;
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
@@ -0,0 +1,1181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "routing-experiment.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/olsr-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/mobility-store.h"
+#include "ns3/workload-tag.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("manet-routing-compare");
+
+RoutingExperiment::RoutingExperiment ()
+  : port (9),
+    bytesTotal (0),
+    packetsReceived (0),
+    m_CSVfileName ("manet-routing.output.csv"),
+    m_traceMobility (false),
+    m_minSpeed (0.0),
+    m_steadyMobility (false),
+    m_protocol (1), // 1=OLSR, 2=AODV
+    m_lean (false),
+    m_countControl (false),
+    m_controlStats (false),
+    m_routingScope ("all"),
+    m_oracleInterval (1.0),
+    m_oracleMinRxPower (-82.0),
+    m_tableStats (false),
+    m_tablesConverged (-1.0),
+    m_meanTableSize (0.0),
+    m_maxTableSize (0),
+    m_headSelection ("first"),
+    m_senderIndex (0),
+    m_spatialCulling (false),
+    m_lossCacheErrorDb (0.0),
+    m_batchRxPower (false),
+    m_verifyBatch (false),
+    m_replications (1),
+    m_cores (0),
+    m_forkAfterSetup (false),
+    m_traceName ("manet-routing-compare"),
+    m_totalTime (200.0),
+    m_streamIndex (0),
+    m_flowProbes ("all"),
+    m_probeSampleRatio (0.0),
+    m_senderStart (0.0),
+    m_sinkBytes (0),
+    m_controlBytes (0),
+    m_mobilityTraceFormat ("binary"),
+    m_mobilitySampleInterval (0.0),
+    m_warmStart (0.0),
+    m_binaryReceiveTrace (false),
+    m_metricsFormat ("csv"),
+    m_metricsFlushRows (0),
+    m_flowStatsInterval (0.0),
+    m_lostPacketTimeout (10.0),
+    m_maxInFlight (0),
+    m_latencyStats (false),
+    m_measuredLatencyFlow (0),
+    m_workloadLatencyFlow (0),
+    m_trafficStats (false),
+    m_busyGap (1.0),
+    m_measuredTrafficFlow (0),
+    m_workloadTrafficFlow (0),
+    m_targetPrecision (0.0),
+    m_stopMetrics ("throughput"),
+    m_minBatches (10),
+    m_batchSize (5),
+    m_throughputMetric (-1),
+    m_delayMetric (-1),
+    m_detectWarmup (false),
+    m_throughputSeries (-1),
+    m_delaySeries (-1),
+    m_truncation (-1.0)
+{
+  m_flowSummary = FlowSummary ();
+}
+
+void RoutingExperiment::SetLayerSpec (const LayerSpec &spec) {
+  m_layerSpec = spec;
+}
+
+void RoutingExperiment::SetSenderIndex (uint32_t index) {
+  m_senderIndex = index;
+}
+
+void RoutingExperiment::CheckThroughput () {
+  double kbs = (bytesTotal * 8.0) / 1000;
+  bytesTotal = 0;
+
+  m_metrics->BeginRow ();
+  m_metrics->Add ((Simulator::Now ()).GetSeconds ());
+  m_metrics->Add (kbs);
+  m_metrics->Add (static_cast<int64_t> (packetsReceived));
+  m_metrics->Add (static_cast<int64_t> (m_nSinks));
+  m_metrics->Add (m_protocolName);
+  m_metrics->Add (m_txp);
+  m_metrics->EndRow ();
+
+  packetsReceived = 0;
+  // From the first full interval of the measured flow
+  if ((m_targetPrecision > 0 || m_detectWarmup) && Simulator::Now ().GetSeconds () >= m_senderStart + 1.0) {
+    SampleRunLength (kbs);
+  }
+  if (m_controlSink != 0) {
+    m_controlMonitor.Export ();
+  }
+  if (m_latencySink != 0) {
+    m_latency.Export ();
+  }
+  if (m_trafficSink != 0) {
+    m_traffic.Export ();
+  }
+  if (m_tableStats) {
+    SampleRoutingTables ();
+  }
+  Simulator::Schedule (Seconds (1.0), &RoutingExperiment::CheckThroughput, this);
+}
+
+void RoutingExperiment::SampleRunLength (double kbs) {
+  double delay = 0.0;
+  bool hasDelay = m_latencyStats && m_latency.GetIntervalDelay (m_measuredLatencyFlow, delay);
+  bool refill = false;
+  if (m_detectWarmup) {
+    double now = Simulator::Now ().GetSeconds ();
+    m_warmup.Add (m_throughputSeries, now, kbs);
+    if (hasDelay) {
+      m_warmup.Add (m_delaySeries, now, delay);
+    }
+    // The stopping rule only sees the samples past the end of the warm-up
+    if (!m_warmup.IsDetected ()) {
+      return;
+    }
+    if (m_warmup.GetTruncationTime () != m_truncation) {
+      m_truncation = m_warmup.GetTruncationTime ();
+      refill = true;
+    }
+  }
+  if (m_targetPrecision <= 0) {
+    return;
+  }
+  if (refill) {
+    RefillRunLength ();
+  }
+  else {
+    if (m_throughputMetric >= 0) {
+      m_runLength.Add (m_throughputMetric, kbs);
+    }
+    if (m_delayMetric >= 0 && hasDelay) {
+      m_runLength.Add (m_delayMetric, delay);
+    }
+  }
+  if (m_runLength.IsPrecise ()) {
+    NS_LOG_UNCOND ("Run length: " << m_stopMetrics << " within " << 100 * m_targetPrecision << "% at "
+                   << Simulator::Now ().GetSeconds () << " s, stopping");
+    Simulator::Stop ();
+  }
+}
+
+// Restarts the stopping rule on the kept samples from the truncation point
+void RoutingExperiment::RefillRunLength (void) {
+  m_runLength.Reset ();
+  int32_t metrics[] = {m_throughputMetric, m_delayMetric};
+  int32_t series[] = {m_throughputSeries, m_delaySeries};
+  for (int i = 0; i < 2; i++) {
+    if (metrics[i] < 0) {
+      continue;
+    }
+    const std::vector<double> &times = m_warmup.GetTimes (series[i]);
+    const std::vector<double> &values = m_warmup.GetValues (series[i]);
+    for (std::size_t s = 0; s < values.size (); s++) {
+      if (times[s] >= m_truncation) {
+        m_runLength.Add (metrics[i], values[s]);
+      }
+    }
+  }
+}
+
+// Mean of a warm-up series from the truncation point, weighted by the
+// samples of another series at the same times unless weights is -1
+bool RoutingExperiment::TruncatedMean (int32_t series, int32_t weights, double &mean) const {
+  const std::vector<double> &times = m_warmup.GetTimes (series);
+  const std::vector<double> &values = m_warmup.GetValues (series);
+  std::size_t w = 0;
+  double sum = 0.0;
+  double total = 0.0;
+  for (std::size_t s = 0; s < values.size (); s++) {
+    if (times[s] < m_truncation) {
+      continue;
+    }
+    double weight = 1.0;
+    if (weights >= 0) {
+      const std::vector<double> &weightTimes = m_warmup.GetTimes (weights);
+      while (w < weightTimes.size () && weightTimes[w] < times[s]) {
+        w++;
+      }
+      if (w == weightTimes.size () || weightTimes[w] != times[s]) {
+        continue;
+      }
+      weight = m_warmup.GetValues (weights)[w];
+    }
+    sum += weight * values[s];
+    total += weight;
+  }
+  if (total <= 0) {
+    return false;
+  }
+  mean = sum / total;
+  return true;
+}
+
+void RoutingExperiment::WriteRunMetadata (std::string fileName) {
+  Ptr<OutputStreamWrapper> metadata = Create<OutputStreamWrapper> (fileName, std::ios::out);
+  std::ostream *os = metadata->GetStream ();
+  *os << std::setprecision (10);
+  *os << "end " << Simulator::Now ().GetSeconds () << std::endl
+      << "seed " << RngSeedManager::GetSeed () << std::endl
+      << "run " << RngSeedManager::GetRun () << std::endl
+      << "layers " << m_layerSpec.ToString () << std::endl
+      << "sender " << m_senderIndex << std::endl;
+  *os << "# Per-second samples before the truncation point are warm-up, -1 if none was detected" << std::endl
+      << "truncation " << m_flowSummary.warmup << std::endl;
+}
+
+void RoutingExperiment::SampleRoutingTables (void) {
+  const NodeContainer &nodes = m_topology.GetNodes ();
+  std::vector<uint32_t> seen (NodeList::GetNNodes (), std::numeric_limits<uint32_t>::max ());
+  bool full = m_tablesConverged < 0;
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++) {
+    uint32_t id = nodes.Get (i)->GetId ();
+    std::vector<olsr::RoutingTableEntry> entries = RoutingProtocolFactory::GetOlsr (nodes.Get (i))->GetRoutingTableEntries ();
+    total += entries.size ();
+    m_maxTableSize = std::max<uint64_t> (m_maxTableSize, entries.size ());
+    if (!full) {
+      continue;
+    }
+    // Count the distinct nodes the entries lead to
+    uint32_t reached = 0;
+    for (std::size_t e = 0; e < entries.size (); e++) {
+      std::map<Ipv4Address, uint32_t>::const_iterator node = m_addressNode.find (entries[e].destAddr);
+      if (node != m_addressNode.end () && node->second != id && seen[node->second] != id) {
+        seen[node->second] = id;
+        reached++;
+      }
+    }
+    full = reached == nodes.GetN () - 1;
+  }
+  m_meanTableSize = nodes.GetN () > 0 ? static_cast<double> (total) / nodes.GetN () : 0.0;
+  if (full) {
+    m_tablesConverged = Simulator::Now ().GetSeconds ();
+  }
+}
+
+static inline std::string PrintReceivedPacket (Ptr<Socket> socket, Ptr<Packet> packet, Address senderAddress) {
+  std::ostringstream oss;
+  oss << std::setprecision (10);
+
+  double t2 = Simulator::Now ().GetSeconds ();
+
+  oss << "Tiempo recibido: " << t2  << " Id paquete: " << packet->GetUid () << " " << socket->GetNode ()->GetId ();
+  if (InetSocketAddress::IsMatchingType (senderAddress)) {
+    InetSocketAddress addr = InetSocketAddress::ConvertFrom (senderAddress);
+    oss << " received one packet from " << addr.GetIpv4 ();
+  }
+  else {
+    oss << " received one packet!";
+  }
+  return oss.str ();
+}
+
+void RoutingExperiment::IpTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface) {
+  if (!m_controlStats) {
+    if (m_routing.IsControl (packet)) {
+      m_controlBytes += packet->GetSize ();
+    }
+    return;
+  }
+  m_routing.GetControlMessages (packet, m_controlMessages);
+  if (!m_controlMessages.empty ()) {
+    m_controlBytes += packet->GetSize ();
+    m_controlMonitor.Tx (ipv4->GetObject<Node> ()->GetId (), interface, m_controlMessages);
+  }
+}
+
+void RoutingExperiment::IpRx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface) {
+  m_routing.GetControlMessages (packet, m_controlMessages);
+  if (!m_controlMessages.empty ()) {
+    m_controlMonitor.Rx (ipv4->GetObject<Node> ()->GetId (), interface, m_controlMessages);
+  }
+}
+
+void RoutingExperiment::StampSent (Ptr<const Packet> packet) {
+  packet->AddPacketTag (WorkloadTag (0, Simulator::Now ()));
+}
+
+void RoutingExperiment::WorkloadRx (Ptr<const Packet> packet, uint32_t flow) {
+  if (m_latencyStats) {
+    m_latency.Record (m_workloadLatencyFlow + flow, packet);
+  }
+  if (m_trafficStats) {
+    m_traffic.Record (m_workloadTrafficFlow + flow, packet->GetSize ());
+  }
+}
+
+void RoutingExperiment::ReceivePacket (Ptr<Socket> socket) {
+  Ptr<Packet> packet;
+  Address senderAddress;
+  while ((packet = socket->RecvFrom (senderAddress))) {
+    bytesTotal += packet->GetSize ();
+    m_sinkBytes += packet->GetSize ();
+    packetsReceived += 1;
+    if (m_latencyStats) {
+      m_latency.Record (m_measuredLatencyFlow, packet);
+    }
+    if (m_trafficStats) {
+      m_traffic.Record (m_measuredTrafficFlow, packet->GetSize ());
+    }
+    if (m_binaryReceiveTrace) {
+      bool hasSender = InetSocketAddress::IsMatchingType (senderAddress);
+      uint32_t sender = hasSender ? InetSocketAddress::ConvertFrom (senderAddress).GetIpv4 ().Get () : 0;
+      m_receiveTrace.Write (Simulator::Now ().GetSeconds (), packet->GetUid (), socket->GetNode ()->GetId (),
+                            hasSender, sender, packet->GetSize ());
+    }
+    else if (!m_lean) {
+      NS_LOG_UNCOND (PrintReceivedPacket (socket, packet, senderAddress));
+    }
+  }
+}
+
+Ptr<Socket> RoutingExperiment::SetupPacketReceive (Ipv4Address addr, Ptr<Node> node) {
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Socket> sink = Socket::CreateSocket (node, tid);
+  InetSocketAddress local = InetSocketAddress (addr, port);
+  sink->Bind (local);
+  sink->SetRecvCallback (MakeCallback (&RoutingExperiment::ReceivePacket, this));
+  return sink;
+}
+
+std::string RoutingExperiment::CommandSetup (int argc, char **argv) {
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("CSVfileName", "The name of the CSV output file name", m_CSVfileName);
+  cmd.AddValue ("traceMobility", "Enable mobility tracing", m_traceMobility);
+  cmd.AddValue ("mobilityTraceFormat", "Mobility trace format, binary|ascii", m_mobilityTraceFormat);
+  cmd.AddValue ("minSpeed", "Lowest RandomWaypoint leg speed in m/s", m_minSpeed);
+  cmd.AddValue ("steadyMobility", "Start RandomWaypoint in its stationary distribution, needs --minSpeed above 0", m_steadyMobility);
+  cmd.AddValue ("mobilitySampleInterval", "Record every node at this interval in s instead of on course changes, 0 disables it (binary only)", m_mobilitySampleInterval);
+  cmd.AddValue ("protocol", "1=OLSR;2=AODV;3=DSDV;4=DSR;5=CLUSTER;6=ORACLE", m_protocol);
+  cmd.AddValue ("oracleInterval", "Time in s between recomputations of the oracle routes", m_oracleInterval);
+  cmd.AddValue ("oracleMinRxPower", "Weakest received power in dBm that still makes an oracle link", m_oracleMinRxPower);
+  cmd.AddValue ("countControl", "Count the routing control bytes sent at the IP layer", m_countControl);
+  cmd.AddValue ("controlStats", "Write routing control traffic per node, interface and message type every second (implies countControl)", m_controlStats);
+  cmd.AddValue ("routingScope", "Channels OLSR runs on, all|flat|<channel>:olsr|direct[,...], e.g. cluster:direct,upper3:direct", m_routingScope);
+  cmd.AddValue ("tableStats", "Sample the OLSR routing tables every second and report their size and convergence", m_tableStats);
+  cmd.AddValue ("latencyStats", "Write delay, jitter and hop percentiles at the sinks every second", m_latencyStats);
+  cmd.AddValue ("trafficStats", "Write the transfer rate, busy proportion and average traffic of every flow and cluster", m_trafficStats);
+  cmd.AddValue ("busyGap", "Receptions closer than this many s extend the same busy period", m_busyGap);
+  cmd.AddValue ("targetPrecision", "Stop once the 95% half-width of every stop metric is below this fraction of its mean, 0 runs to totalTime", m_targetPrecision);
+  cmd.AddValue ("stopMetrics", "Per-second metrics the stopping rule watches, throughput|delay[,...]", m_stopMetrics);
+  cmd.AddValue ("minBatches", "Batches the stopping rule needs before judging", m_minBatches);
+  cmd.AddValue ("detectWarmup", "Find the end of the warm-up of the per-second throughput and delay with MSER-5 and leave it out of the stopping rule", m_detectWarmup);
+  cmd.AddValue ("batchSize", "Seconds per batch until the stopping rule first merges batches", m_batchSize);
+  cmd.AddValue ("lean", "Leave packet metadata off and skip the per-packet receive log", m_lean);
+  cmd.AddValue ("layers", "Hierarchy shape, <clusters>x<nodes>[,<clusters>x<nodes>...]", m_layers);
+  cmd.AddValue ("headSelection", "Cluster head rule, first|random", m_headSelection);
+  cmd.AddValue ("workload", "Background flows, <pattern>[:<arrival>[:<rate>[:<packet size>]]][,...], e.g. convergecast:cbr,anytoany200:pareto:8kbps", m_workloadSpec);
+  cmd.AddValue ("sender", "Index of the layer-1 node that sends the flow", m_senderIndex);
+  cmd.AddValue ("spatialCulling", "Only schedule layer-1 receptions for PHYs in reception range", m_spatialCulling);
+  cmd.AddValue ("lossCacheErrorDb", "Cache Friis loss per distance bucket with this error bound in dB, 0 disables it", m_lossCacheErrorDb);
+  cmd.AddValue ("batchRxPower", "Compute layer-1 Friis rx power for all receivers of a frame in one batch", m_batchRxPower);
+  cmd.AddValue ("verifyBatch", "Check every batched rx power against the per-pair models", m_verifyBatch);
+  cmd.AddValue ("replications", "Number of independent replicas, each with its own RngRun", m_replications);
+  cmd.AddValue ("forkAfterSetup", "Build the topology once and fork the replicas just before Simulator::Run", m_forkAfterSetup);
+  cmd.AddValue ("warmStart", "Run once up to this time in s, then fork one continuation per traffic variant", m_warmStart);
+  cmd.AddValue ("trafficVariants", "Traffic of the warm-started runs, <rate>:<packet size>[,<rate>:<packet size>...]", m_trafficVariants);
+  cmd.AddValue ("binaryReceiveTrace", "Log received packets as binary records to <trace>.rx instead of text lines", m_binaryReceiveTrace);
+  cmd.AddValue ("metricsFormat", "Per-second metrics backend, csv|columnar", m_metricsFormat);
+  cmd.AddValue ("metricsFlushRows", "Write metrics every this many rows, 0 only at the end", m_metricsFlushRows);
+  cmd.AddValue ("flowProbes", "FlowMonitor probes on all nodes, or only on the endpoints of the measured flow, all|endpoints", m_flowProbes);
+  cmd.AddValue ("probeSampleRatio", "With endpoint probes, also probe this fraction of the other layer-1 nodes", m_probeSampleRatio);
+  cmd.AddValue ("flowStatsInterval", "Write per-flow FlowMonitor deltas every this many s, 0 disables it", m_flowStatsInterval);
+  cmd.AddValue ("lostPacketTimeout", "Packets in flight for longer than this many s are counted as lost", m_lostPacketTimeout);
+  cmd.AddValue ("maxInFlight", "Packets FlowMonitor may track at once, swept early as lost beyond that, 0 for no limit", m_maxInFlight);
+  cmd.AddValue ("totalTime", "Simulated time in s", m_totalTime);
+  cmd.AddValue ("cores", "Replicas run at a time, 0 for every core", m_cores);
+  cmd.Parse (argc, argv);
+
+  if (!m_layers.empty ()) {
+    m_layerSpec = LayerSpec::Parse (m_layers);
+  }
+  m_layerSpec.SetHeadSelection (LayerSpec::ParseHeadSelection (m_headSelection));
+  m_workload.SetPatterns (WorkloadHelper::Parse (m_workloadSpec));
+  m_routing.SetProtocol (m_protocol);
+  m_routing.SetScope (RoutingScope::Parse (m_routingScope));
+  NS_ABORT_MSG_IF (m_busyGap <= 0, "--busyGap must be positive");
+  if (m_targetPrecision > 0) {
+    NS_ABORT_MSG_IF (m_batchSize == 0, "--batchSize must be positive");
+    m_runLength.SetTarget (m_targetPrecision);
+    m_runLength.SetMinBatches (m_minBatches);
+    m_runLength.SetBatchSize (m_batchSize);
+    std::istringstream metrics (m_stopMetrics);
+    std::string metric;
+    while (std::getline (metrics, metric, ',')) {
+      if (metric == "throughput") {
+        m_throughputMetric = m_runLength.AddMetric (metric);
+      }
+      else if (metric == "delay") {
+        NS_ABORT_MSG_IF (!m_latencyStats, "The delay stop metric needs --latencyStats");
+        m_delayMetric = m_runLength.AddMetric (metric);
+      }
+      else {
+        NS_FATAL_ERROR ("Unknown stop metric '" << metric << "', expected throughput|delay");
+      }
+    }
+  }
+  if (m_detectWarmup) {
+    m_warmup.SetMinBatches (m_minBatches);
+    m_throughputSeries = m_warmup.AddSeries ("throughput");
+    if (m_latencyStats) {
+      m_delaySeries = m_warmup.AddSeries ("delay");
+    }
+  }
+  NS_ABORT_MSG_IF (m_steadyMobility && m_minSpeed <= 0, "--steadyMobility needs a positive --minSpeed");
+  NS_ABORT_MSG_IF (m_replications > 1 && m_forkAfterSetup
+                   && (m_protocol == RoutingProtocolFactory::DSDV || m_protocol == RoutingProtocolFactory::DSR),
+                   "DSDV and DSR streams cannot be re-seeded, so --forkAfterSetup replicas would not be independent");
+  NS_ABORT_MSG_IF (m_oracleInterval <= 0, "--oracleInterval must be positive");
+  m_routing.SetOracleInterval (Seconds (m_oracleInterval));
+  m_routing.SetOracleMinRxPower (m_oracleMinRxPower);
+  NS_ABORT_MSG_IF (m_tableStats && m_protocol != RoutingProtocolFactory::OLSR, "--tableStats needs OLSR");
+  m_countControl = m_countControl || m_controlStats;
+  NS_ABORT_MSG_IF (m_totalTime <= 11.0, "The flow starts between 10 and 11 s, --totalTime must be past that");
+  NS_ABORT_MSG_IF (m_flowProbes != "all" && m_flowProbes != "endpoints", "Unknown probe installation " << m_flowProbes);
+  NS_ABORT_MSG_IF (m_probeSampleRatio < 0 || m_probeSampleRatio > 1, "--probeSampleRatio must be within [0, 1]");
+  NS_ABORT_MSG_IF (m_mobilityTraceFormat != "binary" && m_mobilityTraceFormat != "ascii",
+                   "Unknown mobility trace format " << m_mobilityTraceFormat);
+  return m_CSVfileName;
+}
+
+void RoutingExperiment::WriteCsvHeader (std::string CSVfileName) {
+  std::ofstream out (CSVfileName.c_str ());
+  out << "SimulationSecond," <<
+  "ReceiveRate," <<
+  "PacketsReceived," <<
+  "NumberOfSinks," <<
+  "RoutingProtocol," <<
+  "TransmissionPower" <<
+  std::endl;
+  out.close ();
+}
+
+static std::string CsvBaseName (std::string CSVfileName) {
+  if (CSVfileName.size () > 4 && CSVfileName.compare (CSVfileName.size () - 4, 4, ".csv") == 0) {
+    CSVfileName.erase (CSVfileName.size () - 4);
+  }
+  return CSVfileName;
+}
+
+static void CopyFile (std::string from, std::string to) {
+  std::ifstream in (from.c_str (), std::ios::binary);
+  std::ofstream out (to.c_str (), std::ios::binary);
+  out << in.rdbuf ();
+}
+
+const FlowSummary &RoutingExperiment::GetFlowSummary (void) const {
+  return m_flowSummary;
+}
+
+std::string RoutingExperiment::GetRunFileName (std::string CSVfileName, uint32_t run, std::string extension) {
+  std::ostringstream oss;
+  oss << CsvBaseName (CSVfileName) << "-run" << run << extension;
+  return oss.str ();
+}
+
+void RoutingExperiment::Run (int nSinks, double txp, std::string CSVfileName) {
+  if (m_warmStart > 0) {
+    NS_ABORT_MSG_IF (m_replications > 1, "--warmStart and --replications cannot be combined");
+    RunWarmStart (nSinks, txp, CSVfileName);
+  }
+  else if (m_replications > 1 && m_metricsFormat != "csv") {
+    NS_FATAL_ERROR ("Replications are merged from CSV, use --metricsFormat=csv");
+  }
+  else if (m_replications > 1 && m_forkAfterSetup) {
+    RunForked (nSinks, txp, CSVfileName);
+  }
+  else if (m_replications > 1) {
+    RunReplications (nSinks, txp, CSVfileName);
+  }
+  else {
+    RunOnce (nSinks, txp, CSVfileName);
+  }
+}
+
+void RoutingExperiment::RunReplications (int nSinks, double txp, std::string CSVfileName) {
+  ReplicationRunner runner;
+  runner.SetReplications (m_replications);
+  runner.SetFirstRun (RngSeedManager::GetRun ());
+  runner.SetCores (m_cores);
+
+  std::vector<std::pair<uint32_t, FlowSummary> > summaries = runner.Run ([&] (uint32_t run) {
+    RngSeedManager::SetRun (run);
+    std::string runCsv = GetRunFileName (CSVfileName, run, ".csv");
+    WriteCsvHeader (runCsv);
+    std::ostringstream trace;
+    trace << m_traceName << "-run" << run;
+    m_traceName = trace.str ();
+    RunOnce (nSinks, txp, runCsv);
+    return m_flowSummary;
+  });
+
+  MergeReplications (CSVfileName, summaries);
+}
+
+void RoutingExperiment::MergeReplications (std::string CSVfileName, const std::vector<std::pair<uint32_t, FlowSummary> > &summaries) {
+  std::vector<std::string> files;
+  for (std::size_t i = 0; i < summaries.size (); i++) {
+    files.push_back (GetRunFileName (CSVfileName, summaries[i].first, ".csv"));
+  }
+  ReplicationRunner::MergeCsv (files, CSVfileName);
+  ReplicationRunner::WriteFlowSummaries (summaries, CsvBaseName (CSVfileName) + "-flows.csv");
+}
+
+void RoutingExperiment::RunOnce (int nSinks, double txp, std::string CSVfileName) {
+  RunOnceUntil (nSinks, txp, CSVfileName, m_totalTime);
+  Report ();
+}
+
+void RoutingExperiment::RunForked (int nSinks, double txp, std::string CSVfileName) {
+  Build (nSinks, txp);
+  NS_LOG_UNCOND ("Topology built once, forking replicas");
+
+  ReplicationRunner runner;
+  runner.SetReplications (m_replications);
+  runner.SetFirstRun (RngSeedManager::GetRun ());
+  runner.SetCores (m_cores);
+
+  std::vector<std::pair<uint32_t, FlowSummary> > summaries = runner.Run ([&] (uint32_t run) {
+    RngSeedManager::SetRun (run);
+    Reseed ();
+    m_CSVfileName = GetRunFileName (CSVfileName, run, ".csv");
+    WriteCsvHeader (m_CSVfileName);
+    std::ostringstream trace;
+    trace << m_traceName << "-run" << run;
+    m_traceName = trace.str ();
+    Execute ();
+    return m_flowSummary;
+  });
+  Simulator::Destroy ();
+
+  MergeReplications (CSVfileName, summaries);
+}
+
+std::vector<RoutingExperiment::TrafficVariant> RoutingExperiment::ParseTrafficVariants (const std::string &variants) {
+  std::vector<TrafficVariant> parsed;
+  std::istringstream list (variants);
+  std::string item;
+  while (std::getline (list, item, ',')) {
+    std::string::size_type colon = item.find (':');
+    NS_ABORT_MSG_IF (colon == std::string::npos, "Traffic variant \"" << item << "\" is not <rate>:<packet size>");
+    TrafficVariant variant;
+    variant.rate = item.substr (0, colon);
+    variant.packetSize = std::atoi (item.substr (colon + 1).c_str ());
+    NS_ABORT_MSG_IF (variant.packetSize == 0, "Bad packet size in traffic variant \"" << item << "\"");
+    parsed.push_back (variant);
+  }
+  return parsed;
+}
+
+void RoutingExperiment::RunWarmStart (int nSinks, double txp, std::string CSVfileName) {
+  std::vector<TrafficVariant> variants = ParseTrafficVariants (m_trafficVariants);
+  NS_ABORT_MSG_IF (variants.empty (), "--warmStart needs at least one --trafficVariants entry");
+  NS_ABORT_MSG_IF (m_warmStart >= m_totalTime, "Warm-up of " << m_warmStart << " s leaves nothing to run");
+
+  RunOnceUntil (nSinks, txp, CSVfileName, m_warmStart);
+  WriteSnapshot (CsvBaseName (CSVfileName) + "-snapshot.txt");
+  if (m_mobilityTrace != 0) {
+    m_mobilityTrace->GetStream ()->flush ();
+  }
+  m_mobilityWriter.Flush ();
+  m_receiveTrace.Close ();
+  m_metrics->Flush ();
+  if (m_flowStatsSink != 0) {
+    m_flowStatsSink->Flush ();
+  }
+  if (m_controlSink != 0) {
+    m_controlSink->Flush ();
+  }
+  if (m_latencySink != 0) {
+    m_latencySink->Flush ();
+  }
+  if (m_trafficSink != 0) {
+    m_trafficSink->Flush ();
+  }
+  NS_LOG_UNCOND ("Warm-up done at " << Simulator::Now ().GetSeconds () << " s, forking " << variants.size () << " traffic variants");
+
+  ReplicationRunner runner;
+  runner.SetReplications (variants.size ());
+  runner.SetFirstRun (0);
+  runner.SetCores (m_cores);
+
+  std::string traceName = m_traceName;
+  std::vector<std::pair<uint32_t, FlowSummary> > summaries = runner.Run ([&] (uint32_t k) {
+    for (uint32_t i = 0; i < m_senderApps.GetN (); i++) {
+      m_senderApps.Get (i)->SetAttribute ("DataRate", DataRateValue (DataRate (variants[k].rate)));
+      m_senderApps.Get (i)->SetAttribute ("PacketSize", UintegerValue (variants[k].packetSize));
+    }
+    // Each continuation gets the warm-up rows and traces of its own
+    std::ostringstream suffix;
+    suffix << "-variant" << k;
+    std::string csv = CsvBaseName (CSVfileName) + suffix.str () + ".csv";
+    CopyFile (GetMetricsFileName (m_CSVfileName), GetMetricsFileName (csv));
+    if (m_flowStatsSink != 0) {
+      CopyFile (GetFlowStatsFileName (m_CSVfileName), GetFlowStatsFileName (csv));
+    }
+    if (m_controlSink != 0) {
+      CopyFile (GetControlStatsFileName (m_CSVfileName), GetControlStatsFileName (csv));
+    }
+    if (m_latencySink != 0) {
+      CopyFile (GetLatencyStatsFileName (m_CSVfileName), GetLatencyStatsFileName (csv));
+    }
+    if (m_trafficSink != 0) {
+      CopyFile (GetTrafficStatsFileName (m_CSVfileName), GetTrafficStatsFileName (csv));
+    }
+    m_CSVfileName = csv;
+    OpenMetrics (true);
+    if (m_flowStatsSink != 0) {
+      OpenFlowStats (true);
+    }
+    if (m_controlSink != 0) {
+      OpenControlStats (true);
+    }
+    if (m_latencySink != 0) {
+      OpenLatencyStats (true);
+    }
+    if (m_trafficSink != 0) {
+      OpenTrafficStats (true);
+    }
+    m_traceName = traceName + suffix.str ();
+    if (m_binaryReceiveTrace) {
+      CopyFile (traceName + ".rx", m_traceName + ".rx");
+      m_receiveTrace.Open (m_traceName + ".rx", true);
+    }
+    if (m_mobilityTrace != 0) {
+      std::ofstream *mob = dynamic_cast<std::ofstream *> (m_mobilityTrace->GetStream ());
+      if (mob != 0) {
+        mob->close ();
+        mob->open ((m_traceName + ".mob").c_str ());
+      }
+    }
+    if (m_mobilityWriter.IsOpen ()) {
+      m_mobilityWriter.Relocate (m_traceName + ".mobb");
+    }
+    Simulator::Stop (Seconds (m_totalTime) - Simulator::Now ());
+    Simulator::Run ();
+    Report ();
+    return m_flowSummary;
+  });
+  // The base trace keeps the warm-up only
+  m_mobilityWriter.Close ();
+  Simulator::Destroy ();
+
+  std::string out = CsvBaseName (CSVfileName) + "-variants.csv";
+  std::ofstream csv (out.c_str ());
+  csv << "Variant,DataRate,PacketSize,TxPackets,RxPackets,LostPackets,ThroughputKbps,MeanDelay" << std::endl;
+  for (std::size_t i = 0; i < summaries.size (); i++) {
+    const TrafficVariant &v = variants[summaries[i].first];
+    const FlowSummary &f = summaries[i].second;
+    csv << summaries[i].first << "," << v.rate << "," << v.packetSize << ","
+        << f.txPackets << "," << f.rxPackets << "," << f.lostPackets << ","
+        << f.throughputKbps << "," << f.meanDelay << std::endl;
+  }
+  csv.close ();
+}
+
+void RoutingExperiment::RunOnceUntil (int nSinks, double txp, std::string CSVfileName, double stopTime) {
+  m_CSVfileName = CSVfileName;
+  Build (nSinks, txp);
+
+  m_senderStart = m_startRng->GetValue (10.0, 11.0);
+  m_senderApps.Start (Seconds (m_senderStart));
+
+  StartRun ();
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+}
+
+void RoutingExperiment::WriteSnapshot (std::string fileName) {
+  Ptr<OutputStreamWrapper> snapshot = Create<OutputStreamWrapper> (fileName, std::ios::out);
+  std::ostream *os = snapshot->GetStream ();
+  *os << std::setprecision (10);
+  *os << "# Warm-start snapshot. Descriptive only: the state itself lives in the" << std::endl
+      << "# forked continuations, pending events and timers are not serialized." << std::endl;
+  *os << "time " << Simulator::Now ().GetSeconds () << std::endl
+      << "seed " << RngSeedManager::GetSeed () << std::endl
+      << "run " << RngSeedManager::GetRun () << std::endl
+      << "layers " << m_layerSpec.ToString () << std::endl
+      << "sender " << m_senderIndex << std::endl;
+
+  Ptr<MobilityStore> store = m_topology.GetMobilityStore ();
+  *os << "# node x y z vx vy vz legStart" << std::endl;
+  for (uint32_t i = 0; i < store->GetN (); i++) {
+    Vector p = store->GetPosition (i);
+    Vector v = store->GetVelocity (i);
+    *os << "node " << m_topology.GetNodes ().Get (i)->GetId () << " "
+        << p.x << " " << p.y << " " << p.z << " "
+        << v.x << " " << v.y << " " << v.z << " "
+        << store->GetLegStart (i).GetSeconds () << std::endl;
+  }
+
+  for (NodeContainer::Iterator i = m_topology.GetNodes ().Begin (); i != m_topology.GetNodes ().End (); ++i) {
+    Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4> ();
+    *os << "routing " << (*i)->GetId () << std::endl;
+    ipv4->GetRoutingProtocol ()->PrintRoutingTable (snapshot, Time::S);
+
+    Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (ipv4->GetRoutingProtocol ());
+    for (uint32_t j = 0; list != 0 && j < list->GetNRoutingProtocols (); j++) {
+      int16_t priority;
+      Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol> (list->GetRoutingProtocol (j, priority));
+      if (olsr == 0) {
+        continue;
+      }
+      *os << "mpr";
+      const olsr::MprSet &mprs = olsr->GetMprSet ();
+      for (olsr::MprSet::const_iterator m = mprs.begin (); m != mprs.end (); ++m) {
+        *os << " " << *m;
+      }
+      *os << std::endl;
+      const olsr::TopologySet &topology = olsr->GetTopologySet ();
+      for (olsr::TopologySet::const_iterator t = topology.begin (); t != topology.end (); ++t) {
+        *os << "topology " << t->destAddr << " " << t->lastAddr << " " << t->sequenceNumber
+            << " " << t->expirationTime.GetSeconds () << std::endl;
+      }
+    }
+  }
+}
+
+void RoutingExperiment::Reseed (void) {
+  // Every stream the replica draws from is set again under the new run;
+  // streams created with automatic indices keep the parent's run
+  int64_t stream = m_topology.Reseed (m_streamIndex);
+  const NodeContainer &layer1 = m_topology.GetNodes ();
+  stream += m_routing.AssignStreams (layer1, stream);
+  for (uint32_t i = 0; i < m_senderApps.GetN (); i++) {
+    stream += DynamicCast<OnOffApplication> (m_senderApps.Get (i))->AssignStreams (stream);
+  }
+  if (!m_workloadSpec.empty ()) {
+    m_workload.SetPickStream (stream++);
+    InstallWorkload ();
+  }
+  stream += m_workload.AssignStreams (stream);
+  m_startRng->SetStream (stream++);
+  m_senderStart = m_startRng->GetValue (10.0, 11.0);
+  m_senderApps.Start (Seconds (m_senderStart));
+}
+
+void RoutingExperiment::Build (int nSinks, double txp) {
+  if (!m_lean) {
+    Packet::EnablePrinting ();
+  }
+  m_nSinks = nSinks;
+  m_txp = txp;
+
+  std::string rate ("2048bps");
+  std::string phyMode ("DsssRate11Mbps");
+  int nodeSpeed = 20; //in m/s
+  int nodePause = 0; //in s
+  m_protocolName = "protocol";
+
+  Config::SetDefault ("ns3::OnOffApplication::PacketSize", StringValue ("64"));
+  Config::SetDefault ("ns3::OnOffApplication::DataRate", StringValue (rate));
+
+  //Set Non-unicastMode rate to unicast mode
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  int64_t streamIndex = 0; // used to get consistent mobility across scenarios
+
+  // Parameter: Geographical space 500x500 m
+  m_topology.SetLayerSpec (m_layerSpec);
+  m_topology.SetTxPower (txp);
+  m_topology.SetPhyMode (phyMode);
+  m_topology.SetArea (500.0, 500.0);
+  m_topology.SetMobility (nodeSpeed, nodePause);
+  m_topology.SetMinSpeed (m_minSpeed);
+  m_topology.SetSteadyStateMobility (m_steadyMobility);
+  m_topology.SetSpatialCulling (m_spatialCulling);
+  m_topology.SetLossCache (m_lossCacheErrorDb);
+  m_topology.SetBatchRxPower (m_batchRxPower, m_verifyBatch);
+  streamIndex = m_topology.Create (streamIndex);
+
+  // Only used again when replicas are forked after setup
+  m_streamIndex = streamIndex;
+
+  const NodeContainer &layer1 = m_topology.GetNodes ();
+  const NodeContainer &layer2 = m_topology.GetLayerNodes (2);
+  NS_ABORT_MSG_IF (m_senderIndex >= layer1.GetN (), "Sender " << m_senderIndex << " outside the " << layer1.GetN () << " nodes of layer 1");
+
+  m_routing.Install (layer1);
+  m_protocolName = m_routing.GetName ();
+  if (m_countControl) {
+    Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/Tx", MakeCallback (&RoutingExperiment::IpTx, this));
+  }
+  if (m_controlStats) {
+    Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/Rx", MakeCallback (&RoutingExperiment::IpRx, this));
+  }
+
+  NS_LOG_INFO ("assigning ip address");
+
+  m_topology.AssignAddresses ();
+  m_routing.Configure (m_topology);
+  if (m_controlStats) {
+    m_controlMonitor.SetTopology (m_topology);
+  }
+  if (m_tableStats) {
+    for (uint32_t c = 0; c < m_topology.GetNChannels (); c++) {
+      const HierarchyChannel &channel = m_topology.GetChannel (c);
+      for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+        m_addressNode[channel.interfaces.GetAddress (i)] = channel.nodes.Get (i)->GetId ();
+      }
+    }
+  }
+  const Ipv4InterfaceContainer &layer2I = m_topology.GetLayerInterfaces (2);
+
+  OnOffHelper onoff1 ("ns3::UdpSocketFactory", InetSocketAddress (layer2I.GetAddress (0), port));
+
+  // Poisson ??
+  onoff1.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"));
+  onoff1.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+
+  ////// RECEIVER
+  m_sink = SetupPacketReceive (layer2I.GetAddress (0), layer2.Get (0));
+
+  ////// SENDER
+  m_startRng = CreateObject<UniformRandomVariable> ();
+  m_senderApps = onoff1.Install (layer1.Get (m_senderIndex));
+  m_senderApps.Stop (Seconds (m_totalTime));
+
+  if (m_latencyStats) {
+    m_latency.SetTopology (m_topology);
+    m_measuredLatencyFlow = m_latency.AddFlow ("measured", layer2I.GetAddress (0), true);
+    m_sink->SetIpRecvTtl (true);
+    m_senderApps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&RoutingExperiment::StampSent, this));
+  }
+  if (m_trafficStats) {
+    m_traffic.SetBusyGap (Seconds (m_busyGap));
+    m_traffic.SetLinkRate (DataRate (WifiMode (phyMode).GetDataRate (22)));   // DSSS is 22 MHz wide
+    m_traffic.SetTopology (m_topology);
+    m_measuredTrafficFlow = m_traffic.AddFlow ("measured", layer2I.GetAddress (0), true);
+  }
+
+  InstallFlowProbes ();
+
+  // After the probes, so that the legacy automatic streams keep their draws.
+  // Replicas forked after setup install it in Reseed with their own draws.
+  if (!m_workloadSpec.empty () && !(m_replications > 1 && m_forkAfterSetup)) {
+    InstallWorkload ();
+  }
+}
+
+void RoutingExperiment::InstallWorkload (void) {
+  m_workloadApps = m_workload.Install (m_topology, m_nSinks);
+  m_workloadApps.Start (Seconds (10.0));
+  m_workloadApps.Stop (Seconds (m_totalTime));
+  if (m_latencyStats || m_trafficStats) {
+    m_workloadLatencyFlow = m_measuredLatencyFlow + 1;
+    m_workloadTrafficFlow = m_measuredTrafficFlow + 1;
+    for (uint32_t f = 0; f < m_workload.GetNFlows (); f++) {
+      std::ostringstream name;
+      name << "flow" << f;
+      if (m_latencyStats) {
+        m_latency.AddFlow (name.str (), m_workload.GetFlowDestination (f), false);
+      }
+      if (m_trafficStats) {
+        m_traffic.AddFlow (name.str (), m_workload.GetFlowDestination (f), false);
+      }
+    }
+    for (uint32_t i = 0; i < m_workloadApps.GetN (); i++) {
+      m_workloadApps.Get (i)->TraceConnectWithoutContext ("Rx", MakeCallback (&RoutingExperiment::WorkloadRx, this));
+    }
+  }
+}
+
+void RoutingExperiment::InstallFlowProbes (void) {
+  if (m_flowProbes == "all") {
+    m_monitor = m_flowmon.InstallAll ();
+    return;
+  }
+
+  // The sender and the sink see every packet of the flow once; hops in
+  // between only add forwarding counts and drop reasons
+  const NodeContainer &layer1 = m_topology.GetNodes ();
+  Ptr<Node> sender = layer1.Get (m_senderIndex);
+  Ptr<Node> sink = m_topology.GetLayerNodes (2).Get (0);
+  NodeContainer probed (sender);
+  if (sink != sender) {
+    probed.Add (sink);
+  }
+  if (m_probeSampleRatio > 0) {
+    // Created after m_startRng, so its automatic stream leaves the legacy draws alone
+    Ptr<UniformRandomVariable> sample = CreateObject<UniformRandomVariable> ();
+    for (uint32_t i = 0; i < layer1.GetN (); i++) {
+      Ptr<Node> node = layer1.Get (i);
+      if (node != sender && node != sink && sample->GetValue () < m_probeSampleRatio) {
+        probed.Add (node);
+      }
+    }
+  }
+  NS_LOG_UNCOND ("Flow monitor probes on " << probed.GetN () << " of " << layer1.GetN () << " nodes");
+  m_monitor = m_flowmon.Install (probed);
+}
+
+void RoutingExperiment::Execute (void) {
+  StartRun ();
+  Simulator::Stop (Seconds (m_totalTime));
+  Simulator::Run ();
+  Report ();
+}
+
+void RoutingExperiment::StartRun (void) {
+  m_mobilityTrace = 0;
+  if (m_traceMobility && m_mobilityTraceFormat == "ascii") {
+    AsciiTraceHelper ascii;
+    m_mobilityTrace = ascii.CreateFileStream (m_traceName + ".mob");
+    MobilityHelper::EnableAsciiAll (m_mobilityTrace);
+  }
+  else if (m_traceMobility) {
+    m_mobilityWriter.SetSampleInterval (Seconds (m_mobilitySampleInterval));
+    m_mobilityWriter.Open (m_traceName + ".mobb", m_topology.GetMobilityStore ());
+  }
+  if (m_binaryReceiveTrace) {
+    m_receiveTrace.Open (m_traceName + ".rx");
+  }
+
+  // The CSV header is written up front by WriteCsvHeader
+  OpenMetrics (m_metricsFormat == "csv");
+  if (m_flowStatsInterval > 0) {
+    OpenFlowStats (false);
+    m_flowStats.SetInterval (Seconds (m_flowStatsInterval));
+    m_flowStats.SetLossTimeout (Seconds (m_lostPacketTimeout));
+    m_flowStats.SetMaxInFlight (m_maxInFlight);
+    m_flowStats.Start (m_monitor, DynamicCast<Ipv4FlowClassifier> (m_flowmon.GetClassifier ()));
+  }
+  if (m_controlStats) {
+    OpenControlStats (false);
+  }
+  if (m_latencyStats) {
+    OpenLatencyStats (false);
+  }
+  if (m_trafficStats) {
+    OpenTrafficStats (false);
+  }
+
+  NS_LOG_INFO ("Run Simulation.");
+
+  CheckThroughput ();
+}
+
+std::string RoutingExperiment::GetMetricsFileName (std::string CSVfileName) const {
+  if (m_metricsFormat == "csv") {
+    return CSVfileName;
+  }
+  return CsvBaseName (CSVfileName) + MetricsSink::GetExtension (m_metricsFormat);
+}
+
+void RoutingExperiment::OpenMetrics (bool append) {
+  m_metrics = MetricsSink::Create (m_metricsFormat);
+  m_metrics->AddColumn ("SimulationSecond", MetricsSink::DOUBLE);
+  m_metrics->AddColumn ("ReceiveRate", MetricsSink::DOUBLE);
+  m_metrics->AddColumn ("PacketsReceived", MetricsSink::INTEGER);
+  m_metrics->AddColumn ("NumberOfSinks", MetricsSink::INTEGER);
+  m_metrics->AddColumn ("RoutingProtocol", MetricsSink::STRING);
+  m_metrics->AddColumn ("TransmissionPower", MetricsSink::DOUBLE);
+  m_metrics->SetFlushRows (m_metricsFlushRows);
+  m_metrics->Open (GetMetricsFileName (m_CSVfileName), append);
+}
+
+std::string RoutingExperiment::GetFlowStatsFileName (std::string CSVfileName) const {
+  return CsvBaseName (CSVfileName) + "-flowstats" + MetricsSink::GetExtension (m_metricsFormat);
+}
+
+void RoutingExperiment::OpenFlowStats (bool append) {
+  m_flowStatsSink = MetricsSink::Create (m_metricsFormat);
+  FlowStatsExporter::AddColumns (m_flowStatsSink);
+  m_flowStatsSink->SetFlushRows (m_metricsFlushRows);
+  m_flowStatsSink->Open (GetFlowStatsFileName (m_CSVfileName), append);
+  m_flowStats.SetSink (m_flowStatsSink);
+}
+
+std::string RoutingExperiment::GetControlStatsFileName (std::string CSVfileName) const {
+  return CsvBaseName (CSVfileName) + "-control" + MetricsSink::GetExtension (m_metricsFormat);
+}
+
+void RoutingExperiment::OpenControlStats (bool append) {
+  m_controlSink = MetricsSink::Create (m_metricsFormat);
+  ControlOverheadMonitor::AddColumns (m_controlSink);
+  m_controlSink->SetFlushRows (m_metricsFlushRows);
+  m_controlSink->Open (GetControlStatsFileName (m_CSVfileName), append);
+  m_controlMonitor.SetSink (m_controlSink);
+}
+
+std::string RoutingExperiment::GetLatencyStatsFileName (std::string CSVfileName) const {
+  return CsvBaseName (CSVfileName) + "-latency" + MetricsSink::GetExtension (m_metricsFormat);
+}
+
+void RoutingExperiment::OpenLatencyStats (bool append) {
+  m_latencySink = MetricsSink::Create (m_metricsFormat);
+  LatencyMonitor::AddColumns (m_latencySink);
+  m_latencySink->SetFlushRows (m_metricsFlushRows);
+  m_latencySink->Open (GetLatencyStatsFileName (m_CSVfileName), append);
+  m_latency.SetSink (m_latencySink);
+}
+
+std::string RoutingExperiment::GetTrafficStatsFileName (std::string CSVfileName) const {
+  return CsvBaseName (CSVfileName) + "-traffic" + MetricsSink::GetExtension (m_metricsFormat);
+}
+
+void RoutingExperiment::OpenTrafficStats (bool append) {
+  m_trafficSink = MetricsSink::Create (m_metricsFormat);
+  TrafficMonitor::AddColumns (m_trafficSink);
+  m_trafficSink->SetFlushRows (m_metricsFlushRows);
+  m_trafficSink->Open (GetTrafficStatsFileName (m_CSVfileName), append);
+  m_traffic.SetSink (m_trafficSink);
+}
+
+void RoutingExperiment::Report (void) {
+  std::string tr_name (m_traceName);
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (m_flowmon.GetClassifier ());
+
+  NS_LOG_UNCOND ("Checking for lost packets...");
+
+  if (m_flowStatsSink != 0) {
+    m_flowStats.Stop ();
+    m_flowStatsSink->Close ();
+    m_flowStatsSink = 0;
+    NS_LOG_UNCOND ("Flow monitor: at most " << m_flowStats.GetMaxTracked () << " packets tracked, "
+                   << m_flowStats.GetCappedLost () << " swept early by --maxInFlight");
+  }
+
+  m_monitor->CheckForLostPackets (Seconds (m_lostPacketTimeout));
+  const FlowMonitor::FlowStatsContainer &stats = m_monitor->GetFlowStats ();
+
+  NS_LOG_UNCOND ("Checking flows...");
+
+  m_flowSummary = FlowSummary ();
+  double delaySum = 0.0;
+  for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator iter = stats.begin (); iter != stats.end (); ++iter) {
+    Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (iter->first);
+
+    if (t.sourcePort == port || t.destinationPort == port) {
+      m_flowSummary.txPackets += iter->second.txPackets;
+      m_flowSummary.rxPackets += iter->second.rxPackets;
+      m_flowSummary.lostPackets += iter->second.lostPackets;
+      if (iter->second.rxPackets > 0) {
+        m_flowSummary.throughputKbps += iter->second.rxBytes * 8.0 / (iter->second.timeLastRxPacket.GetSeconds () - iter->second.timeFirstTxPacket.GetSeconds ()) / 1024;
+      }
+      delaySum += iter->second.delaySum.GetSeconds ();
+      NS_LOG_UNCOND ("Flow ID: " << iter->first << " Src Addr " << t.sourceAddress << " Dst Addr " << t.destinationAddress << " Protocol " << t.protocol);
+      NS_LOG_UNCOND ("Tx Packets: " << iter->second.txPackets);
+      NS_LOG_UNCOND ("Rx Packets: " << iter->second.rxPackets);
+      NS_LOG_UNCOND ("Lost Packets: " << iter->second.lostPackets);
+      NS_LOG_UNCOND ("Time First Tx Packet: " << iter->second.timeFirstTxPacket);
+      NS_LOG_UNCOND ("Time Last Tx Packet: " << iter->second.timeLastTxPacket);
+      NS_LOG_UNCOND ("Time First Rx Packet: " << iter->second.timeFirstRxPacket);
+      NS_LOG_UNCOND ("Time Last Rx Packet: " << iter->second.timeLastRxPacket);
+      NS_LOG_UNCOND ("Throughput: " << iter->second.rxBytes * 8.0 / (iter->second.timeLastRxPacket.GetSeconds () - iter->second.timeFirstTxPacket.GetSeconds ()) / 1024  << " Kbps");
+    }
+  }
+
+  if (m_flowSummary.rxPackets > 0) {
+    m_flowSummary.meanDelay = delaySum / m_flowSummary.rxPackets;
+  }
+  double now = Simulator::Now ().GetSeconds ();
+  if (now > m_senderStart) {
+    m_flowSummary.deliveredKbps = m_sinkBytes * 8.0 / 1000 / (now - m_senderStart);
+  }
+  m_flowSummary.controlBytes = m_controlBytes;
+  m_flowSummary.events = Simulator::GetEventCount ();
+  if (m_workload.GetNFlows () > 0) {
+    m_workload.Summarize ();
+  }
+  m_flowSummary.warmup = -1.0;
+  m_flowSummary.postWarmupKbps = -1.0;
+  m_flowSummary.postWarmupDelay = -1.0;
+  if (m_detectWarmup) {
+    m_warmup.Summarize ();
+    if (m_warmup.IsDetected ()) {
+      m_flowSummary.warmup = m_warmup.GetTruncationTime ();
+      // Steady-state figures of the measured flow, next to the whole-run ones
+      m_truncation = m_flowSummary.warmup;
+      double kbps;
+      if (TruncatedMean (m_throughputSeries, -1, kbps)) {
+        m_flowSummary.postWarmupKbps = kbps;
+      }
+      double delay;
+      if (m_delaySeries >= 0 && TruncatedMean (m_delaySeries, m_throughputSeries, delay)) {
+        m_flowSummary.postWarmupDelay = delay;
+      }
+      NS_LOG_UNCOND ("After the warm-up at " << m_truncation << " s: " << m_flowSummary.postWarmupKbps
+                     << " Kbps received, " << m_flowSummary.postWarmupDelay << " s mean delay");
+    }
+    WriteRunMetadata (CsvBaseName (m_CSVfileName) + "-run.txt");
+  }
+  if (m_targetPrecision > 0) {
+    m_runLength.Summarize ();
+  }
+  if (m_countControl) {
+    NS_LOG_UNCOND ("Routing control: " << m_controlBytes << " bytes sent by " << m_protocolName);
+  }
+  Ptr<OracleRoutingTable> oracle = m_routing.GetOracleTable ();
+  if (oracle != 0) {
+    NS_LOG_UNCOND ("Oracle routing: " << oracle->GetNUpdates () << " updates, " << oracle->GetNRebuilt ()
+                   << " BFS trees rebuilt");
+  }
+  if (m_tableStats) {
+    SampleRoutingTables ();
+    std::ostringstream converged;
+    if (m_tablesConverged < 0) {
+      converged << "never";
+    }
+    else {
+      converged << "at " << m_tablesConverged << " s";
+    }
+    NS_LOG_UNCOND ("Routing tables with scope " << m_routing.GetScope ().ToString () << ": full " << converged.str ()
+                   << ", " << m_meanTableSize << " entries per node at the end, at most " << m_maxTableSize);
+  }
+  if (m_controlSink != 0) {
+    m_controlMonitor.Export ();
+    m_controlSink->Close ();
+    m_controlSink = 0;
+    m_controlMonitor.Summarize ();
+  }
+  if (m_latencySink != 0) {
+    m_latency.ExportRun ();
+    m_latencySink->Close ();
+    m_latencySink = 0;
+    m_latency.Summarize ();
+  }
+  if (m_trafficSink != 0) {
+    m_traffic.ExportRun ();
+    m_trafficSink->Close ();
+    m_trafficSink = 0;
+    m_traffic.Summarize ();
+  }
+
+  if (m_lossCacheErrorDb > 0) {
+    uint64_t hits;
+    uint64_t misses;
+    m_topology.GetLossCacheStats (hits, misses);
+    NS_LOG_UNCOND ("Path-loss cache: " << hits << " hits, " << misses << " misses");
+  }
+
+  if (m_batchRxPower) {
+    uint64_t batched;
+    uint64_t mismatches;
+    m_topology.GetBatchStats (batched, mismatches);
+    NS_LOG_UNCOND ("Batched rx power: " << batched << " receptions, " << mismatches << " mismatches");
+  }
+
+  m_monitor->SerializeToXmlFile ((tr_name + ".flowmon").c_str (), false, false);
+  m_receiveTrace.Close ();
+  m_mobilityWriter.Close ();
+  m_metrics->Close ();
+
+  Simulator::Destroy ();
+}
+
+} // namespace ns3
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTING_EXPERIMENT_H
+#define ROUTING_EXPERIMENT_H
+
+#include "ns3/application-container.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "control-overhead-monitor.h"
+#include "flow-stats-exporter.h"
+#include "hierarchy-topology-helper.h"
+#include "latency-monitor.h"
+#include "layer-spec.h"
+#include "metrics-sink.h"
+#include "mobility-trace.h"
+#include "packet-receive-trace.h"
+#include "replication-runner.h"
+#include "routing-protocol-factory.h"
+#include "run-length-controller.h"
+#include "traffic-monitor.h"
+#include "warmup-detector.h"
+#include "workload-helper.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * MANET experiment over a layered cluster hierarchy: one OnOff flow from a
+ * layer-1 node to the first node of layer 2, sampled every second into a CSV.
+ * The scenario binaries only differ in the LayerSpec and sender they set.
+ *
+ * With --replications above 1, Run forks one replica per RngRun instead and
+ * merges their CSVs and flow statistics into the requested CSV. With
+ * --forkAfterSetup the topology, stacks and applications are built once and
+ * the replicas are forked from there, each re-seeding its streams and
+ * re-drawing positions and the sender start time before Simulator::Run.
+ *
+ * With --warmStart=T the run stops at T, past OLSR convergence, writes a
+ * descriptor of the positions, legs and routing tables, and forks one
+ * continuation per --trafficVariants entry from that state.
+ *
+ * --lean leaves packet metadata off and drops the per-packet receive lines.
+ * Metrics and FlowMonitor statistics are unchanged; they only use packet
+ * sizes, uids and FlowMonitor's own tags.
+ *
+ * --routingScope keeps OLSR off the channels it names (see RoutingScope) and
+ * --tableStats samples the OLSR tables every second for their size and the
+ * time until every node has a route to every other.
+ *
+ * --controlStats writes the routing control traffic sent and received per
+ * node, interface and message type each second, next to the metrics rows.
+ *
+ * --latencyStats stamps the send time on the measured and workload packets
+ * and writes delay, jitter and hop percentiles at the sinks each second.
+ *
+ * --trafficStats keeps the transfer rate D, busy proportion A and average
+ * traffic B of every flow and cluster online (see TrafficMonitor).
+ *
+ * --targetPrecision ends the run once the batch-means confidence intervals
+ * of the --stopMetrics are that tight, relative to their means; --totalTime
+ * is then only the cap.
+ *
+ * --detectWarmup runs MSER-5 over the per-second throughput and delay; the
+ * stopping rule and the FlowSummary post-warm-up means only count the
+ * samples past the detected truncation point, which is written to
+ * <csv>-run.txt and the FlowSummary.
+ *
+ * --steadyMobility draws the first positions, legs and speeds from the
+ * stationary RandomWaypoint distribution, with speeds from --minSpeed up.
+ *
+ * --workload adds background flows from the patterns of a WorkloadHelper,
+ * starting at 10 s; hotspots use nSinks sinks. The measured flow and its
+ * CSV are unchanged.
+ */
+class RoutingExperiment {
+public:
+  RoutingExperiment ();
+  void SetLayerSpec (const LayerSpec &spec);
+  void SetSenderIndex (uint32_t index);
+  void Run (int nSinks, double txp, std::string CSVfileName);
+  std::string CommandSetup (int argc, char **argv);
+  // Blanks out the CSV file and writes the column headers.
+  static void WriteCsvHeader (std::string CSVfileName);
+  // Per-replica file next to CSVfileName, e.g. out-run3.csv for out.csv.
+  static std::string GetRunFileName (std::string CSVfileName, uint32_t run, std::string extension);
+  // Measured flow of the last run in this process.
+  const FlowSummary &GetFlowSummary (void) const;
+
+private:
+  struct TrafficVariant {
+    std::string rate;
+    uint32_t packetSize;
+  };
+  static std::vector<TrafficVariant> ParseTrafficVariants (const std::string &variants);
+
+  void RunOnce (int nSinks, double txp, std::string CSVfileName);
+  void RunReplications (int nSinks, double txp, std::string CSVfileName);
+  void RunForked (int nSinks, double txp, std::string CSVfileName);
+  void RunWarmStart (int nSinks, double txp, std::string CSVfileName);
+  void RunOnceUntil (int nSinks, double txp, std::string CSVfileName, double stopTime);
+  void WriteSnapshot (std::string fileName);
+  void MergeReplications (std::string CSVfileName, const std::vector<std::pair<uint32_t, FlowSummary> > &summaries);
+  // Setup up to Simulator::Run, and the run itself with its reporting.
+  void Build (int nSinks, double txp);
+  void Reseed (void);
+  void Execute (void);
+  void StartRun (void);
+  void Report (void);
+  void OpenMetrics (bool append);
+  std::string GetMetricsFileName (std::string CSVfileName) const;
+  void InstallFlowProbes (void);
+  void InstallWorkload (void);
+  void OpenFlowStats (bool append);
+  std::string GetFlowStatsFileName (std::string CSVfileName) const;
+  Ptr<Socket> SetupPacketReceive (Ipv4Address addr, Ptr<Node> node);
+  void ReceivePacket (Ptr<Socket> socket);
+  void IpTx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  void IpRx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  void OpenControlStats (bool append);
+  std::string GetControlStatsFileName (std::string CSVfileName) const;
+  void StampSent (Ptr<const Packet> packet);
+  void WorkloadRx (Ptr<const Packet> packet, uint32_t flow);
+  void OpenLatencyStats (bool append);
+  std::string GetLatencyStatsFileName (std::string CSVfileName) const;
+  void OpenTrafficStats (bool append);
+  std::string GetTrafficStatsFileName (std::string CSVfileName) const;
+  void CheckThroughput ();
+  void SampleRoutingTables (void);
+  void SampleRunLength (double kbs);
+  void RefillRunLength (void);
+  bool TruncatedMean (int32_t series, int32_t weights, double &mean) const;
+  void WriteRunMetadata (std::string fileName);
+
+  uint32_t port;
+  uint32_t bytesTotal;
+  uint32_t packetsReceived;
+
+  std::string m_CSVfileName;
+  int m_nSinks;
+  std::string m_protocolName;
+  double m_txp;
+  bool m_traceMobility;
+  double m_minSpeed;
+  bool m_steadyMobility;
+  uint32_t m_protocol;
+  bool m_lean;                  // no packet metadata, no per-packet log lines
+  bool m_countControl;
+  bool m_controlStats;          // per node, interface and message type
+  std::string m_routingScope;
+  double m_oracleInterval;
+  double m_oracleMinRxPower;
+  bool m_tableStats;
+  std::map<Ipv4Address, uint32_t> m_addressNode;   // any interface -> node id
+  double m_tablesConverged;     // first sample with full tables, -1 before
+  double m_meanTableSize;
+  uint64_t m_maxTableSize;
+
+  LayerSpec m_layerSpec;
+  std::string m_layers;
+  std::string m_headSelection;
+  uint32_t m_senderIndex;
+  bool m_spatialCulling;
+  double m_lossCacheErrorDb;
+  bool m_batchRxPower;
+  bool m_verifyBatch;
+
+  uint32_t m_replications;
+  uint32_t m_cores;
+  bool m_forkAfterSetup;
+  std::string m_traceName;
+  FlowSummary m_flowSummary;
+
+  double m_totalTime;
+  int64_t m_streamIndex;
+  HierarchyTopologyHelper m_topology;
+  RoutingProtocolFactory m_routing;
+  FlowMonitorHelper m_flowmon;
+  Ptr<FlowMonitor> m_monitor;
+  std::string m_flowProbes;
+  double m_probeSampleRatio;
+  ApplicationContainer m_senderApps;
+  std::string m_workloadSpec;
+  WorkloadHelper m_workload;
+  ApplicationContainer m_workloadApps;
+  Ptr<UniformRandomVariable> m_startRng;
+  double m_senderStart;
+  uint64_t m_sinkBytes;
+  uint64_t m_controlBytes;
+  Ptr<Socket> m_sink;
+  Ptr<OutputStreamWrapper> m_mobilityTrace;   // ascii format only
+  std::string m_mobilityTraceFormat;
+  double m_mobilitySampleInterval;
+  MobilityTraceWriter m_mobilityWriter;
+
+  double m_warmStart;
+  std::string m_trafficVariants;
+
+  bool m_binaryReceiveTrace;
+  PacketReceiveTrace m_receiveTrace;
+
+  std::string m_metricsFormat;
+  uint32_t m_metricsFlushRows;
+  Ptr<MetricsSink> m_metrics;
+
+  double m_flowStatsInterval;
+  double m_lostPacketTimeout;
+  uint64_t m_maxInFlight;
+  FlowStatsExporter m_flowStats;
+  Ptr<MetricsSink> m_flowStatsSink;
+
+  ControlOverheadMonitor m_controlMonitor;
+  Ptr<MetricsSink> m_controlSink;
+  std::vector<RoutingProtocolFactory::ControlMessage> m_controlMessages;
+
+  bool m_latencyStats;
+  LatencyMonitor m_latency;
+  Ptr<MetricsSink> m_latencySink;
+  uint32_t m_measuredLatencyFlow;
+  uint32_t m_workloadLatencyFlow;   // of workload flow 0
+
+  bool m_trafficStats;
+  double m_busyGap;
+  TrafficMonitor m_traffic;
+  Ptr<MetricsSink> m_trafficSink;
+  uint32_t m_measuredTrafficFlow;
+  uint32_t m_workloadTrafficFlow;
+
+  double m_targetPrecision;
+  std::string m_stopMetrics;
+  uint32_t m_minBatches;
+  uint32_t m_batchSize;
+  RunLengthController m_runLength;
+  int32_t m_throughputMetric;   // -1 when not a stop metric
+  int32_t m_delayMetric;
+
+  bool m_detectWarmup;
+  WarmupDetector m_warmup;
+  int32_t m_throughputSeries;
+  int32_t m_delaySeries;        // -1 without --latencyStats
+  double m_truncation;          // s, -1 before a warm-up end is detected
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_EXPERIMENT_H */
@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "routing-protocol-factory.h"
+
+#include "ns3/abort.h"
+#include "ns3/aodv-packet.h"
+#include "ns3/dsr-fs-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/olsr-header.h"
+#include "ns3/udp-header.h"
+
+#include <map>
+#include <set>
+
+namespace ns3 {
+
+static const uint16_t g_olsrPort = 698;
+static const uint16_t g_aodvPort = 654;
+static const uint16_t g_dsdvPort = 269;
+static const uint8_t g_udpProtocol = 17;
+static const uint8_t g_dsrProtocol = 48;
+static const uint8_t g_dsrControlMessage = 1;
+
+RoutingProtocolFactory::RoutingProtocolFactory ()
+  : m_protocol (OLSR)
+{
+}
+
+void RoutingProtocolFactory::SetProtocol (uint32_t protocol) {
+  NS_ABORT_MSG_IF (protocol < OLSR || protocol > ORACLE, "No such routing protocol: " << protocol);
+  m_protocol = static_cast<Protocol> (protocol);
+}
+
+RoutingProtocolFactory::Protocol RoutingProtocolFactory::GetProtocol (void) const {
+  return m_protocol;
+}
+
+std::string RoutingProtocolFactory::GetName (void) const {
+  switch (m_protocol) {
+  case OLSR:
+    return "OLSR";
+  case AODV:
+    return "AODV";
+  case DSDV:
+    return "DSDV";
+  case DSR:
+    return "DSR";
+  case CLUSTER:
+    return "CLUSTER";
+  case ORACLE:
+    return "ORACLE";
+  }
+  return "";
+}
+
+void RoutingProtocolFactory::Install (const NodeContainer &nodes) {
+  Ipv4ListRoutingHelper list;
+  NS_ABORT_MSG_IF (m_protocol != OLSR && !m_scope.IsAllOlsr (), "--routingScope only applies to OLSR");
+  switch (m_protocol) {
+  case OLSR:
+    list.Add (m_olsr, 100);
+    if (!m_scope.IsAllOlsr ()) {
+      list.Add (m_static, 200);
+    }
+    break;
+  case AODV:
+    list.Add (m_aodv, 100);
+    break;
+  case DSDV:
+    list.Add (m_dsdv, 100);
+    break;
+  case CLUSTER:
+    list.Add (m_cluster, 100);
+    break;
+  case ORACLE:
+    list.Add (m_oracle, 100);
+    break;
+  case DSR:
+    m_internet.Install (nodes);
+    m_dsrMain.Install (m_dsr, nodes);
+    return;
+  }
+  m_internet.SetRoutingHelper (list);
+  m_internet.Install (nodes);
+}
+
+int64_t RoutingProtocolFactory::AssignStreams (const NodeContainer &nodes, int64_t stream) {
+  int64_t start = stream;
+  stream += m_internet.AssignStreams (nodes, stream);
+  switch (m_protocol) {
+  case OLSR:
+    stream += m_olsr.AssignStreams (nodes, stream);
+    break;
+  case AODV:
+    stream += m_aodv.AssignStreams (nodes, stream);
+    break;
+  case CLUSTER:
+    stream += m_cluster.AssignStreams (nodes, stream);
+    break;
+  case DSDV:
+  case DSR:
+    // Neither helper exposes its random variables; RoutingExperiment
+    // refuses to fork replicas of them after setup
+    break;
+  case ORACLE:
+    break;
+  }
+  return stream - start;
+}
+
+void RoutingProtocolFactory::SetOracleInterval (Time interval) {
+  m_oracle.SetInterval (interval);
+}
+
+void RoutingProtocolFactory::SetOracleMinRxPower (double minRxPowerDbm) {
+  m_oracle.SetMinRxPower (minRxPowerDbm);
+}
+
+Ptr<OracleRoutingTable> RoutingProtocolFactory::GetOracleTable (void) const {
+  return m_oracle.GetTable ();
+}
+
+void RoutingProtocolFactory::SetScope (const RoutingScope &scope) {
+  m_scope = scope;
+}
+
+const RoutingScope &RoutingProtocolFactory::GetScope (void) const {
+  return m_scope;
+}
+
+void RoutingProtocolFactory::Configure (const HierarchyTopologyHelper &topology) {
+  if (m_protocol == CLUSTER) {
+    ClusterRoutingHelper::Configure (topology);
+  }
+  if (m_protocol == ORACLE) {
+    m_oracle.Configure (topology);
+  }
+  if (m_protocol != OLSR || m_scope.IsAllOlsr ()) {
+    return;
+  }
+
+  // Interfaces in direct mode, per node
+  std::map<uint32_t, std::set<uint32_t> > excluded;
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    if (m_scope.GetMode (channel) != RoutingScope::DIRECT) {
+      continue;
+    }
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      Ptr<Node> node = channel.nodes.Get (i);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      uint32_t interface = ipv4->GetInterfaceForDevice (channel.devices.Get (i));
+      excluded[node->GetId ()].insert (interface);
+      GetOlsr (node)->AddHostNetworkAssociation (channel.interfaces.GetAddress (i), Ipv4Mask ("255.255.255.255"));
+    }
+  }
+
+  // The static instance runs ahead of OLSR, so it may only keep the
+  // connected routes of the excluded interfaces
+  const NodeContainer &nodes = topology.GetNodes ();
+  for (uint32_t n = 0; n < nodes.GetN (); n++) {
+    Ptr<Node> node = nodes.Get (n);
+    const std::set<uint32_t> &interfaces = excluded[node->GetId ()];
+    GetOlsr (node)->SetInterfaceExclusions (interfaces);
+    Ptr<Ipv4StaticRouting> routing = m_static.GetStaticRouting (node->GetObject<Ipv4> ());
+    for (uint32_t r = routing->GetNRoutes (); r > 0; r--) {
+      uint32_t interface = routing->GetRoute (r - 1).GetInterface ();
+      if (interface != 0 && interfaces.count (interface) == 0) {
+        routing->RemoveRoute (r - 1);
+      }
+    }
+  }
+}
+
+Ptr<olsr::RoutingProtocol> RoutingProtocolFactory::GetOlsr (Ptr<Node> node) {
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (node->GetObject<Ipv4> ()->GetRoutingProtocol ());
+  for (uint32_t i = 0; list != 0 && i < list->GetNRoutingProtocols (); i++) {
+    int16_t priority;
+    Ptr<olsr::RoutingProtocol> olsr = DynamicCast<olsr::RoutingProtocol> (list->GetRoutingProtocol (i, priority));
+    if (olsr != 0) {
+      return olsr;
+    }
+  }
+  return 0;
+}
+
+bool RoutingProtocolFactory::IsControl (Ptr<const Packet> packet) const {
+  Ptr<Packet> copy = packet->Copy ();
+  Ipv4Header ip;
+  copy->RemoveHeader (ip);
+  if (m_protocol == DSR) {
+    if (ip.GetProtocol () != g_dsrProtocol) {
+      return false;
+    }
+    dsr::DsrFsHeader dsr;
+    copy->PeekHeader (dsr);
+    return dsr.GetMessageType () == g_dsrControlMessage;
+  }
+  if (ip.GetProtocol () != g_udpProtocol) {
+    return false;
+  }
+  UdpHeader udp;
+  copy->PeekHeader (udp);
+  switch (m_protocol) {
+  case OLSR:
+    return udp.GetDestinationPort () == g_olsrPort;
+  case AODV:
+    return udp.GetDestinationPort () == g_aodvPort;
+  case DSDV:
+    return udp.GetDestinationPort () == g_dsdvPort;
+  case CLUSTER:
+    return udp.GetDestinationPort () == ClusterRoutingProtocol::PORT;
+  case DSR:
+  case ORACLE:
+    break;
+  }
+  return false;
+}
+
+void RoutingProtocolFactory::GetControlMessages (Ptr<const Packet> packet, std::vector<ControlMessage> &messages) const {
+  messages.clear ();
+  if (!IsControl (packet)) {
+    return;
+  }
+  Ptr<Packet> copy = packet->Copy ();
+  Ipv4Header ip;
+  copy->RemoveHeader (ip);
+  ControlMessage message;
+  message.type = CONTROL_OTHER;
+  message.bytes = packet->GetSize ();
+  if (m_protocol == DSR) {
+    message.type = DSR_CONTROL;
+    messages.push_back (message);
+    return;
+  }
+  UdpHeader udp;
+  copy->RemoveHeader (udp);
+
+  switch (m_protocol) {
+  case OLSR: {
+    olsr::PacketHeader olsrPacket;
+    copy->RemoveHeader (olsrPacket);
+    uint32_t left = olsrPacket.GetPacketLength () - olsrPacket.GetSerializedSize ();
+    uint32_t overhead = packet->GetSize () - left;
+    while (left > 0 && copy->GetSize () > 0) {
+      olsr::MessageHeader olsrMessage;
+      copy->RemoveHeader (olsrMessage);
+      uint32_t size = olsrMessage.GetSerializedSize ();
+      if (size == 0 || size > left) {
+        break;
+      }
+      switch (olsrMessage.GetMessageType ()) {
+      case olsr::MessageHeader::HELLO_MESSAGE:
+        message.type = OLSR_HELLO;
+        break;
+      case olsr::MessageHeader::TC_MESSAGE:
+        message.type = OLSR_TC;
+        break;
+      case olsr::MessageHeader::MID_MESSAGE:
+        message.type = OLSR_MID;
+        break;
+      case olsr::MessageHeader::HNA_MESSAGE:
+        message.type = OLSR_HNA;
+        break;
+      }
+      message.bytes = size + overhead;
+      messages.push_back (message);
+      overhead = 0;
+      left -= size;
+    }
+    if (messages.empty ()) {
+      message.bytes = packet->GetSize ();
+      messages.push_back (message);
+    }
+    return;
+  }
+  case AODV: {
+    aodv::TypeHeader type;
+    copy->RemoveHeader (type);
+    if (type.IsValid ()) {
+      switch (type.Get ()) {
+      case aodv::AODVTYPE_RREQ:
+        message.type = AODV_RREQ;
+        break;
+      case aodv::AODVTYPE_RREP:
+        message.type = AODV_RREP;
+        break;
+      case aodv::AODVTYPE_RERR:
+        message.type = AODV_RERR;
+        break;
+      case aodv::AODVTYPE_RREP_ACK:
+        message.type = AODV_RREP_ACK;
+        break;
+      }
+    }
+    break;
+  }
+  case DSDV:
+    message.type = DSDV_UPDATE;
+    break;
+  case CLUSTER: {
+    uint8_t type = 0;
+    copy->CopyData (&type, 1);
+    if (type == ClusterRoutingHeader::HELLO) {
+      message.type = CLUSTER_HELLO;
+    }
+    else if (type == ClusterRoutingHeader::SUMMARY) {
+      message.type = CLUSTER_SUMMARY;
+    }
+    break;
+  }
+  case DSR:
+  case ORACLE:
+    break;
+  }
+  messages.push_back (message);
+}
+
+std::string RoutingProtocolFactory::GetControlTypeName (ControlType type) {
+  switch (type) {
+  case OLSR_HELLO:
+  case CLUSTER_HELLO:
+    return "HELLO";
+  case OLSR_TC:
+    return "TC";
+  case OLSR_MID:
+    return "MID";
+  case OLSR_HNA:
+    return "HNA";
+  case AODV_RREQ:
+    return "RREQ";
+  case AODV_RREP:
+    return "RREP";
+  case AODV_RERR:
+    return "RERR";
+  case AODV_RREP_ACK:
+    return "RREP_ACK";
+  case DSDV_UPDATE:
+    return "UPDATE";
+  case DSR_CONTROL:
+    return "DSR";
+  case CLUSTER_SUMMARY:
+    return "SUMMARY";
+  case CONTROL_OTHER:
+    break;
+  }
+  return "OTHER";
+}
+
+} // namespace ns3
@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTING_PROTOCOL_FACTORY_H
+#define ROUTING_PROTOCOL_FACTORY_H
+
+#include "ns3/aodv-helper.h"
+#include "ns3/dsdv-helper.h"
+#include "ns3/dsr-helper.h"
+#include "ns3/dsr-main-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/olsr-helper.h"
+#include "ns3/olsr-routing-protocol.h"
+#include "ns3/packet.h"
+#include "cluster-routing-helper.h"
+#include "hierarchy-topology-helper.h"
+#include "oracle-routing-helper.h"
+#include "routing-scope.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Installs the Internet stack with one of the MANET routing protocols behind
+ * --protocol. OLSR, AODV and DSDV go in as the Ipv4ListRouting entry of the
+ * stack; DSR is an L4 protocol installed next to a plain stack instead.
+ *
+ * Also tells routing control packets apart from data as they leave Ipv4:
+ * UDP on the protocol's port for OLSR (698), AODV (654) and DSDV (269),
+ * control-typed DSR headers for DSR, and UDP on 7070 for cluster routing.
+ *
+ * ORACLE routes along shortest-hop paths computed from the true positions
+ * and sends no control traffic at all.
+ *
+ * CLUSTER runs ClusterRoutingProtocol, which needs the roles of the
+ * hierarchy; Configure passes them on once the topology is built. It also
+ * applies the RoutingScope of OLSR: interfaces in direct mode are excluded
+ * from OLSR and routed by a static instance ahead of it, which keeps only
+ * the connected routes of those interfaces.
+ *
+ * GetControlMessages further splits a control packet into its routing
+ * messages, e.g. the HELLO and TC messages OLSR bundles into one packet.
+ */
+class RoutingProtocolFactory {
+public:
+  enum Protocol {
+    OLSR = 1,
+    AODV = 2,
+    DSDV = 3,
+    DSR = 4,
+    CLUSTER = 5,
+    ORACLE = 6
+  };
+
+  enum ControlType {
+    OLSR_HELLO,
+    OLSR_TC,
+    OLSR_MID,
+    OLSR_HNA,
+    AODV_RREQ,
+    AODV_RREP,
+    AODV_RERR,
+    AODV_RREP_ACK,
+    DSDV_UPDATE,
+    DSR_CONTROL,
+    CLUSTER_HELLO,
+    CLUSTER_SUMMARY,
+    CONTROL_OTHER     // a control packet that does not parse
+  };
+
+  // One routing message and the bytes it accounts for. The IP, UDP and
+  // packet headers count towards the first message of a packet.
+  struct ControlMessage {
+    ControlType type;
+    uint32_t bytes;
+  };
+
+  RoutingProtocolFactory ();
+
+  // Aborts on numbers outside the enum.
+  void SetProtocol (uint32_t protocol);
+  Protocol GetProtocol (void) const;
+  std::string GetName (void) const;
+
+  void Install (const NodeContainer &nodes);
+  // Time between two recomputations of the oracle's routes.
+  void SetOracleInterval (Time interval);
+  // Weakest decodable power that still makes an oracle link, in dBm.
+  void SetOracleMinRxPower (double minRxPowerDbm);
+  // Zero unless ORACLE is configured.
+  Ptr<OracleRoutingTable> GetOracleTable (void) const;
+  // OLSR only; set before Install.
+  void SetScope (const RoutingScope &scope);
+  const RoutingScope &GetScope (void) const;
+  // Hands the topology's clusters to the protocols that use them and
+  // applies the scope. After the addresses are assigned.
+  void Configure (const HierarchyTopologyHelper &topology);
+  // Zero if the node does not run OLSR.
+  static Ptr<olsr::RoutingProtocol> GetOlsr (Ptr<Node> node);
+  // Streams of the stack and of the protocol where it has any.
+  int64_t AssignStreams (const NodeContainer &nodes, int64_t stream);
+
+  // For an IP packet with its header, as passed to Ipv4L3Protocol's Tx.
+  bool IsControl (Ptr<const Packet> packet) const;
+  // Routing messages of an IP packet; left empty for data packets.
+  void GetControlMessages (Ptr<const Packet> packet, std::vector<ControlMessage> &messages) const;
+  static std::string GetControlTypeName (ControlType type);
+
+private:
+  Protocol m_protocol;
+  RoutingScope m_scope;
+  InternetStackHelper m_internet;
+  OlsrHelper m_olsr;
+  AodvHelper m_aodv;
+  DsdvHelper m_dsdv;
+  DsrHelper m_dsr;
+  DsrMainHelper m_dsrMain;
+  ClusterRoutingHelper m_cluster;
+  OracleRoutingHelper m_oracle;
+  Ipv4StaticRoutingHelper m_static;
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_PROTOCOL_FACTORY_H */
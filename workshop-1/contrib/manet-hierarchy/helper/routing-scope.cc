@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "routing-scope.h"
+
+#include "ns3/abort.h"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace ns3 {
+
+static const char *g_kindNames[] = {"flat", "cluster", "upper"};
+
+RoutingScope::RoutingScope () {
+}
+
+RoutingScope RoutingScope::Parse (const std::string &policy) {
+  RoutingScope scope;
+  if (policy == "all") {
+    return scope;
+  }
+  if (policy == "flat") {
+    return Parse ("cluster:direct,upper:direct");
+  }
+  std::istringstream in (policy);
+  std::string item;
+  while (std::getline (in, item, ',')) {
+    std::string::size_type colon = item.find (':');
+    NS_ABORT_MSG_IF (colon == std::string::npos, "Bad routing scope rule '" << item << "', expected <channel>:<mode>");
+    std::string channel = item.substr (0, colon);
+    std::string mode = item.substr (colon + 1);
+
+    std::string::size_type digits = channel.find_first_of ("0123456789");
+    std::string name = channel.substr (0, digits);
+    uint32_t layer = digits == std::string::npos ? 0 : std::strtol (channel.substr (digits).c_str (), 0, 10);
+    int kind = -1;
+    for (int k = 0; k < 3; k++) {
+      if (name == g_kindNames[k]) {
+        kind = k;
+      }
+    }
+    NS_ABORT_MSG_IF (kind < 0, "Unknown channel '" << channel << "' in routing scope, expected flat|cluster|upper[<layer>]");
+    NS_ABORT_MSG_IF (mode != "olsr" && mode != "direct", "Unknown routing scope mode '" << mode << "', expected olsr|direct");
+    scope.AddRule (static_cast<HierarchyChannel::Kind> (kind), layer, mode == "olsr" ? OLSR : DIRECT);
+  }
+  return scope;
+}
+
+void RoutingScope::AddRule (HierarchyChannel::Kind kind, uint32_t layer, Mode mode) {
+  Rule rule;
+  rule.kind = kind;
+  rule.layer = layer;
+  rule.mode = mode;
+  m_rules.push_back (rule);
+}
+
+RoutingScope::Mode RoutingScope::GetMode (const HierarchyChannel &channel) const {
+  Mode mode = OLSR;
+  for (std::size_t i = 0; i < m_rules.size (); i++) {
+    if (m_rules[i].kind == channel.kind && (m_rules[i].layer == 0 || m_rules[i].layer == channel.layer)) {
+      mode = m_rules[i].mode;
+    }
+  }
+  return mode;
+}
+
+bool RoutingScope::IsAllOlsr (void) const {
+  for (std::size_t i = 0; i < m_rules.size (); i++) {
+    if (m_rules[i].mode != OLSR) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string RoutingScope::ToString (void) const {
+  if (m_rules.empty ()) {
+    return "all";
+  }
+  std::ostringstream out;
+  for (std::size_t i = 0; i < m_rules.size (); i++) {
+    out << (i > 0 ? "," : "") << g_kindNames[m_rules[i].kind];
+    if (m_rules[i].layer > 0) {
+      out << m_rules[i].layer;
+    }
+    out << ":" << (m_rules[i].mode == OLSR ? "olsr" : "direct");
+  }
+  return out.str ();
+}
+
+} // namespace ns3
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ROUTING_SCOPE_H
+#define ROUTING_SCOPE_H
+
+#include "hierarchy-topology-helper.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Which channels of the hierarchy OLSR runs on.
+ *
+ * A policy is a list of "<channel>:<mode>" rules, later rules overriding
+ * earlier ones. The channel is flat, cluster or upper, optionally followed
+ * by a layer number ("upper3", "cluster2"). In olsr mode the node's OLSR
+ * agent runs on the interface. In direct mode the interface is excluded from
+ * OLSR: it is served by a static routing instance that only knows its
+ * subnet, and OLSR advertises its address as a host association so the rest
+ * of the network still reaches it.
+ *
+ * "all" keeps OLSR everywhere, "flat" keeps it on layer 1 only.
+ */
+class RoutingScope {
+public:
+  enum Mode {
+    OLSR,
+    DIRECT
+  };
+
+  // OLSR on every channel.
+  RoutingScope ();
+
+  static RoutingScope Parse (const std::string &policy);
+
+  // Layer 0 applies to the channels of that kind on every layer.
+  void AddRule (HierarchyChannel::Kind kind, uint32_t layer, Mode mode);
+  Mode GetMode (const HierarchyChannel &channel) const;
+  // False if some channel may be out of OLSR.
+  bool IsAllOlsr (void) const;
+  std::string ToString (void) const;
+
+private:
+  struct Rule {
+    HierarchyChannel::Kind kind;
+    uint32_t layer;
+    Mode mode;
+  };
+
+  std::vector<Rule> m_rules;
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_SCOPE_H */
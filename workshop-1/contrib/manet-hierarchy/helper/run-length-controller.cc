@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "run-length-controller.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "replication-runner.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RunLengthController");
+
+RunLengthController::RunLengthController ()
+  : m_target (0.0),
+    m_minBatches (10),
+    m_batchSize (5)
+{
+}
+
+void RunLengthController::SetTarget (double relativeHalfWidth) {
+  m_target = relativeHalfWidth;
+}
+
+void RunLengthController::SetMinBatches (uint32_t batches) {
+  NS_ABORT_MSG_IF (batches < 2, "A confidence interval needs two batches");
+  m_minBatches = batches;
+}
+
+void RunLengthController::SetBatchSize (uint64_t samples) {
+  m_batchSize = samples;
+}
+
+uint32_t RunLengthController::AddMetric (const std::string &name) {
+  // A merge halves the batches, which must not take them below the minimum
+  Metric metric = {name, BatchMeans (2 * m_minBatches, m_batchSize)};
+  m_metrics.push_back (metric);
+  return m_metrics.size () - 1;
+}
+
+void RunLengthController::Add (uint32_t metric, double value) {
+  m_metrics[metric].batches.Add (value);
+}
+
+double RunLengthController::GetRelativeHalfWidth (const Metric &metric, double &mean, double &halfWidth) const {
+  WelfordAccumulator batches = metric.batches.GetBatchStatistics ();
+  mean = batches.GetMean ();
+  halfWidth = 0.0;
+  if (batches.GetCount () < m_minBatches) {
+    return -1.0;
+  }
+  halfWidth = ReplicationRunner::StudentT95 (batches.GetCount () - 1) * batches.GetStdDev ()
+    / std::sqrt (static_cast<double> (batches.GetCount ()));
+  if (mean == 0.0) {
+    return std::numeric_limits<double>::infinity ();
+  }
+  return halfWidth / std::fabs (mean);
+}
+
+void RunLengthController::Reset (void) {
+  for (std::size_t i = 0; i < m_metrics.size (); i++) {
+    m_metrics[i].batches = BatchMeans (2 * m_minBatches, m_batchSize);
+  }
+}
+
+bool RunLengthController::IsPrecise (void) const {
+  if (m_target <= 0 || m_metrics.empty ()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < m_metrics.size (); i++) {
+    double mean;
+    double halfWidth;
+    double relative = GetRelativeHalfWidth (m_metrics[i], mean, halfWidth);
+    if (relative < 0 || relative > m_target) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RunLengthController::Summarize (void) const {
+  for (std::size_t i = 0; i < m_metrics.size (); i++) {
+    const Metric &metric = m_metrics[i];
+    double mean;
+    double halfWidth;
+    double relative = GetRelativeHalfWidth (metric, mean, halfWidth);
+    if (relative < 0) {
+      NS_LOG_UNCOND ("Run length: " << metric.name << " has only " << metric.batches.GetNBatches ()
+                     << " batches, no confidence interval");
+      continue;
+    }
+    NS_LOG_UNCOND ("Run length: " << metric.name << " " << mean << " +- " << halfWidth << " (" << 100 * relative
+                   << "%) from " << metric.batches.GetNBatches () << " batches of " << metric.batches.GetBatchSize ()
+                   << " intervals");
+  }
+}
+
+} // namespace ns3
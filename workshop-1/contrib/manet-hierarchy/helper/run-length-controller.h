@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef RUN_LENGTH_CONTROLLER_H
+#define RUN_LENGTH_CONTROLLER_H
+
+#include "online-statistics.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Sequential stopping rule: every metric feeds one sample per interval into
+ * BatchMeans, and the run may stop once the 95% confidence half-width of
+ * every metric, relative to its mean, is below the target. Nothing is
+ * judged before MinBatches batches of at least the initial batch size.
+ */
+class RunLengthController {
+public:
+  RunLengthController ();
+
+  // Relative half-width to reach, 0 never stops.
+  void SetTarget (double relativeHalfWidth);
+  void SetMinBatches (uint32_t batches);
+  // Intervals per batch until the first merge.
+  void SetBatchSize (uint64_t samples);
+
+  // Returns the index Add takes; after the minimum and batch size are set.
+  uint32_t AddMetric (const std::string &name);
+  void Add (uint32_t metric, double value);
+  // Drops every sample, e.g. once a warm-up truncation point is known.
+  void Reset (void);
+
+  bool IsPrecise (void) const;
+  void Summarize (void) const;
+
+private:
+  struct Metric {
+    std::string name;
+    BatchMeans batches;
+  };
+
+  // Relative half-width, negative while there are too few batches.
+  double GetRelativeHalfWidth (const Metric &metric, double &mean, double &halfWidth) const;
+
+  double m_target;
+  uint32_t m_minBatches;
+  uint64_t m_batchSize;
+  std::vector<Metric> m_metrics;
+};
+
+} // namespace ns3
+
+#endif /* RUN_LENGTH_CONTROLLER_H */
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "scenario-benchmark.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScenarioBenchmark");
+
+ScenarioBenchmark::ScenarioBenchmark ()
+  : m_repetitions (1)
+{
+}
+
+void ScenarioBenchmark::AddCase (const std::string &name, const std::vector<std::string> &args) {
+  Case c;
+  c.name = name;
+  c.args = args;
+  m_cases.push_back (c);
+}
+
+void ScenarioBenchmark::SetRepetitions (uint32_t repetitions) {
+  m_repetitions = repetitions;
+}
+
+void ScenarioBenchmark::SetLog (const std::string &fileName) {
+  m_log = fileName;
+}
+
+const std::vector<ScenarioPreset> &ScenarioBenchmark::GetScenarioPresets (void) {
+  static const std::vector<ScenarioPreset> presets = {
+    {"scenario1-2l", "6x6", 31},
+    {"scenario2-2l", "9x4", 31},
+    {"scenario3-2l", "4x9", 31},
+    {"scenario1-3l", "4x6,2x2", 17},
+    {"scenario2-3l", "10x3,8x6", 17},
+    {"scenario3-3l", "8x6,3x4", 17}
+  };
+  return presets;
+}
+
+std::vector<char *> ScenarioBenchmark::MakeArgv (const std::string &program, const std::vector<std::string> &args) {
+  std::vector<char *> argv;
+  argv.push_back (strdup (program.c_str ()));
+  for (std::size_t i = 0; i < args.size (); i++) {
+    argv.push_back (strdup (args[i].c_str ()));
+  }
+  argv.push_back (0);
+  return argv;
+}
+
+static double TimevalSeconds (const struct timeval &tv) {
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+std::vector<BenchmarkResult> ScenarioBenchmark::Run (Job job) {
+  struct Report {
+    double wallSeconds;
+    FlowSummary flows;
+  };
+
+  std::vector<BenchmarkResult> results;
+  for (uint32_t r = 0; r < m_repetitions; r++) {
+    for (std::size_t c = 0; c < m_cases.size (); c++) {
+      NS_LOG_UNCOND ("Benchmark " << m_cases[c].name << ", repetition " << r);
+      std::cout.flush ();
+      int fds[2];
+      NS_ABORT_MSG_IF (pipe (fds) != 0, "Cannot create the pipe of " << m_cases[c].name);
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Cannot fork " << m_cases[c].name);
+      if (pid == 0) {
+        close (fds[0]);
+        if (!m_log.empty ()) {
+          int log = open (m_log.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+          NS_ABORT_MSG_IF (log < 0, "Cannot open " << m_log);
+          dup2 (log, STDOUT_FILENO);
+          dup2 (log, STDERR_FILENO);
+          close (log);
+        }
+        struct timespec start;
+        struct timespec end;
+        clock_gettime (CLOCK_MONOTONIC, &start);
+        Report report;
+        report.flows = job (m_cases[c].args);
+        clock_gettime (CLOCK_MONOTONIC, &end);
+        report.wallSeconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+        std::cout.flush ();
+        ssize_t written = write (fds[1], &report, sizeof (report));
+        close (fds[1]);
+        _exit (written == sizeof (report) ? 0 : 1);
+      }
+      close (fds[1]);
+
+      int status;
+      struct rusage usage;
+      pid_t waited = wait4 (pid, &status, 0, &usage);
+      Report report;
+      ssize_t got = read (fds[0], &report, sizeof (report));
+      close (fds[0]);
+      if (waited != pid || !WIFEXITED (status) || WEXITSTATUS (status) != 0 || got != sizeof (report)) {
+        NS_LOG_UNCOND ("Benchmark " << m_cases[c].name << " failed, leaving it out");
+        continue;
+      }
+
+      BenchmarkResult result;
+      result.name = m_cases[c].name;
+      result.repetition = r;
+      result.wallSeconds = report.wallSeconds;
+      result.cpuSeconds = TimevalSeconds (usage.ru_utime) + TimevalSeconds (usage.ru_stime);
+      result.maxRssKb = usage.ru_maxrss;
+      result.flows = report.flows;
+      results.push_back (result);
+    }
+  }
+  return results;
+}
+
+void ScenarioBenchmark::WriteCsv (const std::vector<BenchmarkResult> &results, const std::string &out) {
+  std::ofstream csv (out.c_str ());
+  NS_ABORT_MSG_IF (!csv, "Cannot open " << out);
+  csv << "Case,Repetition,WallSeconds,CpuSeconds,MaxRssKb,Events,ControlBytes,TxPackets,RxPackets,DeliveredKbps,UsPerTxPacket" << std::endl;
+
+  std::vector<std::string> order;
+  std::map<std::string, std::vector<double> > wall;
+  std::map<std::string, std::vector<double> > rss;
+  std::map<std::string, std::vector<double> > perPacket;
+  std::map<std::string, std::vector<double> > events;
+  std::map<std::string, std::vector<double> > control;
+  for (std::size_t i = 0; i < results.size (); i++) {
+    const BenchmarkResult &r = results[i];
+    double us = r.flows.txPackets > 0 ? r.wallSeconds * 1e6 / r.flows.txPackets : 0.0;
+    csv << r.name << "," << r.repetition << "," << r.wallSeconds << "," << r.cpuSeconds << ","
+        << r.maxRssKb << "," << r.flows.events << "," << r.flows.controlBytes << ","
+        << r.flows.txPackets << "," << r.flows.rxPackets << "," << r.flows.deliveredKbps << "," << us << std::endl;
+    if (wall.find (r.name) == wall.end ()) {
+      order.push_back (r.name);
+    }
+    wall[r.name].push_back (r.wallSeconds);
+    rss[r.name].push_back (r.maxRssKb);
+    perPacket[r.name].push_back (us);
+    events[r.name].push_back (r.flows.events);
+    control[r.name].push_back (r.flows.controlBytes);
+  }
+  csv.close ();
+
+  for (std::size_t i = 0; i < order.size (); i++) {
+    ReplicationEstimate w = ReplicationRunner::Estimate (wall[order[i]]);
+    ReplicationEstimate m = ReplicationRunner::Estimate (rss[order[i]]);
+    ReplicationEstimate p = ReplicationRunner::Estimate (perPacket[order[i]]);
+    ReplicationEstimate e = ReplicationRunner::Estimate (events[order[i]]);
+    ReplicationEstimate c = ReplicationRunner::Estimate (control[order[i]]);
+    NS_LOG_UNCOND (order[i] << ": wall " << w.mean << " +- " << w.ci95 << " s, peak RSS "
+                   << m.mean / 1024 << " MiB, " << p.mean << " us of wall clock per sent packet, "
+                   << e.mean << " events, " << c.mean << " control bytes (n=" << w.n << ")");
+  }
+}
+
+} // namespace ns3
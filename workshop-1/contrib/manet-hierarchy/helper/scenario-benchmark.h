@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SCENARIO_BENCHMARK_H
+#define SCENARIO_BENCHMARK_H
+
+#include "replication-runner.h"
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Shape and sender of one of the scenario programs.
+struct ScenarioPreset {
+  std::string name;
+  std::string layers;
+  uint32_t sender;
+};
+
+// Cost and outcome of one benchmark run.
+struct BenchmarkResult {
+  std::string name;
+  uint32_t repetition;
+  double wallSeconds;
+  double cpuSeconds;      // user + system of the child
+  uint64_t maxRssKb;      // peak resident set of the child
+  FlowSummary flows;
+};
+
+/*
+ * Times command-line variants of an experiment against each other. Every run
+ * is a fresh fork, one at a time so that runs do not compete for cores or
+ * memory bandwidth. The wall clock is taken around the job in the child and
+ * the CPU time and peak RSS come from wait4, so they cover only that run.
+ */
+class ScenarioBenchmark {
+public:
+  // Called in the child with the arguments of a case.
+  typedef std::function<FlowSummary (const std::vector<std::string> &args)> Job;
+
+  ScenarioBenchmark ();
+
+  void AddCase (const std::string &name, const std::vector<std::string> &args);
+  void SetRepetitions (uint32_t repetitions);
+  // Appends the stdout and stderr of every run to this file, so that their
+  // logging is paid for but stays off the terminal. Empty keeps them.
+  void SetLog (const std::string &fileName);
+
+  // Runs every case in turn, repetitions interleaved.
+  std::vector<BenchmarkResult> Run (Job job);
+
+  // One row per run, then prints the per-case means.
+  static void WriteCsv (const std::vector<BenchmarkResult> &results, const std::string &out);
+  // The six scratch/scenario* programs.
+  static const std::vector<ScenarioPreset> &GetScenarioPresets (void);
+  // argv-style copy of args behind a program name, for CommandLine::Parse.
+  static std::vector<char *> MakeArgv (const std::string &program, const std::vector<std::string> &args);
+
+private:
+  struct Case {
+    std::string name;
+    std::vector<std::string> args;
+  };
+
+  std::vector<Case> m_cases;
+  uint32_t m_repetitions;
+  std::string m_log;
+};
+
+} // namespace ns3
+
+#endif /* SCENARIO_BENCHMARK_H */
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "spatial-yans-wifi-helper.h"
+
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/spatial-yans-wifi-channel.h"
+
+namespace ns3 {
+
+SpatialYansWifiPhyHelper::SpatialYansWifiPhyHelper () {
+  m_phy.SetTypeId ("ns3::SpatialYansWifiPhy");
+}
+
+SpatialYansWifiChannelHelper::SpatialYansWifiChannelHelper ()
+  : m_culling (false)
+{
+  m_channel.SetTypeId ("ns3::SpatialYansWifiChannel");
+}
+
+void SpatialYansWifiChannelHelper::AddPropagationLoss (std::string name,
+                                                       std::string n0, const AttributeValue &v0,
+                                                       std::string n1, const AttributeValue &v1,
+                                                       std::string n2, const AttributeValue &v2) {
+  ObjectFactory factory;
+  factory.SetTypeId (name);
+  factory.Set (n0, v0);
+  factory.Set (n1, v1);
+  factory.Set (n2, v2);
+  m_propagationLoss.push_back (factory);
+}
+
+void SpatialYansWifiChannelHelper::SetPropagationDelay (std::string name,
+                                                        std::string n0, const AttributeValue &v0,
+                                                        std::string n1, const AttributeValue &v1) {
+  ObjectFactory factory;
+  factory.SetTypeId (name);
+  factory.Set (n0, v0);
+  factory.Set (n1, v1);
+  m_propagationDelay = factory;
+}
+
+void SpatialYansWifiChannelHelper::SetChannelAttribute (std::string name, const AttributeValue &value) {
+  m_channel.Set (name, value);
+}
+
+void SpatialYansWifiChannelHelper::SetCulling (bool culling) {
+  m_culling = culling;
+}
+
+Ptr<YansWifiChannel> SpatialYansWifiChannelHelper::Create (void) const {
+  Ptr<PropagationLossModel> loss;
+  return Create (loss);
+}
+
+Ptr<YansWifiChannel> SpatialYansWifiChannelHelper::Create (Ptr<PropagationLossModel> &loss) const {
+  Ptr<PropagationLossModel> first = 0;
+  Ptr<PropagationLossModel> prev = 0;
+  for (std::vector<ObjectFactory>::const_iterator i = m_propagationLoss.begin (); i != m_propagationLoss.end (); ++i) {
+    Ptr<PropagationLossModel> cur = (*i).Create<PropagationLossModel> ();
+    if (prev != 0) {
+      prev->SetNext (cur);
+    }
+    else {
+      first = cur;
+    }
+    prev = cur;
+  }
+  Ptr<PropagationDelayModel> delay = m_propagationDelay.Create<PropagationDelayModel> ();
+  loss = first;
+
+  if (m_culling) {
+    Ptr<SpatialYansWifiChannel> channel = m_channel.Create<SpatialYansWifiChannel> ();
+    channel->SetPropagationLossModel (first);
+    channel->SetPropagationDelayModel (delay);
+    return channel;
+  }
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (first);
+  channel->SetPropagationDelayModel (delay);
+  return channel;
+}
+
+} // namespace ns3
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SPATIAL_YANS_WIFI_HELPER_H
+#define SPATIAL_YANS_WIFI_HELPER_H
+
+#include "ns3/attribute.h"
+#include "ns3/object-factory.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-channel.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class PropagationLossModel;
+
+// YansWifiPhyHelper that creates SpatialYansWifiPhy instances.
+class SpatialYansWifiPhyHelper : public YansWifiPhyHelper {
+public:
+  SpatialYansWifiPhyHelper ();
+};
+
+/*
+ * Same configuration surface as YansWifiChannelHelper (which hard-codes the
+ * channel type), creating either a SpatialYansWifiChannel or a plain
+ * YansWifiChannel from the same loss and delay chain.
+ */
+class SpatialYansWifiChannelHelper {
+public:
+  SpatialYansWifiChannelHelper ();
+
+  void AddPropagationLoss (std::string name,
+                           std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                           std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                           std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+  void SetPropagationDelay (std::string name,
+                            std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                            std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue ());
+  void SetChannelAttribute (std::string name, const AttributeValue &value);
+  // Whether Create () returns a SpatialYansWifiChannel.
+  void SetCulling (bool culling);
+
+  Ptr<YansWifiChannel> Create (void) const;
+  // Also returns the first model of the loss chain.
+  Ptr<YansWifiChannel> Create (Ptr<PropagationLossModel> &loss) const;
+
+private:
+  std::vector<ObjectFactory> m_propagationLoss;
+  ObjectFactory m_propagationDelay;
+  ObjectFactory m_channel;
+  bool m_culling;
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_YANS_WIFI_HELPER_H */
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "traffic-monitor.h"
+
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TrafficMonitor");
+
+TrafficMonitor::Entity::Entity ()
+  : intervalRows (false),
+    bytes (0),
+    exportedBytes (0)
+{
+}
+
+TrafficMonitor::TrafficMonitor ()
+  : m_gap (Seconds (1.0)),
+    m_linkRate ("11Mbps")
+{
+}
+
+void TrafficMonitor::SetBusyGap (Time gap) {
+  m_gap = gap;
+}
+
+void TrafficMonitor::SetLinkRate (DataRate rate) {
+  m_linkRate = rate;
+}
+
+void TrafficMonitor::SetTopology (const HierarchyTopologyHelper &topology) {
+  const NodeContainer &nodes = topology.GetNodes ();
+  std::vector<uint32_t> cluster (NodeList::GetNNodes (), 0);
+  for (uint32_t i = 0; i < nodes.GetN (); i++) {
+    cluster[nodes.Get (i)->GetId ()] = topology.GetNodeCluster (i);
+  }
+  m_addressCluster.clear ();
+  for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+    const HierarchyChannel &channel = topology.GetChannel (c);
+    for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+      m_addressCluster[channel.interfaces.GetAddress (i)] = cluster[channel.nodes.Get (i)->GetId ()];
+    }
+  }
+  m_clusters.assign (topology.GetNClusters (), Entity ());
+  for (uint32_t c = 0; c < m_clusters.size (); c++) {
+    std::ostringstream name;
+    name << "cluster" << c;
+    m_clusters[c].name = name.str ();
+    m_clusters[c].intervalRows = true;
+  }
+  m_flows.clear ();
+  m_flowCluster.clear ();
+  m_lastExport = Simulator::Now ();
+}
+
+uint32_t TrafficMonitor::AddFlow (const std::string &name, Ipv4Address destination, bool intervalRows) {
+  Entity flow;
+  flow.name = name;
+  flow.intervalRows = intervalRows;
+  m_flows.push_back (flow);
+  std::map<Ipv4Address, uint32_t>::const_iterator cluster = m_addressCluster.find (destination);
+  m_flowCluster.push_back (cluster == m_addressCluster.end () ? -1 : static_cast<int32_t> (cluster->second));
+  return m_flows.size () - 1;
+}
+
+void TrafficMonitor::AddColumns (Ptr<MetricsSink> sink) {
+  sink->AddColumn ("SimulationSecond", MetricsSink::DOUBLE);
+  sink->AddColumn ("Span", MetricsSink::STRING);
+  sink->AddColumn ("Scope", MetricsSink::STRING);
+  sink->AddColumn ("Bytes", MetricsSink::INTEGER);
+  sink->AddColumn ("BusyTime", MetricsSink::DOUBLE);
+  sink->AddColumn ("TransferRate", MetricsSink::DOUBLE);
+  sink->AddColumn ("Proportion", MetricsSink::DOUBLE);
+  sink->AddColumn ("AverageTraffic", MetricsSink::DOUBLE);
+  sink->AddColumn ("TransferRateMean", MetricsSink::DOUBLE);
+  sink->AddColumn ("TransferRateStd", MetricsSink::DOUBLE);
+  sink->AddColumn ("ProportionMean", MetricsSink::DOUBLE);
+  sink->AddColumn ("ProportionStd", MetricsSink::DOUBLE);
+  sink->AddColumn ("AverageTrafficMean", MetricsSink::DOUBLE);
+  sink->AddColumn ("AverageTrafficStd", MetricsSink::DOUBLE);
+}
+
+void TrafficMonitor::SetSink (Ptr<MetricsSink> sink) {
+  m_sink = sink;
+}
+
+void TrafficMonitor::Arrival (Entity &entity, uint32_t bytes) {
+  entity.busy.Arrival (Simulator::Now (), m_gap, m_linkRate.CalculateBytesTxTime (bytes));
+  entity.bytes += bytes;
+}
+
+void TrafficMonitor::Record (uint32_t flow, uint32_t bytes) {
+  Arrival (m_flows[flow], bytes);
+  if (m_flowCluster[flow] >= 0) {
+    Arrival (m_clusters[m_flowCluster[flow]], bytes);
+  }
+}
+
+void TrafficMonitor::WriteRow (const std::string &span, const Entity &entity, uint64_t bytes, Time busy, Time elapsed) {
+  double kbit = bytes * 8.0 / 1000;
+  m_sink->BeginRow ();
+  m_sink->Add (Simulator::Now ().GetSeconds ());
+  m_sink->Add (span);
+  m_sink->Add (entity.name);
+  m_sink->Add (static_cast<int64_t> (bytes));
+  m_sink->Add (busy.GetSeconds ());
+  m_sink->Add (busy.IsStrictlyPositive () ? kbit / busy.GetSeconds () : 0.0);
+  m_sink->Add (elapsed.IsStrictlyPositive () ? busy.GetSeconds () / elapsed.GetSeconds () : 0.0);
+  m_sink->Add (elapsed.IsStrictlyPositive () ? kbit / elapsed.GetSeconds () : 0.0);
+  m_sink->Add (entity.rate.GetMean ());
+  m_sink->Add (entity.rate.GetStdDev ());
+  m_sink->Add (entity.proportion.GetMean ());
+  m_sink->Add (entity.proportion.GetStdDev ());
+  m_sink->Add (entity.traffic.GetMean ());
+  m_sink->Add (entity.traffic.GetStdDev ());
+  m_sink->EndRow ();
+}
+
+void TrafficMonitor::Export (void) {
+  Time elapsed = Simulator::Now () - m_lastExport;
+  if (!elapsed.IsStrictlyPositive ()) {
+    return;
+  }
+  m_lastExport = Simulator::Now ();
+  std::vector<Entity> *groups[2] = {&m_clusters, &m_flows};
+  for (uint32_t g = 0; g < 2; g++) {
+    for (std::size_t i = 0; i < groups[g]->size (); i++) {
+      Entity &entity = (*groups[g])[i];
+      // Nothing to average before the first reception
+      if (entity.busy.GetNPeriods () == 0) {
+        continue;
+      }
+      uint64_t bytes = entity.bytes - entity.exportedBytes;
+      Time busy = entity.busy.GetBusyTime () - entity.exportedBusy;
+      double kbit = bytes * 8.0 / 1000;
+      if (busy.IsStrictlyPositive ()) {
+        entity.rate.Add (kbit / busy.GetSeconds ());
+      }
+      entity.proportion.Add (busy.GetSeconds () / elapsed.GetSeconds ());
+      entity.traffic.Add (kbit / elapsed.GetSeconds ());
+      if (m_sink != 0 && entity.intervalRows) {
+        WriteRow ("interval", entity, bytes, busy, elapsed);
+      }
+      entity.exportedBytes = entity.bytes;
+      entity.exportedBusy = entity.busy.GetBusyTime ();
+    }
+  }
+}
+
+void TrafficMonitor::ExportRun (void) {
+  Export ();
+  if (m_sink == 0) {
+    return;
+  }
+  const std::vector<Entity> *groups[2] = {&m_clusters, &m_flows};
+  for (uint32_t g = 0; g < 2; g++) {
+    for (std::size_t i = 0; i < groups[g]->size (); i++) {
+      const Entity &entity = (*groups[g])[i];
+      // The service of the latest reception can run past now
+      Time elapsed;
+      if (entity.busy.GetNPeriods () > 0) {
+        elapsed = std::max (entity.busy.GetBusyTime (), Simulator::Now () - entity.busy.GetFirstArrival ());
+      }
+      WriteRow ("run", entity, entity.bytes, entity.busy.GetBusyTime (), elapsed);
+    }
+  }
+}
+
+void TrafficMonitor::Summarize (void) const {
+  for (std::size_t c = 0; c < m_clusters.size (); c++) {
+    const Entity &cluster = m_clusters[c];
+    if (cluster.bytes == 0) {
+      continue;
+    }
+    double busy = cluster.busy.GetBusyTime ().GetSeconds ();
+    double kbit = cluster.bytes * 8.0 / 1000;
+    double elapsed = std::max (busy, (Simulator::Now () - cluster.busy.GetFirstArrival ()).GetSeconds ());
+    NS_LOG_UNCOND ("Traffic into " << cluster.name << ": D " << (busy > 0 ? kbit / busy : 0.0) << " Kbps, A "
+                   << busy / elapsed << ", B " << kbit / elapsed << " Kbps over " << cluster.busy.GetNPeriods ()
+                   << " busy periods");
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TRAFFIC_MONITOR_H
+#define TRAFFIC_MONITOR_H
+
+#include "ns3/data-rate.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "hierarchy-topology-helper.h"
+#include "metrics-sink.h"
+#include "online-statistics.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * The traffic metrics of the stochastic model, kept online per flow and per
+ * cluster of the receiving node:
+ * - D, transfer rate: kbit received per second of busy time;
+ * - A, proportion: busy time over the time elapsed;
+ * - B, average traffic: A * D, i.e. kbit received per second elapsed.
+ * Busy time comes from a BusyPeriodTracker over the receptions, each busy
+ * for its transmission time at the link rate.
+ *
+ * Export takes D, A and B over the last interval and adds them to Welford
+ * accumulators, from the interval of the first reception on. The whole-run
+ * values count the time elapsed from the first reception. It writes a row for every cluster and for the flows that
+ * asked for interval rows. ExportRun writes the whole-run values of every
+ * flow and cluster, with the interval means and standard deviations.
+ */
+class TrafficMonitor {
+public:
+  TrafficMonitor ();
+
+  // Receptions closer than this belong to the same busy period.
+  void SetBusyGap (Time gap);
+  // Rate a reception is busy for its size at.
+  void SetLinkRate (DataRate rate);
+  // Cluster of every address; after the addresses are assigned.
+  void SetTopology (const HierarchyTopologyHelper &topology);
+  // Returns the index Record takes.
+  uint32_t AddFlow (const std::string &name, Ipv4Address destination, bool intervalRows);
+
+  static void AddColumns (Ptr<MetricsSink> sink);
+  void SetSink (Ptr<MetricsSink> sink);
+
+  void Record (uint32_t flow, uint32_t bytes);
+
+  void Export (void);
+  void ExportRun (void);
+  void Summarize (void) const;
+
+private:
+  struct Entity {
+    Entity ();
+
+    std::string name;
+    bool intervalRows;
+    BusyPeriodTracker busy;
+    uint64_t bytes;
+    uint64_t exportedBytes;
+    Time exportedBusy;
+    WelfordAccumulator rate;         // D, busy intervals only
+    WelfordAccumulator proportion;   // A
+    WelfordAccumulator traffic;      // B
+  };
+
+  void Arrival (Entity &entity, uint32_t bytes);
+  void WriteRow (const std::string &span, const Entity &entity, uint64_t bytes, Time busy, Time elapsed);
+
+  Ptr<MetricsSink> m_sink;
+  Time m_gap;
+  DataRate m_linkRate;
+  std::map<Ipv4Address, uint32_t> m_addressCluster;
+  std::vector<Entity> m_clusters;
+  std::vector<Entity> m_flows;
+  std::vector<int32_t> m_flowCluster;   // -1 for addresses outside the topology
+  Time m_lastExport;
+};
+
+} // namespace ns3
+
+#endif /* TRAFFIC_MONITOR_H */
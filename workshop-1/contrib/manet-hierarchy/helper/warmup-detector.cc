@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "warmup-detector.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WarmupDetector");
+
+static const uint32_t g_batchSize = 5;
+
+WarmupDetector::WarmupDetector ()
+  : m_minBatches (10)
+{
+}
+
+void WarmupDetector::SetMinBatches (uint32_t batches) {
+  NS_ABORT_MSG_IF (batches < 2, "MSER needs at least two batches");
+  m_minBatches = batches;
+}
+
+uint32_t WarmupDetector::AddSeries (const std::string &name) {
+  Series series;
+  series.name = name;
+  series.truncation = -1;
+  m_series.push_back (series);
+  return m_series.size () - 1;
+}
+
+void WarmupDetector::Add (uint32_t index, double time, double value) {
+  Series &series = m_series[index];
+  series.times.push_back (time);
+  series.values.push_back (value);
+  if (series.values.size () % g_batchSize != 0) {
+    return;
+  }
+  double sum = 0.0;
+  for (uint32_t i = series.values.size () - g_batchSize; i < series.values.size (); i++) {
+    sum += series.values[i];
+  }
+  series.batches.push_back (sum / g_batchSize);
+  Detect (series);
+}
+
+// Suffix sums give every candidate's statistic in one backward pass; only
+// the first half of the batches are candidates
+void WarmupDetector::Detect (Series &series) const {
+  uint32_t k = series.batches.size ();
+  series.truncation = -1;
+  if (k < m_minBatches) {
+    return;
+  }
+  double sum = 0.0;
+  double squares = 0.0;
+  double best = 0.0;
+  uint32_t bestD = k;
+  for (uint32_t d = k; d-- > 0;) {
+    double z = series.batches[d];
+    sum += z;
+    squares += z * z;
+    double n = k - d;
+    if (d > k / 2) {
+      continue;
+    }
+    double mser = std::max (0.0, squares - sum * sum / n) / (n * n);
+    if (bestD == k || mser <= best) {
+      best = mser;
+      bestD = d;
+    }
+  }
+  // Still falling at the last candidate: the warm-up may not be over
+  if (bestD < k / 2) {
+    series.truncation = bestD;
+  }
+}
+
+bool WarmupDetector::IsDetected (void) const {
+  if (m_series.empty ()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < m_series.size (); i++) {
+    if (m_series[i].truncation < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double WarmupDetector::GetTruncationTime (void) const {
+  double time = 0.0;
+  for (std::size_t i = 0; i < m_series.size (); i++) {
+    const Series &series = m_series[i];
+    if (series.truncation >= 0) {
+      time = std::max (time, series.times[series.truncation * g_batchSize]);
+    }
+  }
+  return time;
+}
+
+uint32_t WarmupDetector::GetNSeries (void) const {
+  return m_series.size ();
+}
+
+const std::vector<double> &WarmupDetector::GetTimes (uint32_t series) const {
+  return m_series.at (series).times;
+}
+
+const std::vector<double> &WarmupDetector::GetValues (uint32_t series) const {
+  return m_series.at (series).values;
+}
+
+void WarmupDetector::Summarize (void) const {
+  for (std::size_t i = 0; i < m_series.size (); i++) {
+    const Series &series = m_series[i];
+    if (series.truncation < 0) {
+      NS_LOG_UNCOND ("Warm-up detection: " << series.name << " not settled in " << series.batches.size () << " batches");
+      continue;
+    }
+    uint32_t first = series.truncation * g_batchSize;
+    double sum = 0.0;
+    for (uint32_t s = first; s < series.values.size (); s++) {
+      sum += series.values[s];
+    }
+    NS_LOG_UNCOND ("Warm-up detection: " << series.name << " truncated at " << series.times[first] << " s, mean "
+                   << sum / (series.values.size () - first) << " over the " << series.values.size () - first
+                   << " samples after it");
+  }
+}
+
+} // namespace ns3
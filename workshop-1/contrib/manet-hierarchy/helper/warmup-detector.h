@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef WARMUP_DETECTOR_H
+#define WARMUP_DETECTOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * MSER-5 warm-up detection over per-interval series. Every five samples
+ * make a batch; the truncation point is the number of leading batches d
+ * in the first half that minimizes the squared standard error of the
+ * remaining batch means, sum (Z_j - mean)^2 / (k - d)^2. It is only
+ * trusted once there are MinBatches batches and the minimum lies before
+ * the half-way mark.
+ *
+ * The samples are kept, so a later truncation point can be applied to the
+ * whole series again.
+ */
+class WarmupDetector {
+public:
+  WarmupDetector ();
+
+  void SetMinBatches (uint32_t batches);
+  // Returns the index Add takes.
+  uint32_t AddSeries (const std::string &name);
+  // Samples of a series must come in time order.
+  void Add (uint32_t series, double time, double value);
+
+  // True once every series has a trusted truncation point.
+  bool IsDetected (void) const;
+  // Latest truncation time over the series, when detected.
+  double GetTruncationTime (void) const;
+
+  uint32_t GetNSeries (void) const;
+  const std::vector<double> &GetTimes (uint32_t series) const;
+  const std::vector<double> &GetValues (uint32_t series) const;
+
+  void Summarize (void) const;
+
+private:
+  struct Series {
+    std::string name;
+    std::vector<double> times;
+    std::vector<double> values;
+    std::vector<double> batches;   // means of five samples
+    int64_t truncation;            // in batches, -1 while not trusted
+  };
+
+  void Detect (Series &series) const;
+
+  uint32_t m_minBatches;
+  std::vector<Series> m_series;
+};
+
+} // namespace ns3
+
+#endif /* WARMUP_DETECTOR_H */
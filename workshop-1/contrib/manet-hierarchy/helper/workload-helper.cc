@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "workload-helper.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/random-variable-stream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WorkloadHelper");
+
+static const char *g_patternNames[] = {"convergecast", "anytoany", "hotspot"};
+
+std::string WorkloadPattern::ToString (void) const {
+  std::ostringstream out;
+  out << g_patternNames[kind];
+  if (parameter > 0) {
+    out << parameter;
+  }
+  out << ":" << WorkloadApplication::GetArrivalName (arrival) << ":" << rate.GetBitRate () << "bps:" << packetSize;
+  return out.str ();
+}
+
+WorkloadHelper::WorkloadHelper () {
+}
+
+std::vector<WorkloadPattern> WorkloadHelper::Parse (const std::string &workload) {
+  std::vector<WorkloadPattern> patterns;
+  std::istringstream in (workload);
+  std::string item;
+  while (std::getline (in, item, ',')) {
+    std::vector<std::string> fields;
+    std::istringstream parts (item);
+    std::string field;
+    while (std::getline (parts, field, ':')) {
+      fields.push_back (field);
+    }
+    NS_ABORT_MSG_IF (fields.empty () || fields.size () > 4,
+                     "Bad workload entry '" << item << "', expected <pattern>[:<arrival>[:<rate>[:<packet size>]]]");
+
+    WorkloadPattern pattern;
+    std::string::size_type digits = fields[0].find_first_of ("0123456789");
+    std::string name = fields[0].substr (0, digits);
+    pattern.parameter = digits == std::string::npos ? 0 : std::strtol (fields[0].substr (digits).c_str (), 0, 10);
+    int kind = -1;
+    for (int k = 0; k < 3; k++) {
+      if (name == g_patternNames[k]) {
+        kind = k;
+      }
+    }
+    NS_ABORT_MSG_IF (kind < 0, "Unknown workload pattern '" << fields[0] << "', expected convergecast|anytoany[<flows>]|hotspot[<layer>]");
+    pattern.kind = static_cast<WorkloadPattern::Kind> (kind);
+    NS_ABORT_MSG_IF (pattern.kind == WorkloadPattern::CONVERGECAST && pattern.parameter > 0,
+                     "convergecast takes no number");
+    if (pattern.kind == WorkloadPattern::HOTSPOT && pattern.parameter == 0) {
+      pattern.parameter = 1;
+    }
+    pattern.arrival = fields.size () > 1 ? WorkloadApplication::ParseArrival (fields[1]) : WorkloadApplication::POISSON;
+    pattern.rate = DataRate (fields.size () > 2 ? fields[2] : "2048bps");
+    pattern.packetSize = fields.size () > 3 ? std::atoi (fields[3].c_str ()) : 64;
+    NS_ABORT_MSG_IF (pattern.packetSize == 0, "Bad packet size in workload entry '" << item << "'");
+    patterns.push_back (pattern);
+  }
+  return patterns;
+}
+
+void WorkloadHelper::SetPatterns (const std::vector<WorkloadPattern> &patterns) {
+  m_patterns = patterns;
+}
+
+ApplicationContainer WorkloadHelper::Install (const HierarchyTopologyHelper &topology, uint32_t nSinks) {
+  const NodeContainer &nodes = topology.GetNodes ();
+  const Ipv4InterfaceContainer &flat = topology.GetLayerInterfaces (1);
+  std::vector<uint32_t> index (NodeList::GetNNodes (), 0);
+  ApplicationContainer apps;
+  m_apps.clear ();
+  m_flows.clear ();
+  for (uint32_t i = 0; i < nodes.GetN (); i++) {
+    Ptr<WorkloadApplication> app = CreateObject<WorkloadApplication> ();
+    nodes.Get (i)->AddApplication (app);
+    app->TraceConnectWithoutContext ("Tx", MakeCallback (&WorkloadHelper::Tx, this));
+    app->TraceConnectWithoutContext ("Rx", MakeCallback (&WorkloadHelper::Rx, this));
+    m_apps.push_back (app);
+    apps.Add (app);
+    index[nodes.Get (i)->GetId ()] = i;
+  }
+
+  if (m_pick == 0) {
+    m_pick = CreateObject<UniformRandomVariable> ();
+  }
+  Ptr<UniformRandomVariable> pick = m_pick;
+  for (uint32_t p = 0; p < m_patterns.size (); p++) {
+    const WorkloadPattern &pattern = m_patterns[p];
+    switch (pattern.kind) {
+      case WorkloadPattern::CONVERGECAST:
+        for (uint32_t c = 0; c < topology.GetNChannels (); c++) {
+          const HierarchyChannel &channel = topology.GetChannel (c);
+          if (channel.kind != HierarchyChannel::CLUSTER) {
+            continue;
+          }
+          Ptr<Node> head = topology.GetClusterHead (channel.cluster);
+          Ipv4Address headAddress;
+          for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+            if (channel.nodes.Get (i) == head) {
+              headAddress = channel.interfaces.GetAddress (i);
+            }
+          }
+          for (uint32_t i = 0; i < channel.nodes.GetN (); i++) {
+            if (channel.nodes.Get (i) != head) {
+              AddFlow (p, index[channel.nodes.Get (i)->GetId ()], headAddress);
+            }
+          }
+        }
+        break;
+      case WorkloadPattern::ANY_TO_ANY:
+        {
+          NS_ABORT_MSG_IF (nodes.GetN () < 2, "any-to-any needs two nodes");
+          uint32_t flows = pattern.parameter > 0 ? pattern.parameter : nodes.GetN ();
+          for (uint32_t f = 0; f < flows; f++) {
+            uint32_t source = pick->GetInteger (0, nodes.GetN () - 1);
+            uint32_t destination = pick->GetInteger (0, nodes.GetN () - 2);
+            if (destination >= source) {
+              destination++;
+            }
+            AddFlow (p, source, flat.GetAddress (destination));
+          }
+        }
+        break;
+      case WorkloadPattern::HOTSPOT:
+        {
+          NS_ABORT_MSG_IF (pattern.parameter > topology.GetNLayers (),
+                           "No layer " << pattern.parameter << " for a hotspot in " << topology.GetNLayers () << " layers");
+          NS_ABORT_MSG_IF (nSinks == 0, "Hotspots need at least one sink");
+          const NodeContainer &layer = topology.GetLayerNodes (pattern.parameter);
+          const Ipv4InterfaceContainer &interfaces = topology.GetLayerInterfaces (pattern.parameter);
+          // Partial Fisher-Yates over the layer for the sinks
+          std::vector<uint32_t> order (layer.GetN ());
+          for (uint32_t i = 0; i < order.size (); i++) {
+            order[i] = i;
+          }
+          uint32_t sinks = std::min<uint32_t> (nSinks, layer.GetN ());
+          std::vector<bool> isSink (nodes.GetN (), false);
+          for (uint32_t s = 0; s < sinks; s++) {
+            std::swap (order[s], order[pick->GetInteger (s, order.size () - 1)]);
+            isSink[index[layer.Get (order[s])->GetId ()]] = true;
+          }
+          for (uint32_t i = 0; i < nodes.GetN (); i++) {
+            if (!isSink[i]) {
+              uint32_t sink = order[pick->GetInteger (0, sinks - 1)];
+              AddFlow (p, i, interfaces.GetAddress (sink));
+            }
+          }
+        }
+        break;
+    }
+  }
+  NS_LOG_UNCOND ("Workload: " << m_flows.size () << " flows on " << nodes.GetN () << " nodes");
+  return apps;
+}
+
+void WorkloadHelper::AddFlow (uint32_t pattern, uint32_t source, Ipv4Address destination) {
+  const WorkloadPattern &p = m_patterns[pattern];
+  m_apps[source]->AddFlow (m_flows.size (), destination, p.arrival, p.rate, p.packetSize);
+  FlowCounters counters;
+  counters.pattern = pattern;
+  counters.destination = destination;
+  counters.txPackets = 0;
+  counters.rxPackets = 0;
+  counters.rxBytes = 0;
+  m_flows.push_back (counters);
+}
+
+void WorkloadHelper::SetPickStream (int64_t stream) {
+  if (m_pick == 0) {
+    m_pick = CreateObject<UniformRandomVariable> ();
+  }
+  m_pick->SetStream (stream);
+}
+
+int64_t WorkloadHelper::AssignStreams (int64_t stream) {
+  int64_t start = stream;
+  for (std::size_t i = 0; i < m_apps.size (); i++) {
+    stream += m_apps[i]->AssignStreams (stream);
+  }
+  return stream - start;
+}
+
+uint32_t WorkloadHelper::GetNFlows (void) const {
+  return m_flows.size ();
+}
+
+Ipv4Address WorkloadHelper::GetFlowDestination (uint32_t flow) const {
+  return m_flows.at (flow).destination;
+}
+
+void WorkloadHelper::Tx (Ptr<const Packet> packet, uint32_t flow) {
+  m_flows[flow].txPackets++;
+}
+
+void WorkloadHelper::Rx (Ptr<const Packet> packet, uint32_t flow) {
+  m_flows[flow].rxPackets++;
+  m_flows[flow].rxBytes += packet->GetSize ();
+}
+
+void WorkloadHelper::Summarize (void) const {
+  for (uint32_t p = 0; p < m_patterns.size (); p++) {
+    uint32_t flows = 0;
+    uint64_t tx = 0;
+    uint64_t rx = 0;
+    uint64_t bytes = 0;
+    for (std::size_t f = 0; f < m_flows.size (); f++) {
+      if (m_flows[f].pattern == p) {
+        flows++;
+        tx += m_flows[f].txPackets;
+        rx += m_flows[f].rxPackets;
+        bytes += m_flows[f].rxBytes;
+      }
+    }
+    NS_LOG_UNCOND ("Workload " << m_patterns[p].ToString () << ": " << flows << " flows, " << tx << " packets sent, "
+                   << rx << " received (" << (tx > 0 ? 100.0 * rx / tx : 0.0) << "%), " << bytes << " bytes");
+  }
+}
+
+} // namespace ns3
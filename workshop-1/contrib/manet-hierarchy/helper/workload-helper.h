@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef WORKLOAD_HELPER_H
+#define WORKLOAD_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "hierarchy-topology-helper.h"
+#include "workload-application.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// One line of a workload: who sends to whom, and how.
+struct WorkloadPattern {
+  enum Kind {
+    CONVERGECAST,   // every cluster member to its head, on every tier
+    ANY_TO_ANY,     // random pairs of layer-1 nodes
+    HOTSPOT         // every layer-1 node to one of nSinks nodes of a layer
+  };
+
+  Kind kind;
+  uint32_t parameter;   // ANY_TO_ANY: flows, 0 for one per node; HOTSPOT: layer
+  WorkloadApplication::Arrival arrival;
+  DataRate rate;
+  uint32_t packetSize;
+
+  std::string ToString (void) const;
+};
+
+/*
+ * Installs a WorkloadApplication on every layer-1 node and the flows of a
+ * list of patterns on them, and counts what each flow sent and received.
+ *
+ * A workload is a list of "<pattern>[:<arrival>[:<rate>[:<packet size>]]]"
+ * entries, e.g. "convergecast:cbr:512bps,anytoany200:pareto:8kbps:512,
+ * hotspot2". Patterns are convergecast, anytoany[<flows>] and
+ * hotspot[<layer>]; arrivals are poisson (the default), pareto and cbr. Rate
+ * and packet size default to those of the measured flow, 2048bps and 64.
+ *
+ * Convergecast flows address the head on the cluster channel, hotspot flows
+ * the sink on its layer's channel and any-to-any flows layer 1.
+ */
+class WorkloadHelper {
+public:
+  WorkloadHelper ();
+
+  static std::vector<WorkloadPattern> Parse (const std::string &workload);
+
+  void SetPatterns (const std::vector<WorkloadPattern> &patterns);
+  // Pairs and hotspot sinks are drawn from an automatic stream unless
+  // SetPickStream came first.
+  ApplicationContainer Install (const HierarchyTopologyHelper &topology, uint32_t nSinks);
+  void SetPickStream (int64_t stream);
+  int64_t AssignStreams (int64_t stream);
+
+  uint32_t GetNFlows (void) const;
+  Ipv4Address GetFlowDestination (uint32_t flow) const;
+  // Prints flows, packets sent and received and the delivery ratio per pattern.
+  void Summarize (void) const;
+
+private:
+  struct FlowCounters {
+    uint32_t pattern;
+    Ipv4Address destination;
+    uint64_t txPackets;
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+  };
+
+  void AddFlow (uint32_t pattern, uint32_t source, Ipv4Address destination);
+  void Tx (Ptr<const Packet> packet, uint32_t flow);
+  void Rx (Ptr<const Packet> packet, uint32_t flow);
+
+  std::vector<WorkloadPattern> m_patterns;
+  std::vector<Ptr<WorkloadApplication> > m_apps;   // indexed like GetNodes ()
+  std::vector<FlowCounters> m_flows;               // by flow id
+  Ptr<UniformRandomVariable> m_pick;
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_HELPER_H */
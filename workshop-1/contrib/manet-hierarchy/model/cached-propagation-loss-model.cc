@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cached-propagation-loss-model.h"
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachedPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+TypeId CachedPropagationLossModel::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The distance-only loss model whose results are cached.",
+                   ObjectFactoryValue (ObjectFactory ("ns3::FriisPropagationLossModel")),
+                   MakeObjectFactoryAccessor (&CachedPropagationLossModel::m_model),
+                   MakeObjectFactoryChecker ())
+    .AddAttribute ("MaxErrorDb",
+                   "Largest error in dB against the uncached model.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_maxErrorDb),
+                   MakeDoubleChecker<double> (1e-9))
+    .AddAttribute ("PathLossExponent",
+                   "Path loss exponent of the model, used to size the buckets.",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&CachedPropagationLossModel::m_pathLossExponent),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel ()
+  : m_maxErrorDb (0.01),
+    m_pathLossExponent (2.0),
+    m_shift (-1),
+    m_centre (1.0),
+    m_lastTxPowerDbm (0.0),
+    m_lastTable (0),
+    m_hits (0),
+    m_misses (0),
+    m_probing (false),
+    m_probeHits (0),
+    m_probeMisses (0)
+{
+}
+
+CachedPropagationLossModel::~CachedPropagationLossModel () {
+}
+
+void CachedPropagationLossModel::DoDispose (void) {
+  m_inner = 0;
+  m_a = 0;
+  m_b = 0;
+  m_loss.clear ();
+  m_lastTable = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+uint64_t CachedPropagationLossModel::GetHits (void) const {
+  return m_hits;
+}
+
+uint64_t CachedPropagationLossModel::GetMisses (void) const {
+  return m_misses;
+}
+
+double CachedPropagationLossModel::GetHitRate (void) const {
+  uint64_t total = m_hits + m_misses;
+  return total == 0 ? 0.0 : static_cast<double> (m_hits) / total;
+}
+
+void CachedPropagationLossModel::SetProbing (bool probing) {
+  m_probing = probing;
+}
+
+uint64_t CachedPropagationLossModel::GetProbeHits (void) const {
+  return m_probeHits;
+}
+
+uint64_t CachedPropagationLossModel::GetProbeMisses (void) const {
+  return m_probeMisses;
+}
+
+void CachedPropagationLossModel::Configure (void) const {
+  m_inner = m_model.Create<PropagationLossModel> ();
+  m_a = CreateObject<ConstantPositionMobilityModel> ();
+  m_b = CreateObject<ConstantPositionMobilityModel> ();
+  m_a->SetPosition (Vector (0.0, 0.0, 0.0));
+
+  // A bucket keeping k mantissa bits spans a factor (1 + 2^-k) in d^2, so the
+  // loss at its centre is off by at most 2.5 * n * log10 (1 + 2^-k) dB.
+  int keep = 0;
+  while (keep < 52 && 2.5 * m_pathLossExponent * std::log10 (1.0 + std::ldexp (1.0, -keep)) > m_maxErrorDb) {
+    keep++;
+  }
+  m_shift = 52 - keep;
+  m_centre = std::sqrt (1.0 + std::ldexp (1.0, -keep));
+}
+
+double CachedPropagationLossModel::Lookup (double txPowerDbm, double distance2, uint64_t &hits, uint64_t &misses) const {
+  if (m_lastTable == 0 || txPowerDbm != m_lastTxPowerDbm) {
+    m_lastTable = &m_loss[txPowerDbm];
+    m_lastTxPowerDbm = txPowerDbm;
+  }
+  uint64_t bits;
+  std::memcpy (&bits, &distance2, sizeof (bits));
+  uint64_t key = bits >> m_shift;
+
+  std::unordered_map<uint64_t, double>::const_iterator it = m_lastTable->find (key);
+  if (it != m_lastTable->end ()) {
+    hits++;
+    return it->second;
+  }
+  misses++;
+
+  double centre2 = 0.0;
+  if (key != 0) {
+    uint64_t floorBits = key << m_shift;
+    double floor2;
+    std::memcpy (&floor2, &floorBits, sizeof (floor2));
+    centre2 = floor2 * m_centre;
+  }
+  m_b->SetPosition (Vector (std::sqrt (centre2), 0.0, 0.0));
+  double loss = txPowerDbm - m_inner->CalcRxPower (txPowerDbm, m_a, m_b);
+  (*m_lastTable)[key] = loss;
+  return loss;
+}
+
+double CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const {
+  if (m_shift < 0) {
+    Configure ();
+  }
+  Vector pa = a->GetPosition ();
+  Vector pb = b->GetPosition ();
+  double dx = pa.x - pb.x;
+  double dy = pa.y - pb.y;
+  double dz = pa.z - pb.z;
+  double distance2 = dx * dx + dy * dy + dz * dz;
+  if (m_probing) {
+    return txPowerDbm - Lookup (txPowerDbm, distance2, m_probeHits, m_probeMisses);
+  }
+  return txPowerDbm - Lookup (txPowerDbm, distance2, m_hits, m_misses);
+}
+
+int64_t CachedPropagationLossModel::DoAssignStreams (int64_t stream) {
+  if (m_shift < 0) {
+    Configure ();
+  }
+  return m_inner->AssignStreams (stream);
+}
+
+} // namespace ns3
@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/object-factory.h"
+
+#include <unordered_map>
+
+namespace ns3 {
+
+class ConstantPositionMobilityModel;
+
+/*
+ * Memoizes the loss of a distance-only model (Friis by default) per tx power
+ * and geometric distance bucket. Buckets are taken from the exponent and top
+ * mantissa bits of the squared distance, so a lookup needs neither a sqrt nor
+ * a log; their width follows from MaxErrorDb and PathLossExponent. The inner
+ * model is evaluated once per bucket, at its geometric centre, and its
+ * frequency is fixed per instance.
+ *
+ * Hits and misses count receptions only: range probes and verification
+ * re-runs mark themselves with SetProbing and go to the probe counters.
+ */
+class CachedPropagationLossModel : public PropagationLossModel {
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationLossModel ();
+  virtual ~CachedPropagationLossModel ();
+
+  uint64_t GetHits (void) const;
+  uint64_t GetMisses (void) const;
+  double GetHitRate (void) const;
+
+  // While set, lookups count as probes rather than receptions.
+  void SetProbing (bool probing);
+  uint64_t GetProbeHits (void) const;
+  uint64_t GetProbeMisses (void) const;
+
+private:
+  double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+  int64_t DoAssignStreams (int64_t stream) override;
+  void DoDispose (void) override;
+
+  void Configure (void) const;
+  double Lookup (double txPowerDbm, double distance2, uint64_t &hits, uint64_t &misses) const;
+
+  ObjectFactory m_model;
+  double m_maxErrorDb;
+  double m_pathLossExponent;
+
+  mutable Ptr<PropagationLossModel> m_inner;
+  mutable Ptr<ConstantPositionMobilityModel> m_a;
+  mutable Ptr<ConstantPositionMobilityModel> m_b;
+  mutable int m_shift;          // mantissa bits dropped from the bucket key
+  mutable double m_centre;      // bucket centre over bucket floor, in d^2
+  mutable std::unordered_map<double, std::unordered_map<uint64_t, double> > m_loss;
+  mutable double m_lastTxPowerDbm;
+  mutable std::unordered_map<uint64_t, double> *m_lastTable;
+  mutable uint64_t m_hits;
+  mutable uint64_t m_misses;
+  bool m_probing;
+  mutable uint64_t m_probeHits;
+  mutable uint64_t m_probeMisses;
+};
+
+} // namespace ns3
+
+#endif /* CACHED_PROPAGATION_LOSS_MODEL_H */
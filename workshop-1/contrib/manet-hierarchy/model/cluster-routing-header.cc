@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cluster-routing-header.h"
+
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (ClusterRoutingHeader);
+
+TypeId ClusterRoutingHeader::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::ClusterRoutingHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<ClusterRoutingHeader> ()
+  ;
+  return tid;
+}
+
+TypeId ClusterRoutingHeader::GetInstanceTypeId (void) const {
+  return GetTypeId ();
+}
+
+ClusterRoutingHeader::ClusterRoutingHeader ()
+  : m_type (HELLO),
+    m_cluster (0)
+{
+}
+
+void ClusterRoutingHeader::SetType (MessageType type) {
+  m_type = type;
+}
+
+ClusterRoutingHeader::MessageType ClusterRoutingHeader::GetType (void) const {
+  return static_cast<MessageType> (m_type);
+}
+
+void ClusterRoutingHeader::SetCluster (uint32_t cluster) {
+  m_cluster = cluster;
+}
+
+uint32_t ClusterRoutingHeader::GetCluster (void) const {
+  return m_cluster;
+}
+
+std::vector<ClusterRoutingHeader::Member> &ClusterRoutingHeader::GetMembers (void) {
+  return m_members;
+}
+
+const std::vector<ClusterRoutingHeader::Member> &ClusterRoutingHeader::GetMembers (void) const {
+  return m_members;
+}
+
+std::vector<ClusterRoutingHeader::Cluster> &ClusterRoutingHeader::GetClusters (void) {
+  return m_clusters;
+}
+
+const std::vector<ClusterRoutingHeader::Cluster> &ClusterRoutingHeader::GetClusters (void) const {
+  return m_clusters;
+}
+
+// type, cluster, entry count; then per member main, hops, flags, address
+// count and addresses, or per cluster id, hops, range count and ranges
+uint32_t ClusterRoutingHeader::GetSerializedSize (void) const {
+  uint32_t size = 1 + 4 + 2;
+  for (std::size_t i = 0; i < m_members.size (); i++) {
+    size += 4 + 1 + 1 + 1 + 4 * m_members[i].addresses.size ();
+  }
+  for (std::size_t i = 0; i < m_clusters.size (); i++) {
+    size += 4 + 1 + 1 + 8 * m_clusters[i].ranges.size ();
+  }
+  return size;
+}
+
+void ClusterRoutingHeader::Serialize (Buffer::Iterator start) const {
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_type);
+  i.WriteHtonU32 (m_cluster);
+  if (m_type == HELLO) {
+    i.WriteHtonU16 (m_members.size ());
+    for (std::size_t m = 0; m < m_members.size (); m++) {
+      const Member &member = m_members[m];
+      i.WriteHtonU32 (member.main.Get ());
+      i.WriteU8 (member.hops);
+      i.WriteU8 (member.head ? 1 : 0);
+      i.WriteU8 (member.addresses.size ());
+      for (std::size_t a = 0; a < member.addresses.size (); a++) {
+        i.WriteHtonU32 (member.addresses[a].Get ());
+      }
+    }
+  }
+  else {
+    i.WriteHtonU16 (m_clusters.size ());
+    for (std::size_t c = 0; c < m_clusters.size (); c++) {
+      const Cluster &cluster = m_clusters[c];
+      i.WriteHtonU32 (cluster.cluster);
+      i.WriteU8 (cluster.hops);
+      i.WriteU8 (cluster.ranges.size ());
+      for (std::size_t r = 0; r < cluster.ranges.size (); r++) {
+        i.WriteHtonU32 (cluster.ranges[r].first.Get ());
+        i.WriteHtonU32 (cluster.ranges[r].last.Get ());
+      }
+    }
+  }
+}
+
+uint32_t ClusterRoutingHeader::Deserialize (Buffer::Iterator start) {
+  Buffer::Iterator i = start;
+  m_type = i.ReadU8 ();
+  m_cluster = i.ReadNtohU32 ();
+  uint16_t n = i.ReadNtohU16 ();
+  m_members.clear ();
+  m_clusters.clear ();
+  if (m_type == HELLO) {
+    m_members.resize (n);
+    for (uint16_t m = 0; m < n; m++) {
+      Member &member = m_members[m];
+      member.main = Ipv4Address (i.ReadNtohU32 ());
+      member.hops = i.ReadU8 ();
+      member.head = i.ReadU8 () != 0;
+      member.addresses.resize (i.ReadU8 ());
+      for (std::size_t a = 0; a < member.addresses.size (); a++) {
+        member.addresses[a] = Ipv4Address (i.ReadNtohU32 ());
+      }
+    }
+  }
+  else {
+    NS_ABORT_MSG_IF (m_type != SUMMARY, "Unknown cluster routing message " << static_cast<uint32_t> (m_type));
+    m_clusters.resize (n);
+    for (uint16_t c = 0; c < n; c++) {
+      Cluster &cluster = m_clusters[c];
+      cluster.cluster = i.ReadNtohU32 ();
+      cluster.hops = i.ReadU8 ();
+      cluster.ranges.resize (i.ReadU8 ());
+      for (std::size_t r = 0; r < cluster.ranges.size (); r++) {
+        cluster.ranges[r].first = Ipv4Address (i.ReadNtohU32 ());
+        cluster.ranges[r].last = Ipv4Address (i.ReadNtohU32 ());
+      }
+    }
+  }
+  return i.GetDistanceFrom (start);
+}
+
+void ClusterRoutingHeader::Print (std::ostream &os) const {
+  os << (m_type == HELLO ? "HELLO" : "SUMMARY") << " cluster " << m_cluster;
+  for (std::size_t m = 0; m < m_members.size (); m++) {
+    os << " " << m_members[m].main << "/" << static_cast<uint32_t> (m_members[m].hops)
+       << (m_members[m].head ? "*" : "");
+  }
+  for (std::size_t c = 0; c < m_clusters.size (); c++) {
+    os << " c" << m_clusters[c].cluster << "/" << static_cast<uint32_t> (m_clusters[c].hops);
+  }
+}
+
+} // namespace ns3
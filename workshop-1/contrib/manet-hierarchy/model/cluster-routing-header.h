@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CLUSTER_ROUTING_HEADER_H
+#define CLUSTER_ROUTING_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/ipv4-address.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Control message of ClusterRoutingProtocol.
+ *
+ * HELLO goes out on the cluster channel only and carries the sender's
+ * distance vector over the members of its cluster, each with all of its
+ * interface addresses. SUMMARY goes out between cluster heads and carries
+ * one entry per cluster: the address ranges its members cover and the
+ * distance to its head in head-to-head hops.
+ */
+class ClusterRoutingHeader : public Header {
+public:
+  enum MessageType {
+    HELLO = 1,
+    SUMMARY = 2
+  };
+
+  struct Member {
+    Ipv4Address main;              // address on the cluster channel
+    uint8_t hops;
+    bool head;
+    std::vector<Ipv4Address> addresses;
+  };
+
+  struct Range {
+    Ipv4Address first;
+    Ipv4Address last;
+  };
+
+  struct Cluster {
+    uint32_t cluster;
+    uint8_t hops;
+    std::vector<Range> ranges;
+  };
+
+  static TypeId GetTypeId (void);
+  TypeId GetInstanceTypeId (void) const override;
+
+  ClusterRoutingHeader ();
+
+  void SetType (MessageType type);
+  MessageType GetType (void) const;
+  void SetCluster (uint32_t cluster);
+  uint32_t GetCluster (void) const;
+
+  std::vector<Member> &GetMembers (void);
+  const std::vector<Member> &GetMembers (void) const;
+  std::vector<Cluster> &GetClusters (void);
+  const std::vector<Cluster> &GetClusters (void) const;
+
+  uint32_t GetSerializedSize (void) const override;
+  void Serialize (Buffer::Iterator start) const override;
+  uint32_t Deserialize (Buffer::Iterator start) override;
+  void Print (std::ostream &os) const override;
+
+private:
+  uint8_t m_type;
+  uint32_t m_cluster;              // of the sender
+  std::vector<Member> m_members;
+  std::vector<Cluster> m_clusters;
+};
+
+} // namespace ns3
+
+#endif /* CLUSTER_ROUTING_HEADER_H */
@@ -0,0 +1,457 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "cluster-routing-protocol.h"
+
+#include "ns3/abort.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/udp-socket-factory.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ClusterRoutingProtocol");
+
+NS_OBJECT_ENSURE_REGISTERED (ClusterRoutingProtocol);
+
+TypeId ClusterRoutingProtocol::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::ClusterRoutingProtocol")
+    .SetParent<NextHopRoutingProtocol> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<ClusterRoutingProtocol> ()
+    .AddAttribute ("HelloInterval",
+                   "Interval between HELLOs on the cluster channel.",
+                   TimeValue (Seconds (2.0)),
+                   MakeTimeAccessor (&ClusterRoutingProtocol::m_helloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("SummaryInterval",
+                   "Interval between cluster summaries of a head.",
+                   TimeValue (Seconds (5.0)),
+                   MakeTimeAccessor (&ClusterRoutingProtocol::m_summaryInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("HoldFactor",
+                   "Intervals an entry is kept without being refreshed.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&ClusterRoutingProtocol::m_holdFactor),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxHops",
+                   "Distance at which a member or cluster counts as unreachable.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&ClusterRoutingProtocol::m_maxHops),
+                   MakeUintegerChecker<uint8_t> (1))
+    .AddAttribute ("MaxEntries",
+                   "Members or clusters per message; longer vectors are split.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&ClusterRoutingProtocol::m_maxEntries),
+                   MakeUintegerChecker<uint32_t> (1, 65535))
+  ;
+  return tid;
+}
+
+ClusterRoutingProtocol::ClusterRoutingProtocol ()
+  : m_holdFactor (3),
+    m_maxHops (16),
+    m_maxEntries (64),
+    m_configured (false),
+    m_cluster (0),
+    m_head (false),
+    m_clusterInterface (0),
+    m_indexDirty (false)
+{
+  m_jitter = CreateObject<UniformRandomVariable> ();
+}
+
+ClusterRoutingProtocol::~ClusterRoutingProtocol () {
+}
+
+void ClusterRoutingProtocol::SetCluster (uint32_t cluster, bool head, Ptr<NetDevice> clusterDevice) {
+  m_configured = true;
+  m_cluster = cluster;
+  m_head = head;
+  m_clusterDevice = clusterDevice;
+}
+
+void ClusterRoutingProtocol::AddBackboneDevice (Ptr<NetDevice> device) {
+  m_backboneDevices.push_back (device);
+}
+
+int64_t ClusterRoutingProtocol::AssignStreams (int64_t stream) {
+  m_jitter->SetStream (stream);
+  return 1;
+}
+
+uint32_t ClusterRoutingProtocol::GetNMembers (void) const {
+  return m_members.size ();
+}
+
+uint32_t ClusterRoutingProtocol::GetNClusters (void) const {
+  return m_clusters.size ();
+}
+
+void ClusterRoutingProtocol::DoInitialize (void) {
+  if (m_configured) {
+    int32_t interface = m_ipv4->GetInterfaceForDevice (m_clusterDevice);
+    NS_ABORT_MSG_IF (interface < 0, "Cluster device has no Ipv4 interface");
+    m_clusterInterface = interface;
+    m_main = m_ipv4->GetAddress (m_clusterInterface, 0).GetLocal ();
+    OpenSocket (m_clusterInterface);
+    if (m_head) {
+      m_headMain = m_main;
+      for (std::size_t i = 0; i < m_backboneDevices.size (); i++) {
+        interface = m_ipv4->GetInterfaceForDevice (m_backboneDevices[i]);
+        NS_ABORT_MSG_IF (interface < 0, "Backbone device has no Ipv4 interface");
+        m_backboneInterfaces.push_back (interface);
+        OpenSocket (interface);
+      }
+      m_summaryEvent = Simulator::Schedule (Seconds (m_jitter->GetValue (0.0, m_summaryInterval.GetSeconds ())),
+                                            &ClusterRoutingProtocol::SendSummary, this);
+    }
+    m_helloEvent = Simulator::Schedule (Seconds (m_jitter->GetValue (0.0, m_helloInterval.GetSeconds ())),
+                                        &ClusterRoutingProtocol::SendHello, this);
+  }
+  NextHopRoutingProtocol::DoInitialize ();
+}
+
+void ClusterRoutingProtocol::DoDispose (void) {
+  m_helloEvent.Cancel ();
+  m_summaryEvent.Cancel ();
+  for (std::map<uint32_t, Ptr<Socket> >::iterator it = m_sockets.begin (); it != m_sockets.end (); ++it) {
+    it->second->Close ();
+  }
+  m_sockets.clear ();
+  for (std::size_t i = 0; i < m_broadcastSockets.size (); i++) {
+    m_broadcastSockets[i]->Close ();
+  }
+  m_broadcastSockets.clear ();
+  m_clusterDevice = 0;
+  m_backboneDevices.clear ();
+  m_members.clear ();
+  m_clusters.clear ();
+  NextHopRoutingProtocol::DoDispose ();
+}
+
+// Sends from the interface address and receives the subnet broadcasts on a
+// second socket, as a socket bound to a unicast address does not see them
+Ptr<Socket> ClusterRoutingProtocol::OpenSocket (uint32_t interface) {
+  Ptr<Node> node = m_ipv4->GetObject<Node> ();
+  Ipv4InterfaceAddress address = m_ipv4->GetAddress (interface, 0);
+  Ptr<NetDevice> device = m_ipv4->GetNetDevice (interface);
+
+  Ptr<Socket> socket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  socket->SetAllowBroadcast (true);
+  socket->SetRecvCallback (MakeCallback (&ClusterRoutingProtocol::Receive, this));
+  socket->Bind (InetSocketAddress (address.GetLocal (), PORT));
+  socket->BindToNetDevice (device);
+  m_sockets[interface] = socket;
+
+  Ptr<Socket> broadcast = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+  broadcast->SetRecvCallback (MakeCallback (&ClusterRoutingProtocol::Receive, this));
+  broadcast->Bind (InetSocketAddress (address.GetBroadcast (), PORT));
+  broadcast->BindToNetDevice (device);
+  m_broadcastSockets.push_back (broadcast);
+  return socket;
+}
+
+Time ClusterRoutingProtocol::Jitter (Time interval) {
+  return Seconds (interval.GetSeconds () * m_jitter->GetValue (0.9, 1.0));
+}
+
+void ClusterRoutingProtocol::Broadcast (Ptr<Socket> socket, uint32_t interface, const ClusterRoutingHeader &header) {
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  Ipv4Address broadcast = m_ipv4->GetAddress (interface, 0).GetBroadcast ();
+  socket->SendTo (packet, 0, InetSocketAddress (broadcast, PORT));
+}
+
+void ClusterRoutingProtocol::SendHello (void) {
+  Purge ();
+
+  std::vector<ClusterRoutingHeader::Member> vector;
+  ClusterRoutingHeader::Member self;
+  self.main = m_main;
+  self.hops = 0;
+  self.head = m_head;
+  for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); i++) {
+    for (uint32_t j = 0; j < m_ipv4->GetNAddresses (i); j++) {
+      self.addresses.push_back (m_ipv4->GetAddress (i, j).GetLocal ());
+    }
+  }
+  vector.push_back (self);
+  for (std::map<Ipv4Address, MemberRoute>::const_iterator it = m_members.begin (); it != m_members.end (); ++it) {
+    ClusterRoutingHeader::Member member;
+    member.main = it->first;
+    member.hops = it->second.hops;
+    member.head = it->second.head;
+    member.addresses = it->second.addresses;
+    vector.push_back (member);
+  }
+
+  Ptr<Socket> socket = m_sockets[m_clusterInterface];
+  for (std::size_t first = 0; first < vector.size (); first += m_maxEntries) {
+    ClusterRoutingHeader header;
+    header.SetType (ClusterRoutingHeader::HELLO);
+    header.SetCluster (m_cluster);
+    std::size_t last = std::min (vector.size (), first + m_maxEntries);
+    header.GetMembers ().assign (vector.begin () + first, vector.begin () + last);
+    Broadcast (socket, m_clusterInterface, header);
+  }
+  m_helloEvent = Simulator::Schedule (Jitter (m_helloInterval), &ClusterRoutingProtocol::SendHello, this);
+}
+
+std::vector<ClusterRoutingHeader::Range> ClusterRoutingProtocol::GetOwnRanges (void) const {
+  std::vector<uint32_t> addresses;
+  for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); i++) {
+    for (uint32_t j = 0; j < m_ipv4->GetNAddresses (i); j++) {
+      addresses.push_back (m_ipv4->GetAddress (i, j).GetLocal ().Get ());
+    }
+  }
+  for (std::map<Ipv4Address, MemberRoute>::const_iterator it = m_members.begin (); it != m_members.end (); ++it) {
+    for (std::size_t a = 0; a < it->second.addresses.size (); a++) {
+      addresses.push_back (it->second.addresses[a].Get ());
+    }
+  }
+  std::sort (addresses.begin (), addresses.end ());
+
+  // Members are numbered consecutively on each subnet, so runs are long
+  std::vector<ClusterRoutingHeader::Range> ranges;
+  for (std::size_t i = 0; i < addresses.size (); i++) {
+    if (!ranges.empty () && addresses[i] <= ranges.back ().last.Get () + 1) {
+      ranges.back ().last = Ipv4Address (std::max (addresses[i], ranges.back ().last.Get ()));
+    }
+    else {
+      // The summary counts ranges in one byte
+      NS_ABORT_MSG_IF (ranges.size () == 255, "Cluster " << m_cluster << " spans more than 255 address ranges");
+      ClusterRoutingHeader::Range range;
+      range.first = Ipv4Address (addresses[i]);
+      range.last = range.first;
+      ranges.push_back (range);
+    }
+  }
+  return ranges;
+}
+
+void ClusterRoutingProtocol::SendSummary (void) {
+  Purge ();
+
+  std::vector<ClusterRoutingHeader::Cluster> vector;
+  ClusterRoutingHeader::Cluster own;
+  own.cluster = m_cluster;
+  own.hops = 0;
+  own.ranges = GetOwnRanges ();
+  vector.push_back (own);
+  for (std::map<uint32_t, ClusterRoute>::const_iterator it = m_clusters.begin (); it != m_clusters.end (); ++it) {
+    ClusterRoutingHeader::Cluster cluster;
+    cluster.cluster = it->first;
+    cluster.hops = it->second.hops;
+    cluster.ranges = it->second.ranges;
+    vector.push_back (cluster);
+  }
+
+  for (std::size_t i = 0; i < m_backboneInterfaces.size (); i++) {
+    uint32_t interface = m_backboneInterfaces[i];
+    for (std::size_t first = 0; first < vector.size (); first += m_maxEntries) {
+      ClusterRoutingHeader header;
+      header.SetType (ClusterRoutingHeader::SUMMARY);
+      header.SetCluster (m_cluster);
+      std::size_t last = std::min (vector.size (), first + m_maxEntries);
+      header.GetClusters ().assign (vector.begin () + first, vector.begin () + last);
+      Broadcast (m_sockets[interface], interface, header);
+    }
+  }
+  m_summaryEvent = Simulator::Schedule (Jitter (m_summaryInterval), &ClusterRoutingProtocol::SendSummary, this);
+}
+
+void ClusterRoutingProtocol::Receive (Ptr<Socket> socket) {
+  Address from;
+  Ptr<Packet> packet;
+  while ((packet = socket->RecvFrom (from))) {
+    Ipv4Address sender = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
+    if (IsOwnAddress (sender)) {
+      continue;
+    }
+    int32_t interface = m_ipv4->GetInterfaceForDevice (socket->GetBoundNetDevice ());
+    ClusterRoutingHeader header;
+    packet->RemoveHeader (header);
+    if (header.GetType () == ClusterRoutingHeader::HELLO) {
+      if (static_cast<uint32_t> (interface) == m_clusterInterface && header.GetCluster () == m_cluster) {
+        ReceiveHello (header, sender);
+      }
+    }
+    else if (header.GetType () == ClusterRoutingHeader::SUMMARY && m_head) {
+      ReceiveSummary (header, sender, interface);
+    }
+  }
+}
+
+void ClusterRoutingProtocol::ReceiveHello (const ClusterRoutingHeader &header, Ipv4Address sender) {
+  Time expires = Simulator::Now () + Seconds (m_helloInterval.GetSeconds () * m_holdFactor);
+  const std::vector<ClusterRoutingHeader::Member> &members = header.GetMembers ();
+  for (std::size_t i = 0; i < members.size (); i++) {
+    const ClusterRoutingHeader::Member &member = members[i];
+    if (member.main == m_main || member.hops >= m_maxHops) {
+      continue;
+    }
+    uint8_t hops = member.hops + 1;
+    std::map<Ipv4Address, MemberRoute>::iterator it = m_members.find (member.main);
+    if (it == m_members.end ()) {
+      MemberRoute route;
+      route.nextHop = sender;
+      route.hops = hops;
+      route.head = member.head;
+      route.addresses = member.addresses;
+      route.expires = expires;
+      m_members[member.main] = route;
+      m_indexDirty = true;
+    }
+    else if (hops < it->second.hops || it->second.nextHop == sender) {
+      // A shorter path, or news from the hop in use, which may be worse
+      MemberRoute &route = it->second;
+      m_indexDirty = m_indexDirty || route.addresses != member.addresses || route.head != member.head;
+      route.nextHop = sender;
+      route.hops = hops;
+      route.head = member.head;
+      route.addresses = member.addresses;
+      route.expires = expires;
+    }
+  }
+}
+
+void ClusterRoutingProtocol::ReceiveSummary (const ClusterRoutingHeader &header, Ipv4Address sender, uint32_t interface) {
+  Time expires = Simulator::Now () + Seconds (m_summaryInterval.GetSeconds () * m_holdFactor);
+  const std::vector<ClusterRoutingHeader::Cluster> &clusters = header.GetClusters ();
+  for (std::size_t i = 0; i < clusters.size (); i++) {
+    const ClusterRoutingHeader::Cluster &cluster = clusters[i];
+    if (cluster.cluster == m_cluster || cluster.hops >= m_maxHops) {
+      continue;
+    }
+    uint8_t hops = cluster.hops + 1;
+    std::map<uint32_t, ClusterRoute>::iterator it = m_clusters.find (cluster.cluster);
+    if (it == m_clusters.end () || hops < it->second.hops || it->second.nextHop == sender) {
+      ClusterRoute &route = m_clusters[cluster.cluster];
+      route.nextHop = sender;
+      route.interface = interface;
+      route.hops = hops;
+      route.ranges = cluster.ranges;
+      route.expires = expires;
+      m_indexDirty = true;
+    }
+  }
+}
+
+void ClusterRoutingProtocol::Purge (void) {
+  Time now = Simulator::Now ();
+  for (std::map<Ipv4Address, MemberRoute>::iterator it = m_members.begin (); it != m_members.end (); ) {
+    if (it->second.expires < now) {
+      m_members.erase (it++);
+      m_indexDirty = true;
+    }
+    else {
+      ++it;
+    }
+  }
+  for (std::map<uint32_t, ClusterRoute>::iterator it = m_clusters.begin (); it != m_clusters.end (); ) {
+    if (it->second.expires < now) {
+      m_clusters.erase (it++);
+      m_indexDirty = true;
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+void ClusterRoutingProtocol::RebuildIndex (void) {
+  m_addressOwner.clear ();
+  m_headMain = m_head ? m_main : Ipv4Address ();
+  for (std::map<Ipv4Address, MemberRoute>::const_iterator it = m_members.begin (); it != m_members.end (); ++it) {
+    m_addressOwner[it->first] = it->first;
+    for (std::size_t a = 0; a < it->second.addresses.size (); a++) {
+      m_addressOwner[it->second.addresses[a]] = it->first;
+    }
+    if (it->second.head && !m_head) {
+      m_headMain = it->first;
+    }
+  }
+
+  m_ranges.clear ();
+  for (std::map<uint32_t, ClusterRoute>::const_iterator it = m_clusters.begin (); it != m_clusters.end (); ++it) {
+    for (std::size_t r = 0; r < it->second.ranges.size (); r++) {
+      RangeOwner owner;
+      owner.first = it->second.ranges[r].first.Get ();
+      owner.last = it->second.ranges[r].last.Get ();
+      owner.cluster = it->first;
+      m_ranges.push_back (owner);
+    }
+  }
+  std::sort (m_ranges.begin (), m_ranges.end (), [] (const RangeOwner &a, const RangeOwner &b) {
+    return a.first < b.first;
+  });
+  m_indexDirty = false;
+}
+
+bool ClusterRoutingProtocol::Lookup (Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) {
+  if (!m_configured) {
+    return false;
+  }
+  if (m_indexDirty) {
+    RebuildIndex ();
+  }
+
+  std::map<Ipv4Address, Ipv4Address>::const_iterator owner = m_addressOwner.find (dst);
+  if (owner != m_addressOwner.end ()) {
+    nextHop = m_members[owner->second].nextHop;
+    interface = m_clusterInterface;
+    return true;
+  }
+
+  if (m_head) {
+    // Last range starting at or below dst
+    uint32_t address = dst.Get ();
+    std::vector<RangeOwner>::const_iterator it = std::upper_bound (m_ranges.begin (), m_ranges.end (), address,
+                                                                   [] (uint32_t a, const RangeOwner &r) {
+      return a < r.first;
+    });
+    if (it == m_ranges.begin () || (--it)->last < address) {
+      return false;
+    }
+    const ClusterRoute &route = m_clusters[it->cluster];
+    nextHop = route.nextHop;
+    interface = route.interface;
+    return true;
+  }
+
+  // Anything outside the cluster is the head's business
+  std::map<Ipv4Address, MemberRoute>::const_iterator head = m_members.find (m_headMain);
+  if (head == m_members.end ()) {
+    return false;
+  }
+  nextHop = head->second.nextHop;
+  interface = m_clusterInterface;
+  return true;
+}
+
+void ClusterRoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const {
+  std::ostream *os = stream->GetStream ();
+  *os << "Node " << m_ipv4->GetObject<Node> ()->GetId () << ", cluster " << m_cluster
+      << (m_head ? " (head)" : "") << ", time " << Simulator::Now ().As (unit) << std::endl;
+  *os << "Member\t\tNextHop\t\tHops" << std::endl;
+  for (std::map<Ipv4Address, MemberRoute>::const_iterator it = m_members.begin (); it != m_members.end (); ++it) {
+    *os << it->first << "\t" << it->second.nextHop << "\t" << static_cast<uint32_t> (it->second.hops)
+        << (it->second.head ? "\thead" : "") << std::endl;
+  }
+  if (m_head) {
+    *os << "Cluster\tNextHop\t\tInterface\tHops" << std::endl;
+    for (std::map<uint32_t, ClusterRoute>::const_iterator it = m_clusters.begin (); it != m_clusters.end (); ++it) {
+      *os << it->first << "\t" << it->second.nextHop << "\t" << it->second.interface << "\t\t"
+          << static_cast<uint32_t> (it->second.hops) << std::endl;
+    }
+  }
+  *os << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CLUSTER_ROUTING_PROTOCOL_H
+#define CLUSTER_ROUTING_PROTOCOL_H
+
+#include "ns3/event-id.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "cluster-routing-header.h"
+#include "next-hop-routing-protocol.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Two-level proactive routing over the clusters of a HierarchyTopologyHelper.
+ *
+ * Members keep a distance vector over their own cluster only, exchanged in
+ * HELLOs on the cluster channel. Every destination outside the cluster goes
+ * to the cluster head. Heads summarize their cluster as the address ranges
+ * its members cover, one range per subnet since addresses are assigned in
+ * member order. They exchange these summaries as a distance vector among
+ * heads on their upper-layer and layer-1 interfaces. A HELLO thus grows with
+ * the cluster size and a SUMMARY with the number of clusters, whereas OLSR
+ * floods topology over all nodes on all interfaces.
+ *
+ * The node's role is set with SetCluster and AddBackboneDevice before the
+ * simulation starts. Nodes without a cluster take part in no routing.
+ */
+class ClusterRoutingProtocol : public NextHopRoutingProtocol {
+public:
+  static const uint16_t PORT = 7070;
+
+  static TypeId GetTypeId (void);
+  ClusterRoutingProtocol ();
+  virtual ~ClusterRoutingProtocol ();
+
+  // Cluster of the node and its device on the cluster channel.
+  void SetCluster (uint32_t cluster, bool head, Ptr<NetDevice> clusterDevice);
+  // Device a head sends and receives SUMMARY messages on.
+  void AddBackboneDevice (Ptr<NetDevice> device);
+
+  int64_t AssignStreams (int64_t stream);
+
+  // Members reached inside the cluster and clusters reached through heads.
+  uint32_t GetNMembers (void) const;
+  uint32_t GetNClusters (void) const;
+
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override;
+
+private:
+  struct MemberRoute {
+    Ipv4Address nextHop;
+    uint8_t hops;
+    bool head;
+    std::vector<Ipv4Address> addresses;
+    Time expires;
+  };
+
+  struct ClusterRoute {
+    Ipv4Address nextHop;
+    uint32_t interface;
+    uint8_t hops;
+    std::vector<ClusterRoutingHeader::Range> ranges;
+    Time expires;
+  };
+
+  // Owner of an address range, sorted by first address
+  struct RangeOwner {
+    uint32_t first;
+    uint32_t last;
+    uint32_t cluster;
+  };
+
+  void DoInitialize (void) override;
+  void DoDispose (void) override;
+
+  Ptr<Socket> OpenSocket (uint32_t interface);
+  void SendHello (void);
+  void SendSummary (void);
+  void Broadcast (Ptr<Socket> socket, uint32_t interface, const ClusterRoutingHeader &header);
+  void Receive (Ptr<Socket> socket);
+  void ReceiveHello (const ClusterRoutingHeader &header, Ipv4Address sender);
+  void ReceiveSummary (const ClusterRoutingHeader &header, Ipv4Address sender, uint32_t interface);
+  void Purge (void);
+  void RebuildIndex (void);
+  std::vector<ClusterRoutingHeader::Range> GetOwnRanges (void) const;
+  Time Jitter (Time interval);
+
+  bool Lookup (Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) override;
+
+  Time m_helloInterval;
+  Time m_summaryInterval;
+  uint32_t m_holdFactor;        // intervals an entry survives without refresh
+  uint8_t m_maxHops;
+  uint32_t m_maxEntries;        // per message
+  Ptr<UniformRandomVariable> m_jitter;
+
+  bool m_configured;
+  uint32_t m_cluster;
+  bool m_head;
+  Ptr<NetDevice> m_clusterDevice;
+  std::vector<Ptr<NetDevice> > m_backboneDevices;
+  uint32_t m_clusterInterface;
+  Ipv4Address m_main;
+  std::map<uint32_t, Ptr<Socket> > m_sockets;   // by interface
+  std::vector<Ptr<Socket> > m_broadcastSockets;
+  std::vector<uint32_t> m_backboneInterfaces;
+
+  std::map<Ipv4Address, MemberRoute> m_members;  // by main address
+  std::map<uint32_t, ClusterRoute> m_clusters;
+  bool m_indexDirty;
+  std::map<Ipv4Address, Ipv4Address> m_addressOwner;  // member address -> main
+  std::vector<RangeOwner> m_ranges;
+  Ipv4Address m_headMain;
+
+  EventId m_helloEvent;
+  EventId m_summaryEvent;
+};
+
+} // namespace ns3
+
+#endif /* CLUSTER_ROUTING_PROTOCOL_H */
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "friis-batch-kernel.h"
+
+#include "ns3/propagation-loss-model.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__ARM_NEON) && defined (__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace ns3 {
+
+FriisBatchKernel::FriisBatchKernel ()
+  : m_lambda (0.0),
+    m_systemLoss (1.0),
+    m_minLoss (0.0)
+{
+}
+
+bool FriisBatchKernel::IsBatchable (Ptr<PropagationLossModel> loss) {
+  return loss != 0
+    && loss->GetInstanceTypeId () == FriisPropagationLossModel::GetTypeId ()
+    && loss->GetNext () == 0;
+}
+
+void FriisBatchKernel::Configure (Ptr<PropagationLossModel> loss) {
+  Ptr<FriisPropagationLossModel> friis = DynamicCast<FriisPropagationLossModel> (loss);
+  // Same expression FriisPropagationLossModel::SetFrequency uses
+  static const double C = 299792458.0;
+  m_lambda = C / friis->GetFrequency ();
+  m_systemLoss = friis->GetSystemLoss ();
+  m_minLoss = friis->GetMinLoss ();
+}
+
+void FriisBatchKernel::Compute (const Vector &tx, double txPowerDbm, std::size_t n,
+                                const double *x, const double *y, const double *z,
+                                double *distance, double *rxPowerDbm) const {
+  std::size_t i = 0;
+#if defined (__AVX2__)
+  const __m256d tx_x = _mm256_set1_pd (tx.x);
+  const __m256d tx_y = _mm256_set1_pd (tx.y);
+  const __m256d tx_z = _mm256_set1_pd (tx.z);
+  for (; i + 4 <= n; i += 4) {
+    __m256d dx = _mm256_sub_pd (_mm256_loadu_pd (x + i), tx_x);
+    __m256d dy = _mm256_sub_pd (_mm256_loadu_pd (y + i), tx_y);
+    __m256d dz = _mm256_sub_pd (_mm256_loadu_pd (z + i), tx_z);
+    __m256d d2 = _mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (dx, dx), _mm256_mul_pd (dy, dy)), _mm256_mul_pd (dz, dz));
+    _mm256_storeu_pd (distance + i, _mm256_sqrt_pd (d2));
+  }
+#elif defined (__ARM_NEON) && defined (__aarch64__)
+  const float64x2_t tx_x = vdupq_n_f64 (tx.x);
+  const float64x2_t tx_y = vdupq_n_f64 (tx.y);
+  const float64x2_t tx_z = vdupq_n_f64 (tx.z);
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t dx = vsubq_f64 (vld1q_f64 (x + i), tx_x);
+    float64x2_t dy = vsubq_f64 (vld1q_f64 (y + i), tx_y);
+    float64x2_t dz = vsubq_f64 (vld1q_f64 (z + i), tx_z);
+    float64x2_t d2 = vaddq_f64 (vaddq_f64 (vmulq_f64 (dx, dx), vmulq_f64 (dy, dy)), vmulq_f64 (dz, dz));
+    vst1q_f64 (distance + i, vsqrtq_f64 (d2));
+  }
+#endif
+  for (; i < n; i++) {
+    double dx = x[i] - tx.x;
+    double dy = y[i] - tx.y;
+    double dz = z[i] - tx.z;
+    distance[i] = std::sqrt (dx * dx + dy * dy + dz * dz);
+  }
+
+  // Friis denominator, kept in the operand order of the per-pair model
+  for (i = 0; i < n; i++) {
+    rxPowerDbm[i] = 16 * M_PI * M_PI * distance[i] * distance[i] * m_systemLoss;
+  }
+
+  double numerator = m_lambda * m_lambda;
+  for (i = 0; i < n; i++) {
+    if (distance[i] <= 0) {
+      rxPowerDbm[i] = txPowerDbm - m_minLoss;
+      continue;
+    }
+    double lossDb = -10 * std::log10 (numerator / rxPowerDbm[i]);
+    rxPowerDbm[i] = txPowerDbm - std::max (lossDb, m_minLoss);
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FRIIS_BATCH_KERNEL_H
+#define FRIIS_BATCH_KERNEL_H
+
+#include "ns3/ptr.h"
+#include "ns3/vector.h"
+
+#include <cstddef>
+
+namespace ns3 {
+
+class PropagationLossModel;
+
+/*
+ * Friis received power for every receiver of one transmission, over
+ * structure-of-arrays positions. Distances are computed with AVX2 or NEON
+ * when the build enables them and a scalar loop otherwise, the loss in one
+ * pass over the distances. The arithmetic is ordered exactly as in
+ * FriisPropagationLossModel::DoCalcRxPower, so results are bit-identical to
+ * the per-pair path as long as the compiler does not contract the scalar
+ * reference into FMAs.
+ */
+class FriisBatchKernel {
+public:
+  FriisBatchKernel ();
+
+  // True for a lone FriisPropagationLossModel, the only chain the kernel
+  // reproduces.
+  static bool IsBatchable (Ptr<PropagationLossModel> loss);
+  void Configure (Ptr<PropagationLossModel> friis);
+
+  void Compute (const Vector &tx, double txPowerDbm, std::size_t n,
+                const double *x, const double *y, const double *z,
+                double *distance, double *rxPowerDbm) const;
+
+private:
+  double m_lambda;
+  double m_systemLoss;
+  double m_minLoss;
+};
+
+} // namespace ns3
+
+#endif /* FRIIS_BATCH_KERNEL_H */
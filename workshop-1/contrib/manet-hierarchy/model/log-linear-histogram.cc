@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "log-linear-histogram.h"
+
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+LogLinearHistogram::LogLinearHistogram (uint32_t precision, uint32_t range)
+  : m_precision (precision),
+    m_range (range),
+    m_count (0),
+    m_sum (0),
+    m_max (0)
+{
+  NS_ABORT_MSG_IF (precision >= range || range > 63, "Histogram precision " << precision << " does not fit range " << range);
+}
+
+// Values below 2^p are their own bucket. Above, a value with its top bit at
+// e sits in row e - p + 1, at the p bits below its top bit.
+uint32_t LogLinearHistogram::GetIndex (uint64_t value) const {
+  uint64_t sub = 1ull << m_precision;
+  value = std::min<uint64_t> (value, (1ull << m_range) - 1);
+  if (value < sub) {
+    return value;
+  }
+  uint32_t exponent = 63 - __builtin_clzll (value);
+  uint32_t shift = exponent - m_precision;
+  return (shift + 1) * sub + (value >> shift) - sub;
+}
+
+uint64_t LogLinearHistogram::GetLowest (uint32_t index) const {
+  uint64_t sub = 1ull << m_precision;
+  if (index < sub) {
+    return index;
+  }
+  uint32_t shift = index / sub - 1;
+  return (index % sub + sub) << shift;
+}
+
+uint64_t LogLinearHistogram::GetWidth (uint32_t index) const {
+  uint64_t sub = 1ull << m_precision;
+  if (index < sub) {
+    return 1;
+  }
+  return 1ull << (index / sub - 1);
+}
+
+void LogLinearHistogram::Add (uint64_t value) {
+  if (m_buckets.empty ()) {
+    m_buckets.assign ((m_range - m_precision + 1) << m_precision, 0);
+  }
+  m_buckets[GetIndex (value)]++;
+  m_count++;
+  m_sum += value;
+  m_max = std::max (m_max, value);
+}
+
+void LogLinearHistogram::Merge (const LogLinearHistogram &other) {
+  NS_ABORT_MSG_IF (other.m_precision != m_precision || other.m_range != m_range, "Merging histograms of different shapes");
+  if (other.m_buckets.empty ()) {
+    return;
+  }
+  if (m_buckets.empty ()) {
+    m_buckets.assign (other.m_buckets.size (), 0);
+  }
+  for (std::size_t i = 0; i < m_buckets.size (); i++) {
+    m_buckets[i] += other.m_buckets[i];
+  }
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+  m_max = std::max (m_max, other.m_max);
+}
+
+void LogLinearHistogram::Reset (void) {
+  std::fill (m_buckets.begin (), m_buckets.end (), 0);
+  m_count = 0;
+  m_sum = 0;
+  m_max = 0;
+}
+
+uint64_t LogLinearHistogram::GetCount (void) const {
+  return m_count;
+}
+
+double LogLinearHistogram::GetMean (void) const {
+  return m_count > 0 ? static_cast<double> (m_sum) / m_count : 0.0;
+}
+
+uint64_t LogLinearHistogram::GetMax (void) const {
+  return m_max;
+}
+
+uint64_t LogLinearHistogram::GetQuantile (double q) const {
+  if (m_count == 0) {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (q * m_count)));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_buckets.size (); i++) {
+    seen += m_buckets[i];
+    if (seen >= rank) {
+      return std::min (m_max, GetLowest (i) + (GetWidth (i) - 1) / 2);
+    }
+  }
+  return m_max;
+}
+
+} // namespace ns3
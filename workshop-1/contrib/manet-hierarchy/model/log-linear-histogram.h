@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LOG_LINEAR_HISTOGRAM_H
+#define LOG_LINEAR_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * HDR-style histogram of non-negative integers: every power of two is split
+ * into 2^precision linear buckets, so values below 2^precision are exact and
+ * larger ones are kept within a relative error of 2^-precision. Values of
+ * 2^range and above go into the top bucket.
+ *
+ * Add is a shift and an increment. The buckets, (range - precision + 1) *
+ * 2^precision counters, are only allocated by the first Add.
+ */
+class LogLinearHistogram {
+public:
+  LogLinearHistogram (uint32_t precision = 5, uint32_t range = 32);
+
+  void Add (uint64_t value);
+  // Both histograms must have the same precision and range.
+  void Merge (const LogLinearHistogram &other);
+  // Empties the buckets but keeps them allocated.
+  void Reset (void);
+
+  uint64_t GetCount (void) const;
+  // Exact, from the sum of the values added.
+  double GetMean (void) const;
+  uint64_t GetMax (void) const;
+  // Middle of the bucket holding the q-quantile, at most GetMax; 0 if empty.
+  uint64_t GetQuantile (double q) const;
+
+private:
+  uint32_t GetIndex (uint64_t value) const;
+  uint64_t GetLowest (uint32_t index) const;
+  uint64_t GetWidth (uint32_t index) const;
+
+  uint32_t m_precision;
+  uint32_t m_range;
+  uint64_t m_count;
+  uint64_t m_sum;
+  uint64_t m_max;
+  std::vector<uint32_t> m_buckets;
+};
+
+} // namespace ns3
+
+#endif /* LOG_LINEAR_HISTOGRAM_H */
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "mobility-store.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilityStore");
+
+NS_OBJECT_ENSURE_REGISTERED (MobilityStore);
+
+TypeId MobilityStore::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::MobilityStore")
+    .SetParent<Object> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<MobilityStore> ()
+  ;
+  return tid;
+}
+
+MobilityStore::MobilityStore ()
+  : m_bounded (false),
+    m_evaluated (false)
+{
+}
+
+MobilityStore::~MobilityStore () {
+}
+
+void MobilityStore::DoDispose (void) {
+  m_mobility.clear ();
+  m_index.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t MobilityStore::Add (Ptr<MobilityModel> mobility) {
+  NS_ABORT_MSG_IF (mobility == 0, "MobilityStore needs a mobility model");
+  uint32_t i = m_mobility.size ();
+  m_mobility.push_back (mobility);
+  m_index[PeekPointer (mobility)] = i;
+  m_originX.push_back (0.0);
+  m_originY.push_back (0.0);
+  m_originZ.push_back (0.0);
+  m_velocityX.push_back (0.0);
+  m_velocityY.push_back (0.0);
+  m_velocityZ.push_back (0.0);
+  m_legStart.push_back (0.0);
+  m_legEnd.push_back (0.0);
+  m_x.push_back (0.0);
+  m_y.push_back (0.0);
+  m_z.push_back (0.0);
+  SetLeg (i, *mobility);
+  mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityStore::CourseChanged, this));
+  m_evaluated = false;
+  return i;
+}
+
+uint32_t MobilityStore::GetN (void) const {
+  return m_mobility.size ();
+}
+
+uint32_t MobilityStore::GetIndex (Ptr<const MobilityModel> mobility) const {
+  std::map<const MobilityModel *, uint32_t>::const_iterator it = m_index.find (PeekPointer (mobility));
+  NS_ABORT_MSG_IF (it == m_index.end (), "Mobility model not in the store");
+  return it->second;
+}
+
+Ptr<MobilityModel> MobilityStore::GetMobility (uint32_t i) const {
+  return m_mobility.at (i);
+}
+
+void MobilityStore::SetBounds (const Box &bounds) {
+  NS_ABORT_MSG_IF (!m_mobility.empty (), "Set the bounds before adding models");
+  m_bounds = bounds;
+  m_bounded = true;
+}
+
+void MobilityStore::SetLeg (uint32_t i, const MobilityModel &mobility) {
+  Vector position = mobility.GetPosition ();
+  Vector velocity = mobility.GetVelocity ();
+  m_originX[i] = position.x;
+  m_originY[i] = position.y;
+  m_originZ[i] = position.z;
+  m_velocityX[i] = velocity.x;
+  m_velocityY[i] = velocity.y;
+  m_velocityZ[i] = velocity.z;
+  m_legStart[i] = Simulator::Now ().GetSeconds ();
+
+  // Time to the first face of the bounds the leg heads for
+  double duration = std::numeric_limits<double>::infinity ();
+  if (m_bounded) {
+    double p[3] = {position.x, position.y, position.z};
+    double v[3] = {velocity.x, velocity.y, velocity.z};
+    double lo[3] = {m_bounds.xMin, m_bounds.yMin, m_bounds.zMin};
+    double hi[3] = {m_bounds.xMax, m_bounds.yMax, m_bounds.zMax};
+    for (int a = 0; a < 3; a++) {
+      if (v[a] > 0) {
+        duration = std::min (duration, std::max (0.0, (hi[a] - p[a]) / v[a]));
+      }
+      else if (v[a] < 0) {
+        duration = std::min (duration, std::max (0.0, (lo[a] - p[a]) / v[a]));
+      }
+    }
+  }
+  m_legEnd[i] = m_legStart[i] + duration;
+  // A leg starting now is already evaluated
+  m_x[i] = position.x;
+  m_y[i] = position.y;
+  m_z[i] = position.z;
+}
+
+void MobilityStore::CourseChanged (Ptr<const MobilityModel> mobility) {
+  std::map<const MobilityModel *, uint32_t>::const_iterator it = m_index.find (PeekPointer (mobility));
+  if (it == m_index.end ()) {
+    return;
+  }
+  SetLeg (it->second, *mobility);
+  if (m_evaluated && m_evaluatedAt != Simulator::Now ()) {
+    // The other nodes are stale; so is the whole evaluation
+    m_evaluated = false;
+  }
+}
+
+void MobilityStore::Update (void) {
+  Time now = Simulator::Now ();
+  if (m_evaluated && m_evaluatedAt == now) {
+    return;
+  }
+  double t = now.GetSeconds ();
+  std::size_t n = m_mobility.size ();
+  for (std::size_t i = 0; i < n; i++) {
+    double dt = std::min (t, m_legEnd[i]) - m_legStart[i];
+    m_x[i] = m_originX[i] + m_velocityX[i] * dt;
+    m_y[i] = m_originY[i] + m_velocityY[i] * dt;
+    m_z[i] = m_originZ[i] + m_velocityZ[i] * dt;
+  }
+  m_evaluatedAt = now;
+  m_evaluated = true;
+}
+
+const double *MobilityStore::GetX (void) const {
+  return m_x.data ();
+}
+
+const double *MobilityStore::GetY (void) const {
+  return m_y.data ();
+}
+
+const double *MobilityStore::GetZ (void) const {
+  return m_z.data ();
+}
+
+Vector MobilityStore::GetPosition (uint32_t i) const {
+  Time now = Simulator::Now ();
+  if (m_evaluated && m_evaluatedAt == now) {
+    return Vector (m_x[i], m_y[i], m_z[i]);
+  }
+  double dt = std::min (now.GetSeconds (), m_legEnd[i]) - m_legStart[i];
+  return Vector (m_originX[i] + m_velocityX[i] * dt,
+                 m_originY[i] + m_velocityY[i] * dt,
+                 m_originZ[i] + m_velocityZ[i] * dt);
+}
+
+Vector MobilityStore::GetVelocity (uint32_t i) const {
+  return Vector (m_velocityX[i], m_velocityY[i], m_velocityZ[i]);
+}
+
+Time MobilityStore::GetLegStart (uint32_t i) const {
+  return Seconds (m_legStart[i]);
+}
+
+double MobilityStore::GetLegEnd (uint32_t i) const {
+  return m_legEnd[i];
+}
+
+double MobilityStore::GetMaxSpeed (void) const {
+  double maxSpeed = 0.0;
+  for (std::size_t i = 0; i < m_mobility.size (); i++) {
+    double vx = m_velocityX[i];
+    double vy = m_velocityY[i];
+    double vz = m_velocityZ[i];
+    maxSpeed = std::max (maxSpeed, std::sqrt (vx * vx + vy * vy + vz * vz));
+  }
+  return maxSpeed;
+}
+
+} // namespace ns3
@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MOBILITY_STORE_H
+#define MOBILITY_STORE_H
+
+#include "ns3/object.h"
+#include "ns3/box.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Current leg of every registered mobility model (origin, velocity, start
+ * and end time) in contiguous arrays, refreshed from CourseChange. Valid for
+ * models that move at constant velocity between course changes, such as
+ * RandomWaypointMobilityModel, which notifies at both ends of every walk and
+ * pause. Positions are origin + velocity * (t - start), with t clamped to the
+ * leg end, evaluated for all nodes in one loop and kept until the clock moves.
+ *
+ * A leg ends where it would leave the bounds, if set; models that stay in a
+ * box never get extrapolated out of it. ConstantVelocityHelper accumulates
+ * its displacement on every query, so store positions agree with
+ * GetPosition () to rounding, not bit for bit. The store never queries the
+ * models between course changes.
+ */
+class MobilityStore : public Object {
+public:
+  static TypeId GetTypeId (void);
+  MobilityStore ();
+  virtual ~MobilityStore ();
+
+  // Returns the index of the model in the arrays.
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  uint32_t GetN (void) const;
+  // Index of a registered model; aborts for unknown ones.
+  uint32_t GetIndex (Ptr<const MobilityModel> mobility) const;
+  Ptr<MobilityModel> GetMobility (uint32_t i) const;
+  // Area the models stay in; before Add ().
+  void SetBounds (const Box &bounds);
+
+  // Evaluates every position at the current time if not done yet.
+  void Update (void);
+  // Arrays of the last Update (), indexed like Add ().
+  const double *GetX (void) const;
+  const double *GetY (void) const;
+  const double *GetZ (void) const;
+
+  // Of one node at the current time, without evaluating the others.
+  Vector GetPosition (uint32_t i) const;
+  Vector GetVelocity (uint32_t i) const;
+  Time GetLegStart (uint32_t i) const;
+  // Infinite for still nodes and legs without bounds.
+  double GetLegEnd (uint32_t i) const;
+  // Fastest current speed over all nodes.
+  double GetMaxSpeed (void) const;
+
+private:
+  void DoDispose (void) override;
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  void SetLeg (uint32_t i, const MobilityModel &mobility);
+
+  std::vector<Ptr<MobilityModel> > m_mobility;
+  std::map<const MobilityModel *, uint32_t> m_index;
+
+  bool m_bounded;
+  Box m_bounds;
+
+  // Leg of each node, times in s
+  std::vector<double> m_originX, m_originY, m_originZ;
+  std::vector<double> m_velocityX, m_velocityY, m_velocityZ;
+  std::vector<double> m_legStart, m_legEnd;
+
+  // Positions at m_evaluatedAt
+  std::vector<double> m_x, m_y, m_z;
+  Time m_evaluatedAt;
+  bool m_evaluated;
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_STORE_H */
@@ -0,0 +1,450 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "mobility-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "mobility-store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobilityTrace");
+
+static const char g_magic[4] = {'M', 'O', 'B', 'T'};
+static const char g_indexMagic[4] = {'M', 'O', 'B', 'I'};
+static const uint32_t g_version = 1;
+static const double g_positionScale = 1e3;   // mm
+static const double g_velocityScale = 1e6;   // um/s
+
+static void PutVarint (std::vector<uint8_t> &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back (static_cast<uint8_t> (value | 0x80));
+    value >>= 7;
+  }
+  out.push_back (static_cast<uint8_t> (value));
+}
+
+static void PutSigned (std::vector<uint8_t> &out, int64_t value) {
+  PutVarint (out, (static_cast<uint64_t> (value) << 1) ^ static_cast<uint64_t> (value >> 63));
+}
+
+static uint64_t GetVarint (const uint8_t *&p, const uint8_t *end) {
+  uint64_t value = 0;
+  for (int shift = 0; p < end && shift < 64; shift += 7) {
+    uint8_t byte = *p++;
+    value |= static_cast<uint64_t> (byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  NS_ABORT_MSG ("Truncated varint in mobility trace");
+  return 0;
+}
+
+static int64_t GetSigned (const uint8_t *&p, const uint8_t *end) {
+  uint64_t value = GetVarint (p, end);
+  return static_cast<int64_t> (value >> 1) ^ -static_cast<int64_t> (value & 1);
+}
+
+template <typename T>
+static void WriteRaw (std::ostream &out, const T &value) {
+  out.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+template <typename T>
+static void ReadRaw (std::istream &in, T &value) {
+  in.read (reinterpret_cast<char *> (&value), sizeof (value));
+}
+
+// Where a leg puts its node at time t, in mm; shared by writer and reader so
+// that both round the same way.
+static int64_t Predict (const MobilityTraceLeg &leg, int k, int64_t t) {
+  return leg.origin[k] + std::llround (static_cast<double> (leg.velocity[k]) * static_cast<double> (t - leg.start) * 1e-12);
+}
+
+static void PutLeg (std::vector<uint8_t> &out, const MobilityTraceLeg &leg) {
+  PutSigned (out, leg.start);
+  for (int k = 0; k < 3; k++) {
+    PutSigned (out, leg.origin[k]);
+  }
+  for (int k = 0; k < 3; k++) {
+    PutSigned (out, leg.velocity[k]);
+  }
+}
+
+static MobilityTraceLeg GetLeg (const uint8_t *&p, const uint8_t *end) {
+  MobilityTraceLeg leg;
+  leg.start = GetSigned (p, end);
+  for (int k = 0; k < 3; k++) {
+    leg.origin[k] = GetSigned (p, end);
+  }
+  for (int k = 0; k < 3; k++) {
+    leg.velocity[k] = GetSigned (p, end);
+  }
+  return leg;
+}
+
+MobilityTraceWriter::MobilityTraceWriter ()
+  : m_chunkDuration (Seconds (10.0)),
+    m_sampleInterval (Seconds (0.0)),
+    m_inChunk (false),
+    m_chunkStart (0),
+    m_lastRecord (0),
+    m_chunkRecords (0),
+    m_offset (0),
+    m_records (0)
+{
+}
+
+MobilityTraceWriter::~MobilityTraceWriter () {
+  Close ();
+}
+
+void MobilityTraceWriter::SetChunkDuration (Time duration) {
+  m_chunkDuration = duration;
+}
+
+void MobilityTraceWriter::SetSampleInterval (Time interval) {
+  m_sampleInterval = interval;
+}
+
+bool MobilityTraceWriter::IsOpen (void) const {
+  return m_out.is_open ();
+}
+
+uint64_t MobilityTraceWriter::GetRecords (void) const {
+  return m_records;
+}
+
+void MobilityTraceWriter::Open (const std::string &fileName, Ptr<MobilityStore> store) {
+  Close ();
+  m_out.open (fileName.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!m_out, "Cannot open mobility trace " << fileName);
+  m_fileName = fileName;
+
+  uint32_t n = store->GetN ();
+  uint8_t sampled = m_sampleInterval.IsStrictlyPositive ();
+  m_out.write (g_magic, sizeof (g_magic));
+  WriteRaw (m_out, g_version);
+  WriteRaw (m_out, sampled);
+  WriteRaw (m_out, n);
+  m_offset = sizeof (g_magic) + sizeof (g_version) + sizeof (sampled) + sizeof (n);
+
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  m_store = store;
+  m_mobility.clear ();
+  m_index.clear ();
+  m_legs.assign (n, MobilityTraceLeg ());
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<MobilityModel> mobility = store->GetMobility (i);
+    Ptr<Node> node = mobility->GetObject<Node> ();
+    uint32_t id = node != 0 ? node->GetId () : i;
+    WriteRaw (m_out, id);
+    m_offset += sizeof (id);
+
+    m_mobility.push_back (mobility);
+    m_index[PeekPointer (mobility)] = i;
+    Vector p = store->GetPosition (i);
+    Vector v = store->GetVelocity (i);
+    MobilityTraceLeg &leg = m_legs[i];
+    leg.start = now;
+    leg.origin[0] = std::llround (p.x * g_positionScale);
+    leg.origin[1] = std::llround (p.y * g_positionScale);
+    leg.origin[2] = std::llround (p.z * g_positionScale);
+    leg.velocity[0] = std::llround (v.x * g_velocityScale);
+    leg.velocity[1] = std::llround (v.y * g_velocityScale);
+    leg.velocity[2] = std::llround (v.z * g_velocityScale);
+    if (!sampled) {
+      mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityTraceWriter::CourseChanged, this));
+    }
+  }
+  m_chunks.clear ();
+  m_records = 0;
+  BeginChunk (now);
+  if (sampled) {
+    m_sampleEvent = Simulator::Schedule (m_sampleInterval, &MobilityTraceWriter::Sample, this);
+  }
+}
+
+void MobilityTraceWriter::Close (void) {
+  if (!m_out.is_open ()) {
+    return;
+  }
+  m_sampleEvent.Cancel ();
+  if (!m_sampleInterval.IsStrictlyPositive ()) {
+    for (std::size_t i = 0; i < m_mobility.size (); i++) {
+      m_mobility[i]->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MobilityTraceWriter::CourseChanged, this));
+    }
+  }
+  EndChunk (Simulator::Now ().GetNanoSeconds ());
+
+  uint64_t indexOffset = m_offset;
+  WriteRaw (m_out, static_cast<uint64_t> (m_chunks.size ()));
+  for (std::size_t i = 0; i < m_chunks.size (); i++) {
+    WriteRaw (m_out, m_chunks[i].start);
+    WriteRaw (m_out, m_chunks[i].end);
+    WriteRaw (m_out, m_chunks[i].offset);
+  }
+  WriteRaw (m_out, indexOffset);
+  m_out.write (g_indexMagic, sizeof (g_indexMagic));
+  m_out.close ();
+  m_store = 0;
+  m_mobility.clear ();
+  m_index.clear ();
+}
+
+void MobilityTraceWriter::Flush (void) {
+  if (!m_out.is_open ()) {
+    return;
+  }
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  EndChunk (now);
+  BeginChunk (now);
+  m_out.flush ();
+}
+
+void MobilityTraceWriter::Relocate (const std::string &fileName) {
+  NS_ABORT_MSG_IF (!m_out.is_open (), "No mobility trace to relocate");
+  m_out.close ();
+  {
+    std::ifstream in (m_fileName.c_str (), std::ios::binary);
+    std::ofstream out (fileName.c_str (), std::ios::binary);
+    out << in.rdbuf ();
+  }
+  m_out.open (fileName.c_str (), std::ios::binary | std::ios::app);
+  NS_ABORT_MSG_IF (!m_out, "Cannot open mobility trace " << fileName);
+  m_fileName = fileName;
+}
+
+void MobilityTraceWriter::BeginChunk (int64_t now) {
+  m_chunk.clear ();
+  for (std::size_t i = 0; i < m_legs.size (); i++) {
+    PutLeg (m_chunk, m_legs[i]);
+  }
+  m_chunkStart = now;
+  m_lastRecord = now;
+  m_chunkRecords = 0;
+  m_inChunk = true;
+}
+
+void MobilityTraceWriter::EndChunk (int64_t now) {
+  if (!m_inChunk) {
+    return;
+  }
+  MobilityTraceChunk index;
+  index.start = m_chunkStart;
+  index.end = now;
+  index.offset = m_offset;
+  m_chunks.push_back (index);
+
+  uint32_t bytes = m_chunk.size ();
+  WriteRaw (m_out, m_chunkStart);
+  WriteRaw (m_out, m_chunkRecords);
+  WriteRaw (m_out, bytes);
+  m_out.write (reinterpret_cast<const char *> (m_chunk.data ()), bytes);
+  m_offset += sizeof (m_chunkStart) + sizeof (m_chunkRecords) + sizeof (bytes) + bytes;
+  m_inChunk = false;
+}
+
+void MobilityTraceWriter::CourseChanged (Ptr<const MobilityModel> mobility) {
+  std::map<const MobilityModel *, uint32_t>::const_iterator it = m_index.find (PeekPointer (mobility));
+  if (it != m_index.end ()) {
+    Record (it->second, mobility->GetPosition (), mobility->GetVelocity ());
+  }
+}
+
+void MobilityTraceWriter::Sample (void) {
+  m_store->Update ();
+  const double *x = m_store->GetX ();
+  const double *y = m_store->GetY ();
+  const double *z = m_store->GetZ ();
+  for (uint32_t i = 0; i < m_mobility.size (); i++) {
+    Record (i, Vector (x[i], y[i], z[i]), m_store->GetVelocity (i));
+  }
+  m_sampleEvent = Simulator::Schedule (m_sampleInterval, &MobilityTraceWriter::Sample, this);
+}
+
+void MobilityTraceWriter::Record (uint32_t node, const Vector &p, const Vector &v) {
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  if (now - m_chunkStart >= m_chunkDuration.GetNanoSeconds ()) {
+    EndChunk (now);
+    BeginChunk (now);
+  }
+  MobilityTraceLeg leg;
+  leg.start = now;
+  leg.origin[0] = std::llround (p.x * g_positionScale);
+  leg.origin[1] = std::llround (p.y * g_positionScale);
+  leg.origin[2] = std::llround (p.z * g_positionScale);
+  leg.velocity[0] = std::llround (v.x * g_velocityScale);
+  leg.velocity[1] = std::llround (v.y * g_velocityScale);
+  leg.velocity[2] = std::llround (v.z * g_velocityScale);
+
+  const MobilityTraceLeg &previous = m_legs[node];
+  PutVarint (m_chunk, node);
+  PutVarint (m_chunk, now - m_lastRecord);
+  for (int k = 0; k < 3; k++) {
+    PutSigned (m_chunk, leg.origin[k] - Predict (previous, k, now));
+  }
+  for (int k = 0; k < 3; k++) {
+    PutSigned (m_chunk, leg.velocity[k] - previous.velocity[k]);
+  }
+  m_legs[node] = leg;
+  m_lastRecord = now;
+  m_chunkRecords++;
+  m_records++;
+}
+
+MobilityTraceReader::MobilityTraceReader ()
+  : m_sampled (false),
+    m_loaded (-1)
+{
+}
+
+void MobilityTraceReader::Open (const std::string &fileName) {
+  m_in.open (fileName.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!m_in, "Cannot open mobility trace " << fileName);
+
+  char magic[4];
+  uint32_t version;
+  uint8_t sampled;
+  uint32_t n;
+  m_in.read (magic, sizeof (magic));
+  ReadRaw (m_in, version);
+  ReadRaw (m_in, sampled);
+  ReadRaw (m_in, n);
+  NS_ABORT_MSG_IF (!m_in || std::memcmp (magic, g_magic, sizeof (magic)) != 0, fileName << " is not a mobility trace");
+  NS_ABORT_MSG_IF (version != g_version, "Mobility trace version " << version << " is not supported");
+  m_sampled = sampled;
+  m_nodeIds.resize (n);
+  for (uint32_t i = 0; i < n; i++) {
+    ReadRaw (m_in, m_nodeIds[i]);
+  }
+
+  // Trailer: offset of the index and its magic
+  uint64_t indexOffset;
+  m_in.seekg (-static_cast<std::streamoff> (sizeof (indexOffset) + sizeof (g_indexMagic)), std::ios::end);
+  ReadRaw (m_in, indexOffset);
+  m_in.read (magic, sizeof (magic));
+  NS_ABORT_MSG_IF (!m_in || std::memcmp (magic, g_indexMagic, sizeof (magic)) != 0,
+                   fileName << " has no chunk index, the run did not close it");
+  m_in.seekg (indexOffset);
+  uint64_t nChunks;
+  ReadRaw (m_in, nChunks);
+  m_chunks.resize (nChunks);
+  for (uint64_t i = 0; i < nChunks; i++) {
+    ReadRaw (m_in, m_chunks[i].start);
+    ReadRaw (m_in, m_chunks[i].end);
+    ReadRaw (m_in, m_chunks[i].offset);
+  }
+  NS_ABORT_MSG_IF (!m_in || m_chunks.empty (), fileName << " has a damaged chunk index");
+  m_loaded = -1;
+}
+
+uint32_t MobilityTraceReader::GetNNodes (void) const {
+  return m_nodeIds.size ();
+}
+
+uint32_t MobilityTraceReader::GetNodeId (uint32_t node) const {
+  return m_nodeIds.at (node);
+}
+
+Time MobilityTraceReader::GetStart (void) const {
+  return NanoSeconds (m_chunks.front ().start);
+}
+
+Time MobilityTraceReader::GetEnd (void) const {
+  return NanoSeconds (m_chunks.back ().end);
+}
+
+bool MobilityTraceReader::IsSampled (void) const {
+  return m_sampled;
+}
+
+void MobilityTraceReader::LoadChunk (uint32_t chunk) {
+  if (m_loaded == chunk) {
+    return;
+  }
+  int64_t start;
+  uint32_t records;
+  uint32_t bytes;
+  m_in.clear ();
+  m_in.seekg (m_chunks[chunk].offset);
+  ReadRaw (m_in, start);
+  ReadRaw (m_in, records);
+  ReadRaw (m_in, bytes);
+  std::vector<uint8_t> payload (bytes);
+  m_in.read (reinterpret_cast<char *> (payload.data ()), bytes);
+  NS_ABORT_MSG_IF (!m_in, "Truncated mobility trace chunk " << chunk);
+
+  const uint8_t *p = payload.data ();
+  const uint8_t *end = p + bytes;
+  m_legs.assign (m_nodeIds.size (), std::vector<MobilityTraceLeg> ());
+  for (uint32_t i = 0; i < m_nodeIds.size (); i++) {
+    m_legs[i].push_back (GetLeg (p, end));
+  }
+  int64_t now = start;
+  for (uint32_t r = 0; r < records; r++) {
+    uint32_t node = GetVarint (p, end);
+    NS_ABORT_MSG_IF (node >= m_nodeIds.size (), "Bad node in mobility trace chunk " << chunk);
+    now += GetVarint (p, end);
+    const MobilityTraceLeg previous = m_legs[node].back ();
+    MobilityTraceLeg leg;
+    leg.start = now;
+    for (int k = 0; k < 3; k++) {
+      leg.origin[k] = Predict (previous, k, now) + GetSigned (p, end);
+    }
+    for (int k = 0; k < 3; k++) {
+      leg.velocity[k] = previous.velocity[k] + GetSigned (p, end);
+    }
+    m_legs[node].push_back (leg);
+  }
+  m_loaded = chunk;
+}
+
+const MobilityTraceLeg &MobilityTraceReader::FindLeg (uint32_t node, Time t) {
+  NS_ABORT_MSG_IF (node >= m_nodeIds.size (), "No node " << node << " in the mobility trace");
+  int64_t ns = t.GetNanoSeconds ();
+  // Last chunk starting at or before t
+  uint32_t chunk = 0;
+  uint32_t lo = 0;
+  uint32_t hi = m_chunks.size ();
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (m_chunks[mid].start <= ns) {
+      chunk = mid;
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  LoadChunk (chunk);
+  const std::vector<MobilityTraceLeg> &legs = m_legs[node];
+  std::size_t i = legs.size () - 1;
+  while (i > 0 && legs[i].start > ns) {
+    i--;
+  }
+  return legs[i];
+}
+
+Vector MobilityTraceReader::GetPosition (uint32_t node, Time t) {
+  const MobilityTraceLeg &leg = FindLeg (node, t);
+  double dt = (t.GetNanoSeconds () - leg.start) * 1e-9;
+  return Vector (leg.origin[0] / g_positionScale + leg.velocity[0] / g_velocityScale * dt,
+                 leg.origin[1] / g_positionScale + leg.velocity[1] / g_velocityScale * dt,
+                 leg.origin[2] / g_positionScale + leg.velocity[2] / g_velocityScale * dt);
+}
+
+Vector MobilityTraceReader::GetVelocity (uint32_t node, Time t) {
+  const MobilityTraceLeg &leg = FindLeg (node, t);
+  return Vector (leg.velocity[0] / g_velocityScale,
+                 leg.velocity[1] / g_velocityScale,
+                 leg.velocity[2] / g_velocityScale);
+}
+
+} // namespace ns3
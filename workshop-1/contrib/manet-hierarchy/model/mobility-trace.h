@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MOBILITY_TRACE_H
+#define MOBILITY_TRACE_H
+
+#include "ns3/event-id.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+#include <stdint.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class MobilityStore;
+
+// One leg of a node as stored in a mobility trace.
+struct MobilityTraceLeg {
+  int64_t start;       // ns
+  int64_t origin[3];   // mm
+  int64_t velocity[3]; // um/s
+};
+
+struct MobilityTraceChunk {
+  int64_t start;       // ns
+  int64_t end;
+  uint64_t offset;     // of the chunk in the file
+};
+
+/*
+ * Binary mobility trace made of leg records (start time, origin, velocity) in
+ * place of one text line per course change.
+ *
+ * Layout: header with the node ids, then chunks covering ChunkDuration each,
+ * then an index of the chunks and a fixed trailer pointing at it. A chunk
+ * opens with a keyframe holding the current leg of every node and continues
+ * with one record per leg: node, time since the previous record and the
+ * difference of origin and velocity against the leg before, all varints.
+ * Positions are kept in mm, velocities in um/s and times in ns; the origin is
+ * predicted from the previous leg, so for continuous motion its delta is ~0.
+ *
+ * With a sampling interval every node gets a record at each tick instead of
+ * on course changes, and positions in between are extrapolated from the
+ * last sample. Samples are read from the MobilityStore arrays, not from the
+ * models.
+ */
+class MobilityTraceWriter {
+public:
+  MobilityTraceWriter ();
+  ~MobilityTraceWriter ();
+
+  void SetChunkDuration (Time duration);
+  // 0 records every leg.
+  void SetSampleInterval (Time interval);
+
+  // Traces every model in the store, indexed like it.
+  void Open (const std::string &fileName, Ptr<MobilityStore> store);
+  // Ends the current chunk and writes the index.
+  void Close (void);
+  bool IsOpen (void) const;
+  // Ends the current chunk, so that the file can be copied before a fork.
+  void Flush (void);
+  // Continues the flushed trace in a copy under another name, in a child.
+  void Relocate (const std::string &fileName);
+
+  uint64_t GetRecords (void) const;
+
+private:
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  void Sample (void);
+  void Record (uint32_t node, const Vector &p, const Vector &v);
+  void BeginChunk (int64_t now);
+  void EndChunk (int64_t now);
+
+  std::ofstream m_out;
+  std::string m_fileName;
+  Time m_chunkDuration;
+  Time m_sampleInterval;
+  Ptr<MobilityStore> m_store;
+  std::vector<Ptr<MobilityModel> > m_mobility;
+  std::map<const MobilityModel *, uint32_t> m_index;
+  std::vector<MobilityTraceLeg> m_legs;
+  std::vector<uint8_t> m_chunk;
+  bool m_inChunk;
+  int64_t m_chunkStart;
+  int64_t m_lastRecord;
+  uint32_t m_chunkRecords;
+  uint64_t m_offset;            // bytes written to the file
+  std::vector<MobilityTraceChunk> m_chunks;
+  uint64_t m_records;
+  EventId m_sampleEvent;
+};
+
+/*
+ * Random access to a MobilityTraceWriter file: finds the chunk of a time from
+ * the index and decodes that chunk only.
+ */
+class MobilityTraceReader {
+public:
+  MobilityTraceReader ();
+
+  void Open (const std::string &fileName);
+
+  uint32_t GetNNodes (void) const;
+  // ns-3 node id of a trace index.
+  uint32_t GetNodeId (uint32_t node) const;
+  Time GetStart (void) const;
+  Time GetEnd (void) const;
+  bool IsSampled (void) const;
+
+  Vector GetPosition (uint32_t node, Time t);
+  Vector GetVelocity (uint32_t node, Time t);
+
+private:
+  const MobilityTraceLeg &FindLeg (uint32_t node, Time t);
+  void LoadChunk (uint32_t chunk);
+
+  std::ifstream m_in;
+  std::vector<uint32_t> m_nodeIds;
+  bool m_sampled;
+  std::vector<MobilityTraceChunk> m_chunks;
+  // Decoded chunk: every leg of each node, in time order
+  int64_t m_loaded;
+  std::vector<std::vector<MobilityTraceLeg> > m_legs;
+};
+
+} // namespace ns3
+
+#endif /* MOBILITY_TRACE_H */
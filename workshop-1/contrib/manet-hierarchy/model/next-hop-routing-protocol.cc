@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "next-hop-routing-protocol.h"
+
+#include "ns3/ipv4-route.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NextHopRoutingProtocol");
+
+NS_OBJECT_ENSURE_REGISTERED (NextHopRoutingProtocol);
+
+TypeId NextHopRoutingProtocol::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::NextHopRoutingProtocol")
+    .SetParent<Ipv4RoutingProtocol> ()
+    .SetGroupName ("ManetHierarchy")
+  ;
+  return tid;
+}
+
+NextHopRoutingProtocol::NextHopRoutingProtocol () {
+}
+
+NextHopRoutingProtocol::~NextHopRoutingProtocol () {
+}
+
+void NextHopRoutingProtocol::DoDispose (void) {
+  m_ipv4 = 0;
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
+void NextHopRoutingProtocol::SetIpv4 (Ptr<Ipv4> ipv4) {
+  m_ipv4 = ipv4;
+}
+
+bool NextHopRoutingProtocol::IsOwnAddress (Ipv4Address address) const {
+  return m_ipv4->GetInterfaceForAddress (address) >= 0;
+}
+
+Ptr<Ipv4Route> NextHopRoutingProtocol::MakeRoute (Ipv4Address dst, Ipv4Address nextHop, uint32_t interface) const {
+  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+  route->SetDestination (dst);
+  route->SetGateway (nextHop);
+  route->SetSource (m_ipv4->GetAddress (interface, 0).GetLocal ());
+  route->SetOutputDevice (m_ipv4->GetNetDevice (interface));
+  return route;
+}
+
+Ptr<Ipv4Route> NextHopRoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                                    Socket::SocketErrno &sockerr) {
+  Ipv4Address dst = header.GetDestination ();
+  sockerr = Socket::ERROR_NOTERROR;
+
+  // Broadcasts stay on the interface they are meant for
+  for (uint32_t i = 1; i < m_ipv4->GetNInterfaces (); i++) {
+    Ipv4InterfaceAddress address = m_ipv4->GetAddress (i, 0);
+    bool onInterface = oif == 0 || oif == m_ipv4->GetNetDevice (i);
+    if (onInterface && (dst.IsBroadcast () || dst == address.GetBroadcast ())) {
+      Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+      route->SetDestination (dst);
+      route->SetGateway (dst);
+      route->SetSource (address.GetLocal ());
+      route->SetOutputDevice (m_ipv4->GetNetDevice (i));
+      return route;
+    }
+  }
+
+  if (IsOwnAddress (dst)) {
+    Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+    route->SetDestination (dst);
+    route->SetGateway (Ipv4Address ("127.0.0.1"));
+    route->SetSource (dst);
+    route->SetOutputDevice (m_ipv4->GetNetDevice (0));
+    return route;
+  }
+
+  Ipv4Address nextHop;
+  uint32_t interface;
+  if (Lookup (dst, nextHop, interface)) {
+    return MakeRoute (dst, nextHop, interface);
+  }
+  NS_LOG_DEBUG ("No route to " << dst);
+  sockerr = Socket::ERROR_NOROUTETOHOST;
+  return 0;
+}
+
+bool NextHopRoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                                         UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                         LocalDeliverCallback lcb, ErrorCallback ecb) {
+  Ipv4Address dst = header.GetDestination ();
+  int32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+  if (dst.IsMulticast ()) {
+    return false;
+  }
+  if (m_ipv4->IsDestinationAddress (dst, iif)) {
+    if (lcb.IsNull ()) {
+      return false;
+    }
+    lcb (p, header, iif);
+    return true;
+  }
+  if (!m_ipv4->IsForwarding (iif)) {
+    ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+    return true;
+  }
+
+  Ipv4Address nextHop;
+  uint32_t interface;
+  if (Lookup (dst, nextHop, interface)) {
+    ucb (MakeRoute (dst, nextHop, interface), p, header);
+    return true;
+  }
+  return false;
+}
+
+void NextHopRoutingProtocol::NotifyInterfaceUp (uint32_t interface) {
+}
+
+void NextHopRoutingProtocol::NotifyInterfaceDown (uint32_t interface) {
+}
+
+void NextHopRoutingProtocol::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) {
+}
+
+void NextHopRoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) {
+}
+
+} // namespace ns3
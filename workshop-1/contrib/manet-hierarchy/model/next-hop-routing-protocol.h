@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef NEXT_HOP_ROUTING_PROTOCOL_H
+#define NEXT_HOP_ROUTING_PROTOCOL_H
+
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+
+namespace ns3 {
+
+/*
+ * Unicast routing that only differs in how it picks a next hop. Broadcasts
+ * stay on the interface they are addressed to, packets for the node itself
+ * loop back and arriving ones are delivered locally; everything else goes
+ * to the next hop Lookup returns. Multicast is not routed.
+ */
+class NextHopRoutingProtocol : public Ipv4RoutingProtocol {
+public:
+  static TypeId GetTypeId (void);
+  NextHopRoutingProtocol ();
+  virtual ~NextHopRoutingProtocol ();
+
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                              Socket::SocketErrno &sockerr) override;
+  bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                   UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                   LocalDeliverCallback lcb, ErrorCallback ecb) override;
+  void NotifyInterfaceUp (uint32_t interface) override;
+  void NotifyInterfaceDown (uint32_t interface) override;
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) override;
+  void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) override;
+  void SetIpv4 (Ptr<Ipv4> ipv4) override;
+
+protected:
+  void DoDispose (void) override;
+
+  // Next hop and interface towards dst, false without a route.
+  virtual bool Lookup (Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) = 0;
+  bool IsOwnAddress (Ipv4Address address) const;
+
+  Ptr<Ipv4> m_ipv4;
+
+private:
+  Ptr<Ipv4Route> MakeRoute (Ipv4Address dst, Ipv4Address nextHop, uint32_t interface) const;
+};
+
+} // namespace ns3
+
+#endif /* NEXT_HOP_ROUTING_PROTOCOL_H */
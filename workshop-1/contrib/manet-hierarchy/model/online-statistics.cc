@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "online-statistics.h"
+
+#include "ns3/abort.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+WelfordAccumulator::WelfordAccumulator ()
+  : m_count (0),
+    m_mean (0.0),
+    m_m2 (0.0)
+{
+}
+
+void WelfordAccumulator::Add (double x) {
+  m_count++;
+  double delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+}
+
+void WelfordAccumulator::Reset (void) {
+  m_count = 0;
+  m_mean = 0.0;
+  m_m2 = 0.0;
+}
+
+uint64_t WelfordAccumulator::GetCount (void) const {
+  return m_count;
+}
+
+double WelfordAccumulator::GetMean (void) const {
+  return m_mean;
+}
+
+double WelfordAccumulator::GetVariance (void) const {
+  return m_count > 1 ? m_m2 / (m_count - 1) : 0.0;
+}
+
+double WelfordAccumulator::GetStdDev (void) const {
+  return std::sqrt (GetVariance ());
+}
+
+BusyPeriodTracker::BusyPeriodTracker ()
+  : m_periods (0)
+{
+}
+
+void BusyPeriodTracker::Arrival (Time now, Time gap, Time service) {
+  Time end = now + service;
+  if (m_periods > 0 && now - m_last <= gap) {
+    if (end > m_end) {
+      m_busy += end - m_end;
+      m_end = end;
+    }
+  }
+  else {
+    if (m_periods == 0) {
+      m_first = now;
+    }
+    m_periods++;
+    m_busy += service;
+    m_end = end;
+  }
+  m_last = now;
+}
+
+Time BusyPeriodTracker::GetBusyTime (void) const {
+  return m_busy;
+}
+
+uint64_t BusyPeriodTracker::GetNPeriods (void) const {
+  return m_periods;
+}
+
+Time BusyPeriodTracker::GetFirstArrival (void) const {
+  return m_first;
+}
+
+BatchMeans::BatchMeans (uint32_t maxBatches, uint64_t batchSize)
+  : m_maxBatches (maxBatches),
+    m_batchSize (batchSize),
+    m_count (0),
+    m_sum (0.0),
+    m_fill (0)
+{
+  NS_ABORT_MSG_IF (maxBatches < 2 || maxBatches % 2 != 0, "Batch means need an even number of batches");
+  NS_ABORT_MSG_IF (batchSize == 0, "Batches need at least one sample");
+}
+
+void BatchMeans::Add (double x) {
+  m_count++;
+  m_sum += x;
+  if (++m_fill < m_batchSize) {
+    return;
+  }
+  m_batches.push_back (m_sum / m_batchSize);
+  m_sum = 0.0;
+  m_fill = 0;
+  if (m_batches.size () == m_maxBatches) {
+    for (uint32_t i = 0; i < m_maxBatches / 2; i++) {
+      m_batches[i] = (m_batches[2 * i] + m_batches[2 * i + 1]) / 2;
+    }
+    m_batches.resize (m_maxBatches / 2);
+    m_batchSize *= 2;
+  }
+}
+
+uint64_t BatchMeans::GetCount (void) const {
+  return m_count;
+}
+
+uint64_t BatchMeans::GetBatchSize (void) const {
+  return m_batchSize;
+}
+
+uint32_t BatchMeans::GetNBatches (void) const {
+  return m_batches.size ();
+}
+
+WelfordAccumulator BatchMeans::GetBatchStatistics (void) const {
+  WelfordAccumulator statistics;
+  for (std::size_t i = 0; i < m_batches.size (); i++) {
+    statistics.Add (m_batches[i]);
+  }
+  return statistics;
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ONLINE_STATISTICS_H
+#define ONLINE_STATISTICS_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Running mean and variance in one pass (Welford), without keeping the
+ * samples and without the cancellation of the sum-of-squares formula.
+ */
+class WelfordAccumulator {
+public:
+  WelfordAccumulator ();
+
+  void Add (double x);
+  void Reset (void);
+
+  uint64_t GetCount (void) const;
+  double GetMean (void) const;
+  // Sample variance, 0 below two samples.
+  double GetVariance (void) const;
+  double GetStdDev (void) const;
+
+private:
+  uint64_t m_count;
+  double m_mean;
+  double m_m2;      // sum of squared deviations from the running mean
+};
+
+/*
+ * Time a stream of arrivals keeps busy. Every arrival is busy for its own
+ * service time. An arrival within the gap of the previous one extends its
+ * busy period up to the end of its service; a later one starts a new
+ * period. With a gap longer than the run, the busy time is the time from
+ * the first arrival to the end of the last.
+ */
+class BusyPeriodTracker {
+public:
+  BusyPeriodTracker ();
+
+  void Arrival (Time now, Time gap, Time service);
+
+  Time GetBusyTime (void) const;
+  uint64_t GetNPeriods (void) const;
+  // Zero before the first arrival.
+  Time GetFirstArrival (void) const;
+
+private:
+  Time m_first;
+  Time m_last;
+  Time m_end;       // of the current period
+  Time m_busy;
+  uint64_t m_periods;
+};
+
+/*
+ * Means of consecutive batches of a correlated series, whose spread gives a
+ * confidence interval for the series mean. There are between half of and
+ * MaxBatches batches: when full, neighbouring batches are merged and the
+ * batch size doubles, so memory stays bounded and batches grow long enough
+ * to be nearly independent. The unfinished batch is left out.
+ */
+class BatchMeans {
+public:
+  // maxBatches must be even.
+  BatchMeans (uint32_t maxBatches = 40, uint64_t batchSize = 1);
+
+  void Add (double x);
+
+  uint64_t GetCount (void) const;
+  uint64_t GetBatchSize (void) const;
+  uint32_t GetNBatches (void) const;
+  // Over the finished batches.
+  WelfordAccumulator GetBatchStatistics (void) const;
+
+private:
+  uint32_t m_maxBatches;
+  uint64_t m_batchSize;
+  uint64_t m_count;
+  double m_sum;           // of the unfinished batch
+  uint64_t m_fill;
+  std::vector<double> m_batches;
+};
+
+} // namespace ns3
+
+#endif /* ONLINE_STATISTICS_H */
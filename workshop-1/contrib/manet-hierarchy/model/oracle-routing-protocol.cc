@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "oracle-routing-protocol.h"
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OracleRoutingProtocol");
+
+NS_OBJECT_ENSURE_REGISTERED (OracleRoutingProtocol);
+
+TypeId OracleRoutingProtocol::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::OracleRoutingProtocol")
+    .SetParent<NextHopRoutingProtocol> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<OracleRoutingProtocol> ()
+  ;
+  return tid;
+}
+
+OracleRoutingProtocol::OracleRoutingProtocol ()
+  : m_vertex (0)
+{
+}
+
+OracleRoutingProtocol::~OracleRoutingProtocol () {
+}
+
+void OracleRoutingProtocol::DoDispose (void) {
+  m_table = 0;
+  NextHopRoutingProtocol::DoDispose ();
+}
+
+void OracleRoutingProtocol::SetTable (Ptr<OracleRoutingTable> table, uint32_t vertex) {
+  m_table = table;
+  m_vertex = vertex;
+}
+
+bool OracleRoutingProtocol::Lookup (Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) {
+  return m_table != 0 && m_table->Lookup (m_vertex, dst, nextHop, interface);
+}
+
+void OracleRoutingProtocol::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const {
+  *stream->GetStream () << "Node " << m_ipv4->GetObject<Node> ()->GetId () << ", oracle vertex " << m_vertex
+                        << ", time " << Simulator::Now ().As (unit) << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,35 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ORACLE_ROUTING_PROTOCOL_H
+#define ORACLE_ROUTING_PROTOCOL_H
+
+#include "next-hop-routing-protocol.h"
+#include "oracle-routing-table.h"
+
+namespace ns3 {
+
+/*
+ * Per-node front end of an OracleRoutingTable: forwards along the table's
+ * shortest-hop routes and sends nothing of its own.
+ */
+class OracleRoutingProtocol : public NextHopRoutingProtocol {
+public:
+  static TypeId GetTypeId (void);
+  OracleRoutingProtocol ();
+  virtual ~OracleRoutingProtocol ();
+
+  // Shared table and the node's vertex in it.
+  void SetTable (Ptr<OracleRoutingTable> table, uint32_t vertex);
+
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override;
+
+private:
+  void DoDispose (void) override;
+  bool Lookup (Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) override;
+
+  Ptr<OracleRoutingTable> m_table;
+  uint32_t m_vertex;
+};
+
+} // namespace ns3
+
+#endif /* ORACLE_ROUTING_PROTOCOL_H */
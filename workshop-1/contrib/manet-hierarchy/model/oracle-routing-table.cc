@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "oracle-routing-table.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("OracleRoutingTable");
+
+NS_OBJECT_ENSURE_REGISTERED (OracleRoutingTable);
+
+static const uint16_t g_unreachable = 0xffff;
+static const uint32_t g_noParent = 0xffffffff;
+
+bool OracleRoutingTable::Link::operator< (const Link &other) const {
+  return neighbor < other.neighbor;
+}
+
+TypeId OracleRoutingTable::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::OracleRoutingTable")
+    .SetParent<Object> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<OracleRoutingTable> ()
+    .AddAttribute ("Interval",
+                   "Time between two recomputations of the routes.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&OracleRoutingTable::m_interval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+OracleRoutingTable::OracleRoutingTable ()
+  : m_n (0),
+    m_updates (0),
+    m_rebuilt (0)
+{
+}
+
+OracleRoutingTable::~OracleRoutingTable () {
+}
+
+void OracleRoutingTable::DoDispose (void) {
+  m_event.Cancel ();
+  m_store = 0;
+  Object::DoDispose ();
+}
+
+void OracleRoutingTable::SetMobilityStore (Ptr<MobilityStore> store) {
+  m_store = store;
+  m_n = store->GetN ();
+  m_attachments.assign (m_n, std::vector<Attachment> ());
+}
+
+void OracleRoutingTable::AddChannel (const std::vector<uint32_t> &vertices, const std::vector<uint32_t> &interfaces,
+                                     const std::vector<Ipv4Address> &addresses, double range) {
+  NS_ABORT_MSG_IF (m_store == 0, "Set the mobility store before adding channels");
+  NS_ABORT_MSG_IF (vertices.size () != interfaces.size () || vertices.size () != addresses.size (),
+                   "Every vertex of a channel needs an interface and an address");
+  Channel channel;
+  channel.vertices = vertices;
+  channel.range = range;
+  for (std::size_t i = 0; i < vertices.size (); i++) {
+    NS_ABORT_MSG_IF (vertices[i] >= m_n, "Vertex " << vertices[i] << " is not in the mobility store");
+    Attachment attachment;
+    attachment.channel = m_channels.size ();
+    attachment.interface = interfaces[i];
+    attachment.address = addresses[i];
+    m_attachments[vertices[i]].push_back (attachment);
+    m_addressVertex[addresses[i]] = vertices[i];
+  }
+  m_channels.push_back (channel);
+}
+
+void OracleRoutingTable::Start (void) {
+  NS_ABORT_MSG_IF (m_n >= g_unreachable, "Too many nodes for 16-bit hop counts");
+  m_event.Cancel ();
+  m_links.clear ();
+  m_dist.clear ();
+  m_parent.clear ();
+  m_event = Simulator::ScheduleNow (&OracleRoutingTable::Update, this);
+}
+
+void OracleRoutingTable::BuildLinks (std::vector<std::vector<Link> > &links) const {
+  const double *x = m_store->GetX ();
+  const double *y = m_store->GetY ();
+  const double *z = m_store->GetZ ();
+  links.assign (m_n, std::vector<Link> ());
+  for (uint32_t c = 0; c < m_channels.size (); c++) {
+    const std::vector<uint32_t> &vertices = m_channels[c].vertices;
+    double range2 = m_channels[c].range * m_channels[c].range;
+    for (std::size_t i = 0; i < vertices.size (); i++) {
+      uint32_t a = vertices[i];
+      for (std::size_t j = i + 1; j < vertices.size (); j++) {
+        uint32_t b = vertices[j];
+        double dx = x[a] - x[b];
+        double dy = y[a] - y[b];
+        double dz = z[a] - z[b];
+        if (dx * dx + dy * dy + dz * dz <= range2) {
+          Link link;
+          link.channel = c;
+          link.neighbor = b;
+          links[a].push_back (link);
+          link.neighbor = a;
+          links[b].push_back (link);
+        }
+      }
+    }
+  }
+
+  // One link per neighbor, over the channel with the fewest members
+  const std::vector<Channel> &channels = m_channels;
+  for (uint32_t v = 0; v < m_n; v++) {
+    std::sort (links[v].begin (), links[v].end (), [&channels] (const Link &a, const Link &b) {
+      if (a.neighbor != b.neighbor) {
+        return a.neighbor < b.neighbor;
+      }
+      return channels[a.channel].vertices.size () < channels[b.channel].vertices.size ();
+    });
+    links[v].erase (std::unique (links[v].begin (), links[v].end (), [] (const Link &a, const Link &b) {
+      return a.neighbor == b.neighbor;
+    }), links[v].end ());
+  }
+}
+
+void OracleRoutingTable::Update (void) {
+  m_store->Update ();
+  std::vector<std::vector<Link> > links;
+  BuildLinks (links);
+
+  bool full = m_dist.empty ();
+  if (full) {
+    m_dist.assign (static_cast<std::size_t> (m_n) * m_n, g_unreachable);
+    m_parent.assign (static_cast<std::size_t> (m_n) * m_n, g_noParent);
+  }
+
+  // Walk the old and new neighbor lists of every vertex side by side
+  std::vector<std::pair<uint32_t, uint32_t> > added;
+  std::vector<std::pair<uint32_t, uint32_t> > removed;
+  for (uint32_t u = 0; !full && u < m_n; u++) {
+    std::vector<Link>::const_iterator o = m_links[u].begin ();
+    std::vector<Link>::const_iterator n = links[u].begin ();
+    while (o != m_links[u].end () || n != links[u].end ()) {
+      if (n == links[u].end () || (o != m_links[u].end () && o->neighbor < n->neighbor)) {
+        if (u < o->neighbor) {
+          removed.push_back (std::make_pair (u, o->neighbor));
+        }
+        ++o;
+      }
+      else if (o == m_links[u].end () || n->neighbor < o->neighbor) {
+        if (u < n->neighbor) {
+          added.push_back (std::make_pair (u, n->neighbor));
+        }
+        ++n;
+      }
+      else {
+        ++o;
+        ++n;
+      }
+    }
+  }
+  m_links.swap (links);
+
+  for (uint32_t s = 0; s < m_n; s++) {
+    std::size_t row = static_cast<std::size_t> (s) * m_n;
+    bool dirty = full;
+    // Distances cannot drop over the surviving links, so they hold if every
+    // lost tree link has a replacement parent one hop closer to s
+    for (std::size_t e = 0; !dirty && e < removed.size (); e++) {
+      uint32_t u = removed[e].first;
+      uint32_t v = removed[e].second;
+      if (m_parent[row + v] == u) {
+        dirty = !Reparent (row, v);
+      }
+      else if (m_parent[row + u] == v) {
+        dirty = !Reparent (row, u);
+      }
+    }
+    if (dirty) {
+      Bfs (s);
+      m_rebuilt++;
+      continue;
+    }
+    for (std::size_t e = 0; e < added.size (); e++) {
+      Shorten (row, added[e].first, added[e].second);
+      Shorten (row, added[e].second, added[e].first);
+    }
+  }
+  m_updates++;
+  m_event = Simulator::Schedule (m_interval, &OracleRoutingTable::Update, this);
+}
+
+bool OracleRoutingTable::Reparent (std::size_t row, uint32_t v) {
+  uint16_t closer = m_dist[row + v] - 1;
+  for (std::vector<Link>::const_iterator l = m_links[v].begin (); l != m_links[v].end (); ++l) {
+    if (m_dist[row + l->neighbor] == closer) {
+      m_parent[row + v] = l->neighbor;
+      return true;
+    }
+  }
+  return false;
+}
+
+void OracleRoutingTable::Shorten (std::size_t row, uint32_t from, uint32_t to) {
+  if (m_dist[row + from] == g_unreachable || m_dist[row + from] + 1 >= m_dist[row + to]) {
+    return;
+  }
+  m_dist[row + to] = m_dist[row + from] + 1;
+  m_parent[row + to] = from;
+  m_queue.clear ();
+  m_queue.push_back (to);
+  for (std::size_t head = 0; head < m_queue.size (); head++) {
+    uint32_t u = m_queue[head];
+    uint16_t next = m_dist[row + u] + 1;
+    for (std::vector<Link>::const_iterator l = m_links[u].begin (); l != m_links[u].end (); ++l) {
+      if (m_dist[row + l->neighbor] > next) {
+        m_dist[row + l->neighbor] = next;
+        m_parent[row + l->neighbor] = u;
+        m_queue.push_back (l->neighbor);
+      }
+    }
+  }
+}
+
+void OracleRoutingTable::Bfs (uint32_t source) {
+  std::size_t row = static_cast<std::size_t> (source) * m_n;
+  std::fill (m_dist.begin () + row, m_dist.begin () + row + m_n, g_unreachable);
+  std::fill (m_parent.begin () + row, m_parent.begin () + row + m_n, g_noParent);
+  m_dist[row + source] = 0;
+  m_queue.clear ();
+  m_queue.push_back (source);
+  for (std::size_t head = 0; head < m_queue.size (); head++) {
+    uint32_t u = m_queue[head];
+    uint16_t next = m_dist[row + u] + 1;
+    for (std::vector<Link>::const_iterator l = m_links[u].begin (); l != m_links[u].end (); ++l) {
+      if (m_dist[row + l->neighbor] == g_unreachable) {
+        m_dist[row + l->neighbor] = next;
+        m_parent[row + l->neighbor] = u;
+        m_queue.push_back (l->neighbor);
+      }
+    }
+  }
+}
+
+bool OracleRoutingTable::Lookup (uint32_t from, Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) const {
+  std::map<Ipv4Address, uint32_t>::const_iterator it = m_addressVertex.find (dst);
+  if (it == m_addressVertex.end () || m_dist.empty ()) {
+    return false;
+  }
+  std::size_t row = static_cast<std::size_t> (from) * m_n;
+  uint32_t hop = it->second;
+  if (hop == from || m_dist[row + hop] == g_unreachable) {
+    return false;
+  }
+  while (m_parent[row + hop] != from) {
+    hop = m_parent[row + hop];
+  }
+
+  Link key;
+  key.neighbor = hop;
+  std::vector<Link>::const_iterator link = std::lower_bound (m_links[from].begin (), m_links[from].end (), key);
+  NS_ASSERT (link != m_links[from].end () && link->neighbor == hop);
+  bool haveInterface = false;
+  for (std::size_t a = 0; a < m_attachments[from].size (); a++) {
+    if (m_attachments[from][a].channel == link->channel) {
+      interface = m_attachments[from][a].interface;
+      haveInterface = true;
+    }
+  }
+  for (std::size_t a = 0; a < m_attachments[hop].size (); a++) {
+    if (m_attachments[hop][a].channel == link->channel) {
+      nextHop = m_attachments[hop][a].address;
+      return haveInterface;
+    }
+  }
+  return false;
+}
+
+uint16_t OracleRoutingTable::GetDistance (uint32_t from, uint32_t to) const {
+  if (m_dist.empty ()) {
+    return g_unreachable;
+  }
+  return m_dist[static_cast<std::size_t> (from) * m_n + to];
+}
+
+uint64_t OracleRoutingTable::GetNUpdates (void) const {
+  return m_updates;
+}
+
+uint64_t OracleRoutingTable::GetNRebuilt (void) const {
+  return m_rebuilt;
+}
+
+} // namespace ns3
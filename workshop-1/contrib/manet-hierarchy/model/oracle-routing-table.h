@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef ORACLE_ROUTING_TABLE_H
+#define ORACLE_ROUTING_TABLE_H
+
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "mobility-store.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Shortest-hop routes between all nodes, computed from their true positions
+ * rather than learned over the air. Vertices are the nodes of a
+ * MobilityStore; two vertices are linked when they share a channel and are
+ * within that channel's range.
+ *
+ * Every Interval the links are rebuilt and compared with the previous ones.
+ * A lost link only matters to the BFS trees that use it; the cut-off node is
+ * reattached to another neighbor one hop closer to the source if it has one,
+ * and the tree is rebuilt otherwise. A new link then lowers the distances
+ * behind it where it is a shortcut, which is propagated from its far end.
+ * Distances and BFS parents take 6 bytes per node pair.
+ */
+class OracleRoutingTable : public Object {
+public:
+  static TypeId GetTypeId (void);
+  OracleRoutingTable ();
+  virtual ~OracleRoutingTable ();
+
+  void SetMobilityStore (Ptr<MobilityStore> store);
+  // Vertices are MobilityStore indices; interfaces and addresses are those
+  // of each vertex on the channel.
+  void AddChannel (const std::vector<uint32_t> &vertices, const std::vector<uint32_t> &interfaces,
+                   const std::vector<Ipv4Address> &addresses, double range);
+  // Computes the routes at the current time and then every Interval.
+  void Start (void);
+
+  // Next hop and interface from a vertex towards dst, false without a route.
+  bool Lookup (uint32_t from, Ipv4Address dst, Ipv4Address &nextHop, uint32_t &interface) const;
+  // Hops between two vertices, 0xffff without a route.
+  uint16_t GetDistance (uint32_t from, uint32_t to) const;
+
+  uint64_t GetNUpdates (void) const;
+  // BFS trees rebuilt over all updates; a full recomputation is one per node.
+  uint64_t GetNRebuilt (void) const;
+
+private:
+  struct Channel {
+    std::vector<uint32_t> vertices;
+    double range;
+  };
+
+  struct Attachment {
+    uint32_t channel;
+    uint32_t interface;
+    Ipv4Address address;
+  };
+
+  // Neighbor and the channel used to reach it
+  struct Link {
+    uint32_t neighbor;
+    uint32_t channel;
+
+    bool operator< (const Link &other) const;
+  };
+
+  void DoDispose (void) override;
+  void Update (void);
+  void BuildLinks (std::vector<std::vector<Link> > &links) const;
+  void Bfs (uint32_t source);
+  // Points v at another neighbor one hop closer to the row's source.
+  bool Reparent (std::size_t row, uint32_t v);
+  // Lowers the distances behind a new link from -> to, if it is a shortcut.
+  void Shorten (std::size_t row, uint32_t from, uint32_t to);
+
+  Ptr<MobilityStore> m_store;
+  Time m_interval;
+  std::vector<Channel> m_channels;
+  std::vector<std::vector<Attachment> > m_attachments;   // by vertex
+  std::map<Ipv4Address, uint32_t> m_addressVertex;
+
+  uint32_t m_n;
+  std::vector<std::vector<Link> > m_links;   // by vertex, sorted by neighbor
+  std::vector<uint16_t> m_dist;              // m_n x m_n, row per source
+  std::vector<uint32_t> m_parent;            // BFS parent in the source's tree
+  std::vector<uint32_t> m_queue;
+  EventId m_event;
+  uint64_t m_updates;
+  uint64_t m_rebuilt;
+};
+
+} // namespace ns3
+
+#endif /* ORACLE_ROUTING_TABLE_H */
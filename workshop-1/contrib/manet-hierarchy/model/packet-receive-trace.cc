@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "packet-receive-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/ipv4-address.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+namespace ns3 {
+
+static const char g_magic[4] = {'P', 'R', 'X', 'T'};
+static const uint32_t g_version = 1;
+
+PacketReceiveTrace::PacketReceiveTrace (uint32_t capacity)
+  : m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_file (0)
+{
+  uint64_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  m_ring.resize (size);
+  m_mask = size - 1;
+}
+
+PacketReceiveTrace::~PacketReceiveTrace () {
+  Close ();
+}
+
+void PacketReceiveTrace::Open (const std::string &fileName, bool append) {
+  Close ();
+  m_file = std::fopen (fileName.c_str (), append ? "ab" : "wb");
+  NS_ABORT_MSG_IF (m_file == 0, "Cannot open receive trace " << fileName);
+  if (!append) {
+    uint32_t recordSize = sizeof (Record);
+    std::fwrite (g_magic, 1, sizeof (g_magic), m_file);
+    std::fwrite (&g_version, sizeof (g_version), 1, m_file);
+    std::fwrite (&recordSize, sizeof (recordSize), 1, m_file);
+  }
+  m_head.store (0);
+  m_tail.store (0);
+  m_stop = false;
+  m_writer = std::thread (&PacketReceiveTrace::WriterLoop, this);
+}
+
+void PacketReceiveTrace::Close (void) {
+  if (m_file == 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_one ();
+  m_writer.join ();
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+bool PacketReceiveTrace::IsOpen (void) const {
+  return m_file != 0;
+}
+
+uint64_t PacketReceiveTrace::GetRecords (void) const {
+  return m_head.load (std::memory_order_relaxed);
+}
+
+void PacketReceiveTrace::Write (double time, uint64_t uid, uint32_t node, bool hasSender, uint32_t sender, uint32_t size) {
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  uint64_t capacity = m_mask + 1;
+  if (head - m_tail.load (std::memory_order_acquire) == capacity) {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_wake.notify_one ();
+    m_space.wait (lock, [&] { return head - m_tail.load (std::memory_order_acquire) < capacity; });
+  }
+  Record &record = m_ring[head & m_mask];
+  record.time = time;
+  record.uid = uid;
+  record.node = node;
+  record.sender = sender;
+  record.size = size;
+  record.flags = hasSender ? HAS_SENDER : 0;
+  m_head.store (head + 1, std::memory_order_release);
+  if (head + 1 - m_tail.load (std::memory_order_relaxed) == capacity / 2) {
+    m_wake.notify_one ();
+  }
+}
+
+void PacketReceiveTrace::WriterLoop (void) {
+  for (;;) {
+    uint64_t tail = m_tail.load (std::memory_order_relaxed);
+    uint64_t head = m_head.load (std::memory_order_acquire);
+    if (head == tail) {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      if (m_stop && m_head.load (std::memory_order_acquire) == tail) {
+        break;
+      }
+      // Timed, as the producer notifies without taking the lock
+      m_wake.wait_for (lock, std::chrono::milliseconds (50));
+      continue;
+    }
+    // Up to two contiguous pieces of the ring
+    while (tail != head) {
+      uint64_t begin = tail & m_mask;
+      uint64_t count = std::min (head - tail, m_mask + 1 - begin);
+      std::fwrite (&m_ring[begin], sizeof (Record), count, m_file);
+      tail += count;
+    }
+    {
+      std::lock_guard<std::mutex> lock (m_mutex);
+      m_tail.store (tail, std::memory_order_release);
+    }
+    m_space.notify_one ();
+  }
+  std::fflush (m_file);
+}
+
+uint64_t PacketReceiveTrace::Decode (std::istream &in, std::ostream &out) {
+  char magic[4];
+  uint32_t version;
+  uint32_t recordSize;
+  in.read (magic, sizeof (magic));
+  in.read (reinterpret_cast<char *> (&version), sizeof (version));
+  in.read (reinterpret_cast<char *> (&recordSize), sizeof (recordSize));
+  NS_ABORT_MSG_IF (!in || std::memcmp (magic, g_magic, sizeof (magic)) != 0, "Not a packet receive trace");
+  NS_ABORT_MSG_IF (version != g_version || recordSize != sizeof (Record),
+                   "Receive trace version " << version << " with " << recordSize << "-byte records is not supported");
+
+  out << std::setprecision (10);
+  Record record;
+  uint64_t n = 0;
+  while (in.read (reinterpret_cast<char *> (&record), sizeof (record))) {
+    out << "Tiempo recibido: " << record.time << " Id paquete: " << record.uid << " " << record.node;
+    if (record.flags & HAS_SENDER) {
+      out << " received one packet from " << Ipv4Address (record.sender);
+    }
+    else {
+      out << " received one packet!";
+    }
+    out << std::endl;
+    n++;
+  }
+  return n;
+}
+
+} // namespace ns3
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PACKET_RECEIVE_TRACE_H
+#define PACKET_RECEIVE_TRACE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Fixed-size binary record per received packet, written from the simulation
+ * thread into a preallocated ring and drained to a file by a writer thread.
+ * Write never allocates or formats; it only blocks when the writer is a full
+ * ring behind. Records are in host byte order after a small header.
+ *
+ * Threads do not survive fork (), so Close () before forking and Open () a
+ * file of its own in every child.
+ */
+class PacketReceiveTrace {
+public:
+  struct Record {
+    double time;        // Simulator::Now ().GetSeconds ()
+    uint64_t uid;
+    uint32_t node;
+    uint32_t sender;    // IPv4 address, when flags has HAS_SENDER
+    uint32_t size;
+    uint32_t flags;
+  };
+  enum Flags {
+    HAS_SENDER = 1
+  };
+
+  // Capacity in records, rounded up to a power of two.
+  explicit PacketReceiveTrace (uint32_t capacity = 1 << 16);
+  ~PacketReceiveTrace ();
+
+  // With append the file must already hold a trace, e.g. a copied warm-up.
+  void Open (const std::string &fileName, bool append = false);
+  // Drains the ring, stops the writer and closes the file.
+  void Close (void);
+  bool IsOpen (void) const;
+
+  void Write (double time, uint64_t uid, uint32_t node, bool hasSender, uint32_t sender, uint32_t size);
+  uint64_t GetRecords (void) const;
+
+  // Prints the "Tiempo recibido" line RoutingExperiment logs for each record.
+  // Returns the number of records read.
+  static uint64_t Decode (std::istream &in, std::ostream &out);
+
+private:
+  void WriterLoop (void);
+
+  std::vector<Record> m_ring;
+  uint64_t m_mask;
+  std::atomic<uint64_t> m_head;    // next record to fill
+  std::atomic<uint64_t> m_tail;    // next record to write out
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_space;
+  bool m_stop;
+  std::thread m_writer;
+  std::FILE *m_file;
+};
+
+} // namespace ns3
+
+#endif /* PACKET_RECEIVE_TRACE_H */
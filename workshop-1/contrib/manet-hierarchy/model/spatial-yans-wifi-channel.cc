@@ -0,0 +1,441 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "spatial-yans-wifi-channel.h"
+#include "cached-propagation-loss-model.h"
+
+#include "ns3/boolean.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialYansWifiChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (SpatialYansWifiChannel);
+
+TypeId SpatialYansWifiChannel::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::SpatialYansWifiChannel")
+    .SetParent<YansWifiChannel> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<SpatialYansWifiChannel> ()
+    .AddAttribute ("MaxRange",
+                   "Distance in m beyond which no reception is scheduled. "
+                   "0 derives it from the loss model and the PHY sensitivities.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&SpatialYansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("CellSize",
+                   "Grid cell size in m, 0 uses the reception range.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&SpatialYansWifiChannel::m_cellSize),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Culling",
+                   "Skip PHYs outside the reception range. When off every PHY "
+                   "is a candidate, which still lets the batch path run.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&SpatialYansWifiChannel::m_culling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BatchRxPower",
+                   "Evaluate Friis loss and constant-speed delay for all "
+                   "receivers of a transmission in one batch.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&SpatialYansWifiChannel::m_batch),
+                   MakeBooleanChecker ())
+    .AddAttribute ("VerifyBatch",
+                   "Compare every batched result with the per-pair models, "
+                   "to 1e-6 dB and 1 ns with a MobilityStore.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&SpatialYansWifiChannel::m_verifyBatch),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+SpatialYansWifiChannel::SpatialYansWifiChannel ()
+  : m_maxRange (0.0),
+    m_cellSize (0.0),
+    m_culling (true),
+    m_batch (true),
+    m_verifyBatch (false),
+    m_minRxMarginDbm (0.0),
+    m_minX (0), m_maxX (-1), m_minY (0), m_maxY (-1),
+    m_maxSpeed (0.0),
+    m_binned (false),
+    m_batchable (false),
+    m_delaySpeed (0.0),
+    m_scheduled (0),
+    m_culled (0),
+    m_batched (0),
+    m_mismatches (0)
+{
+}
+
+SpatialYansWifiChannel::~SpatialYansWifiChannel () {
+}
+
+void SpatialYansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss) {
+  YansWifiChannel::SetPropagationLossModel (loss);
+  m_loss = loss;
+  m_rangeCache.clear ();
+  UpdateBatchable ();
+}
+
+void SpatialYansWifiChannel::SetPropagationDelayModel (const Ptr<PropagationDelayModel> delay) {
+  YansWifiChannel::SetPropagationDelayModel (delay);
+  m_delay = delay;
+  UpdateBatchable ();
+}
+
+void SpatialYansWifiChannel::UpdateBatchable (void) {
+  Ptr<ConstantSpeedPropagationDelayModel> speed = DynamicCast<ConstantSpeedPropagationDelayModel> (m_delay);
+  m_batchable = FriisBatchKernel::IsBatchable (m_loss)
+    && speed != 0
+    && speed->GetInstanceTypeId () == ConstantSpeedPropagationDelayModel::GetTypeId ();
+  if (m_batchable) {
+    m_kernel.Configure (m_loss);
+    m_delaySpeed = speed->GetSpeed ();
+  }
+}
+
+uint64_t SpatialYansWifiChannel::GetScheduledReceptions (void) const {
+  return m_scheduled;
+}
+
+uint64_t SpatialYansWifiChannel::GetCulledReceptions (void) const {
+  return m_culled;
+}
+
+uint64_t SpatialYansWifiChannel::GetBatchedReceptions (void) const {
+  return m_batched;
+}
+
+uint64_t SpatialYansWifiChannel::GetBatchMismatches (void) const {
+  return m_mismatches;
+}
+
+void SpatialYansWifiChannel::SetMobilityStore (Ptr<MobilityStore> store) {
+  m_store = store;
+  m_storeIndex.clear ();
+}
+
+void SpatialYansWifiChannel::Sync (void) {
+  if (m_phys.size () == GetNDevices () && (m_store == 0 || m_storeIndex.size () == m_phys.size ())) {
+    return;
+  }
+  // PHYs register through the non-virtual YansWifiChannel::Add, so pick up
+  // the ones added since the last transmission from the device list.
+  for (std::size_t i = m_phys.size (); i < GetNDevices (); i++) {
+    Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (GetDevice (i));
+    Ptr<YansWifiPhy> phy = DynamicCast<YansWifiPhy> (device->GetPhy ());
+    Ptr<MobilityModel> mobility = phy->GetMobility ();
+    NS_ASSERT_MSG (mobility != 0, "SpatialYansWifiChannel needs a mobility model on every node");
+    m_phyOfMobility[PeekPointer (mobility)] = m_phys.size ();
+    m_phyIndex[PeekPointer (phy)] = m_phys.size ();
+    mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&SpatialYansWifiChannel::CourseChanged, this));
+    m_phys.push_back (phy);
+  }
+  if (m_store != 0) {
+    m_storeIndex.resize (m_phys.size ());
+    for (uint32_t i = 0; i < m_phys.size (); i++) {
+      m_storeIndex[i] = m_store->GetIndex (m_phys[i]->GetMobility ());
+    }
+  }
+  m_minRxMarginDbm = std::numeric_limits<double>::max ();
+  for (std::vector<Ptr<YansWifiPhy> >::const_iterator i = m_phys.begin (); i != m_phys.end (); ++i) {
+    m_minRxMarginDbm = std::min (m_minRxMarginDbm, (*i)->GetRxSensitivity () - (*i)->GetRxGain ());
+  }
+  m_rangeCache.clear ();
+  m_cellOf.assign (m_phys.size (), 0);
+  m_grid.clear ();
+  m_binned = false;
+}
+
+double SpatialYansWifiChannel::GetRange (double txPowerDbm) {
+  if (m_maxRange > 0) {
+    return m_maxRange;
+  }
+  std::map<double, double>::const_iterator cached = m_rangeCache.find (txPowerDbm);
+  if (cached != m_rangeCache.end ()) {
+    return cached->second;
+  }
+  // Largest distance at which the loss still leaves the signal above the
+  // least sensitive margin; the loss is assumed to grow with distance.
+  Ptr<CachedPropagationLossModel> cache = DynamicCast<CachedPropagationLossModel> (m_loss);
+  if (cache != 0) {
+    cache->SetProbing (true);
+  }
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0.0, 0.0, 0.0));
+  double lo = 0.0;
+  double hi = 1.0;
+  b->SetPosition (Vector (hi, 0.0, 0.0));
+  while (m_loss->CalcRxPower (txPowerDbm, a, b) >= m_minRxMarginDbm && hi < 1e7) {
+    lo = hi;
+    hi *= 2;
+    b->SetPosition (Vector (hi, 0.0, 0.0));
+  }
+  for (int i = 0; i < 64 && hi - lo > 1e-3; i++) {
+    double mid = (lo + hi) / 2;
+    b->SetPosition (Vector (mid, 0.0, 0.0));
+    if (m_loss->CalcRxPower (txPowerDbm, a, b) >= m_minRxMarginDbm) {
+      lo = mid;
+    }
+    else {
+      hi = mid;
+    }
+  }
+  if (cache != 0) {
+    cache->SetProbing (false);
+  }
+  NS_LOG_INFO ("Reception range at " << txPowerDbm << " dBm is " << hi << " m");
+  m_rangeCache[txPowerDbm] = hi;
+  return hi;
+}
+
+int64_t SpatialYansWifiChannel::CellKey (int64_t ix, int64_t iy) const {
+  return static_cast<int64_t> ((static_cast<uint64_t> (ix) << 32) ^ (static_cast<uint64_t> (iy) & 0xffffffff));
+}
+
+int64_t SpatialYansWifiChannel::CellIndex (double coordinate) const {
+  return static_cast<int64_t> (std::floor (coordinate / m_cellSize));
+}
+
+void SpatialYansWifiChannel::Bin (uint32_t phy, const Vector &position) {
+  int64_t ix = CellIndex (position.x);
+  int64_t iy = CellIndex (position.y);
+  int64_t key = CellKey (ix, iy);
+  m_cellOf[phy] = key;
+  m_grid[key].push_back (phy);
+  if (m_minX > m_maxX) {
+    m_minX = m_maxX = ix;
+    m_minY = m_maxY = iy;
+  }
+  m_minX = std::min (m_minX, ix);
+  m_maxX = std::max (m_maxX, ix);
+  m_minY = std::min (m_minY, iy);
+  m_maxY = std::max (m_maxY, iy);
+}
+
+void SpatialYansWifiChannel::Rebin (void) {
+  for (std::unordered_map<int64_t, std::vector<uint32_t> >::iterator i = m_grid.begin (); i != m_grid.end (); ++i) {
+    i->second.clear ();
+  }
+  m_minX = 0;
+  m_maxX = -1;
+  m_maxSpeed = 0.0;
+  if (m_store != 0) {
+    m_store->Update ();
+    for (uint32_t i = 0; i < m_phys.size (); i++) {
+      uint32_t j = m_storeIndex[i];
+      Bin (i, Vector (m_store->GetX ()[j], m_store->GetY ()[j], m_store->GetZ ()[j]));
+    }
+    m_maxSpeed = m_store->GetMaxSpeed ();
+    m_lastRebin = Simulator::Now ();
+    m_binned = true;
+    return;
+  }
+  for (uint32_t i = 0; i < m_phys.size (); i++) {
+    Ptr<MobilityModel> mobility = m_phys[i]->GetMobility ();
+    Bin (i, mobility->GetPosition ());
+    Vector v = mobility->GetVelocity ();
+    m_maxSpeed = std::max (m_maxSpeed, std::sqrt (v.x * v.x + v.y * v.y + v.z * v.z));
+  }
+  m_lastRebin = Simulator::Now ();
+  m_binned = true;
+}
+
+void SpatialYansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) {
+  if (!m_binned) {
+    return;
+  }
+  std::map<const MobilityModel *, uint32_t>::const_iterator it = m_phyOfMobility.find (PeekPointer (mobility));
+  if (it == m_phyOfMobility.end ()) {
+    return;
+  }
+  uint32_t phy = it->second;
+  std::vector<uint32_t> &cell = m_grid[m_cellOf[phy]];
+  std::vector<uint32_t>::iterator pos = std::find (cell.begin (), cell.end (), phy);
+  if (pos != cell.end ()) {
+    *pos = cell.back ();
+    cell.pop_back ();
+  }
+  Bin (phy, mobility->GetPosition ());
+  Vector v = mobility->GetVelocity ();
+  m_maxSpeed = std::max (m_maxSpeed, std::sqrt (v.x * v.x + v.y * v.y + v.z * v.z));
+}
+
+void SpatialYansWifiChannel::CollectCandidates (const Vector &p, double reach) {
+  m_candidates.clear ();
+  if (!m_culling) {
+    for (uint32_t i = 0; i < m_phys.size (); i++) {
+      m_candidates.push_back (i);
+    }
+    return;
+  }
+  int64_t x0 = std::max (m_minX, CellIndex (p.x - reach));
+  int64_t x1 = std::min (m_maxX, CellIndex (p.x + reach));
+  int64_t y0 = std::max (m_minY, CellIndex (p.y - reach));
+  int64_t y1 = std::min (m_maxY, CellIndex (p.y + reach));
+  if (x0 == m_minX && x1 == m_maxX && y0 == m_minY && y1 == m_maxY) {
+    for (uint32_t i = 0; i < m_phys.size (); i++) {
+      m_candidates.push_back (i);
+    }
+    return;
+  }
+  for (int64_t ix = x0; ix <= x1; ix++) {
+    for (int64_t iy = y0; iy <= y1; iy++) {
+      std::unordered_map<int64_t, std::vector<uint32_t> >::const_iterator cell = m_grid.find (CellKey (ix, iy));
+      if (cell != m_grid.end ()) {
+        m_candidates.insert (m_candidates.end (), cell->second.begin (), cell->second.end ());
+      }
+    }
+  }
+  // Schedule in PHY order, like the stock channel
+  std::sort (m_candidates.begin (), m_candidates.end ());
+}
+
+// The stock YansWifiChannel path, positions included. Store positions only
+// agree with the models' to rounding, so those results get a tolerance.
+void SpatialYansWifiChannel::Verify (Ptr<MobilityModel> sender, double txPowerDbm) {
+  double powerTolerance = m_store != 0 ? 1e-6 : 0.0;
+  Time delayTolerance = m_store != 0 ? NanoSeconds (1) : Time ();
+  Ptr<CachedPropagationLossModel> cache = DynamicCast<CachedPropagationLossModel> (m_loss);
+  if (cache != 0) {
+    cache->SetProbing (true);
+  }
+  for (std::size_t k = 0; k < m_rx.size (); k++) {
+    Ptr<MobilityModel> receiver = m_phys[m_rx[k]]->GetMobility ();
+    double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, sender, receiver);
+    Time delay = m_delay->GetDelay (sender, receiver);
+    if (std::abs (rxPowerDbm - m_rxPowerDbm[k]) > powerTolerance
+        || Abs (delay - Seconds (m_rxDistance[k] / m_delaySpeed)) > delayTolerance) {
+      NS_LOG_WARN ("Batched reception of PHY " << m_rx[k] << " differs: " << m_rxPowerDbm[k]
+                   << " dBm against " << rxPowerDbm << " dBm per pair");
+      m_mismatches++;
+    }
+  }
+  if (cache != 0) {
+    cache->SetProbing (false);
+  }
+}
+
+void SpatialYansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) {
+  Sync ();
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ();
+  NS_ASSERT (senderMobility != 0);
+
+  double reach = 0.0;
+  if (m_culling) {
+    double range = GetRange (txPowerDbm);
+    if (!m_binned) {
+      if (m_cellSize <= 0) {
+        m_cellSize = range;
+      }
+      Rebin ();
+    }
+    // A node binned at or after the last re-bin has drifted at most this far
+    double drift = m_maxSpeed * (Simulator::Now () - m_lastRebin).GetSeconds ();
+    if (drift > m_cellSize / 2) {
+      Rebin ();
+      drift = 0.0;
+    }
+    reach = range + drift;
+  }
+
+  // Only the sender and the receivers left after culling are evaluated
+  Vector p;
+  if (m_store != 0) {
+    p = m_store->GetPosition (m_storeIndex[m_phyIndex[PeekPointer (sender)]]);
+  }
+  else {
+    p = senderMobility->GetPosition ();
+  }
+  CollectCandidates (p, reach);
+  m_culled += m_phys.size () - m_candidates.size ();
+
+  m_rx.clear ();
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); ++i) {
+    Ptr<YansWifiPhy> receiver = m_phys[*i];
+    if (receiver == sender || receiver->GetChannelNumber () != sender->GetChannelNumber ()) {
+      continue;
+    }
+    m_rx.push_back (*i);
+  }
+
+  std::size_t n = m_rx.size ();
+  bool batch = m_batch && m_batchable;
+  m_rxPowerDbm.resize (n);
+  m_rxDistance.resize (n);
+  if (batch) {
+    m_rxX.resize (n);
+    m_rxY.resize (n);
+    m_rxZ.resize (n);
+    if (m_store != 0) {
+      for (std::size_t k = 0; k < n; k++) {
+        Vector q = m_store->GetPosition (m_storeIndex[m_rx[k]]);
+        m_rxX[k] = q.x;
+        m_rxY[k] = q.y;
+        m_rxZ[k] = q.z;
+      }
+    }
+    else {
+      for (std::size_t k = 0; k < n; k++) {
+        Vector q = m_phys[m_rx[k]]->GetMobility ()->GetPosition ();
+        m_rxX[k] = q.x;
+        m_rxY[k] = q.y;
+        m_rxZ[k] = q.z;
+      }
+    }
+    m_kernel.Compute (p, txPowerDbm, n, m_rxX.data (), m_rxY.data (), m_rxZ.data (), m_rxDistance.data (), m_rxPowerDbm.data ());
+    m_batched += n;
+    if (m_verifyBatch) {
+      Verify (senderMobility, txPowerDbm);
+    }
+  }
+  else {
+    for (std::size_t k = 0; k < n; k++) {
+      m_rxPowerDbm[k] = m_loss->CalcRxPower (txPowerDbm, senderMobility, m_phys[m_rx[k]]->GetMobility ());
+    }
+  }
+
+  for (std::size_t k = 0; k < n; k++) {
+    Ptr<YansWifiPhy> receiver = m_phys[m_rx[k]];
+    double rxPowerDbm = m_rxPowerDbm[k];
+    if (rxPowerDbm + receiver->GetRxGain () < receiver->GetRxSensitivity ()) {
+      m_culled++;
+      continue;
+    }
+    Time delay = batch ? Seconds (m_rxDistance[k] / m_delaySpeed)
+      : m_delay->GetDelay (senderMobility, receiver->GetMobility ());
+    Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+    uint32_t dstNode = dstNetDevice == 0 ? 0xffffffff : dstNetDevice->GetNode ()->GetId ();
+    Ptr<WifiPpdu> copy = ppdu->Copy ();
+    Simulator::ScheduleWithContext (dstNode, delay, &SpatialYansWifiChannel::Receive, receiver, copy, rxPowerDbm);
+    m_scheduled++;
+  }
+}
+
+void SpatialYansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPowerDbm) {
+  // Same as the private YansWifiChannel::Receive
+  if ((rxPowerDbm + phy->GetRxGain ()) < phy->GetRxSensitivity ()) {
+    return;
+  }
+  RxPowerWattPerChannelBand rxPowerW;
+  rxPowerW.insert ({std::make_pair (0, 0), (DbmToW (rxPowerDbm + phy->GetRxGain ()))}); //dummy band for YANS
+  phy->StartReceivePreamble (ppdu, rxPowerW, ppdu->GetTxDuration ());
+}
+
+} // namespace ns3
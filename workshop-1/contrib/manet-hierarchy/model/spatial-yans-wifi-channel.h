@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SPATIAL_YANS_WIFI_CHANNEL_H
+#define SPATIAL_YANS_WIFI_CHANNEL_H
+
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "friis-batch-kernel.h"
+#include "mobility-store.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class YansWifiPhy;
+class WifiPpdu;
+class PropagationLossModel;
+class PropagationDelayModel;
+
+/*
+ * YansWifiChannel that keeps its PHYs in a uniform grid and only schedules a
+ * reception for PHYs whose received power can reach their RxSensitivity, the
+ * point below which YansWifiChannel::Receive drops the signal anyway. Results
+ * are the same as the stock channel for deterministic, distance-monotone loss
+ * models such as Friis; for anything else set MaxRange explicitly.
+ *
+ * Cells are refreshed when a node changes course and on a full re-bin once the
+ * fastest node could have drifted half a cell since the last one. Only
+ * SpatialYansWifiPhy transmits through the culled path.
+ *
+ * With a lone Friis loss and a constant-speed delay, the receivers left after
+ * culling are evaluated together by FriisBatchKernel instead of one virtual
+ * CalcRxPower and GetDelay call each. VerifyBatch re-runs the stock per-pair
+ * path, CalcRxPower and GetDelay on the PHYs' own mobility models, for every
+ * batch and counts results that differ in any bit. With a MobilityStore the
+ * positions of the sender and the remaining receivers come from its leg
+ * arrays rather than from one virtual GetPosition call per PHY and frame;
+ * the rest of the store is only evaluated on a re-bin. They match the
+ * models' to rounding, so VerifyBatch then allows 1e-6 dB and 1 ns.
+ */
+class SpatialYansWifiChannel : public YansWifiChannel {
+public:
+  static TypeId GetTypeId (void);
+  SpatialYansWifiChannel ();
+  virtual ~SpatialYansWifiChannel ();
+
+  // Hide the base setters, which give no access to the models afterwards.
+  void SetPropagationLossModel (const Ptr<PropagationLossModel> loss);
+  void SetPropagationDelayModel (const Ptr<PropagationDelayModel> delay);
+
+  // Store holding the mobility model of every PHY on this channel.
+  void SetMobilityStore (Ptr<MobilityStore> store);
+
+  void Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm);
+
+  uint64_t GetScheduledReceptions (void) const;
+  uint64_t GetCulledReceptions (void) const;
+  uint64_t GetBatchedReceptions (void) const;
+  uint64_t GetBatchMismatches (void) const;
+
+private:
+  static void Receive (Ptr<YansWifiPhy> phy, Ptr<WifiPpdu> ppdu, double rxPowerDbm);
+
+  void Sync (void);
+  void Rebin (void);
+  void Bin (uint32_t phy, const Vector &position);
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  double GetRange (double txPowerDbm);
+  int64_t CellKey (int64_t ix, int64_t iy) const;
+  int64_t CellIndex (double coordinate) const;
+  void CollectCandidates (const Vector &p, double reach);
+  void UpdateBatchable (void);
+  void Verify (Ptr<MobilityModel> sender, double txPowerDbm);
+
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+  double m_maxRange;            // attribute, 0 derives it from m_loss
+  double m_cellSize;
+  bool m_culling;
+  bool m_batch;
+  bool m_verifyBatch;
+
+  std::vector<Ptr<YansWifiPhy> > m_phys;
+  Ptr<MobilityStore> m_store;
+  std::vector<uint32_t> m_storeIndex;  // PHY -> store index
+  std::map<const MobilityModel *, uint32_t> m_phyOfMobility;
+  std::unordered_map<const YansWifiPhy *, uint32_t> m_phyIndex;
+  double m_minRxMarginDbm;      // lowest RxSensitivity - RxGain over the PHYs
+  std::map<double, double> m_rangeCache;
+
+  std::unordered_map<int64_t, std::vector<uint32_t> > m_grid;
+  std::vector<int64_t> m_cellOf;
+  int64_t m_minX, m_maxX, m_minY, m_maxY;
+  double m_maxSpeed;
+  Time m_lastRebin;
+  bool m_binned;
+  std::vector<uint32_t> m_candidates;
+
+  FriisBatchKernel m_kernel;
+  bool m_batchable;             // lone Friis loss and constant-speed delay
+  double m_delaySpeed;
+  std::vector<uint32_t> m_rx;   // receivers of the current batch
+  std::vector<double> m_rxX, m_rxY, m_rxZ;
+  std::vector<double> m_rxDistance;
+  std::vector<double> m_rxPowerDbm;
+
+  uint64_t m_scheduled;
+  uint64_t m_culled;
+  uint64_t m_batched;
+  uint64_t m_mismatches;
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_YANS_WIFI_CHANNEL_H */
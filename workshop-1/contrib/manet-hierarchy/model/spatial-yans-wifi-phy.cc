@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "spatial-yans-wifi-phy.h"
+#include "spatial-yans-wifi-channel.h"
+
+#include "ns3/log.h"
+#include "ns3/wifi-ppdu.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialYansWifiPhy");
+
+NS_OBJECT_ENSURE_REGISTERED (SpatialYansWifiPhy);
+
+TypeId SpatialYansWifiPhy::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::SpatialYansWifiPhy")
+    .SetParent<YansWifiPhy> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<SpatialYansWifiPhy> ()
+  ;
+  return tid;
+}
+
+SpatialYansWifiPhy::SpatialYansWifiPhy ()
+  : m_channelChecked (false)
+{
+}
+
+SpatialYansWifiPhy::~SpatialYansWifiPhy () {
+}
+
+void SpatialYansWifiPhy::DoDispose (void) {
+  m_spatialChannel = 0;
+  YansWifiPhy::DoDispose ();
+}
+
+void SpatialYansWifiPhy::StartTx (Ptr<WifiPpdu> ppdu) {
+  if (!m_channelChecked) {
+    m_spatialChannel = DynamicCast<SpatialYansWifiChannel> (GetChannel ());
+    m_channelChecked = true;
+  }
+  if (m_spatialChannel == 0) {
+    YansWifiPhy::StartTx (ppdu);
+    return;
+  }
+  m_spatialChannel->Send (this, ppdu, GetTxPowerForTransmission (ppdu) + GetTxGain ());
+}
+
+} // namespace ns3
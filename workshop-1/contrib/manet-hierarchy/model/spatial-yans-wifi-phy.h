@@ -0,0 +1,34 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SPATIAL_YANS_WIFI_PHY_H
+#define SPATIAL_YANS_WIFI_PHY_H
+
+#include "ns3/yans-wifi-phy.h"
+
+namespace ns3 {
+
+class SpatialYansWifiChannel;
+
+/*
+ * YansWifiPhy that transmits through SpatialYansWifiChannel::Send when it is
+ * attached to one (YansWifiChannel::Send is not virtual). On a plain
+ * YansWifiChannel it behaves exactly like YansWifiPhy.
+ */
+class SpatialYansWifiPhy : public YansWifiPhy {
+public:
+  static TypeId GetTypeId (void);
+  SpatialYansWifiPhy ();
+  virtual ~SpatialYansWifiPhy ();
+
+  void StartTx (Ptr<WifiPpdu> ppdu) override;
+
+protected:
+  void DoDispose (void) override;
+
+private:
+  Ptr<SpatialYansWifiChannel> m_spatialChannel;
+  bool m_channelChecked;
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_YANS_WIFI_PHY_H */
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "workload-application.h"
+
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "workload-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WorkloadApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (WorkloadApplication);
+
+TypeId WorkloadApplication::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::WorkloadApplication")
+    .SetParent<Application> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<WorkloadApplication> ()
+    .AddAttribute ("Port",
+                   "UDP port every flow is sent from and to.",
+                   UintegerValue (5000),
+                   MakeUintegerAccessor (&WorkloadApplication::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("ParetoShape",
+                   "Shape of the PARETO on and off periods, above 1.",
+                   DoubleValue (1.5),
+                   MakeDoubleAccessor (&WorkloadApplication::m_paretoShape),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("MeanOnTime",
+                   "Mean length of a PARETO on period.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&WorkloadApplication::m_meanOnTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("MeanOffTime",
+                   "Mean length of a PARETO off period.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&WorkloadApplication::m_meanOffTime),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Tx",
+                     "A packet of a flow was handed to the socket.",
+                     MakeTraceSourceAccessor (&WorkloadApplication::m_txTrace),
+                     "ns3::WorkloadApplication::FlowTracedCallback")
+    .AddTraceSource ("Rx",
+                     "A packet of a flow was received.",
+                     MakeTraceSourceAccessor (&WorkloadApplication::m_rxTrace),
+                     "ns3::WorkloadApplication::FlowTracedCallback")
+  ;
+  return tid;
+}
+
+WorkloadApplication::WorkloadApplication ()
+  : m_port (5000),
+    m_paretoShape (1.5)
+{
+  m_phase = CreateObject<UniformRandomVariable> ();
+  m_exponential = CreateObject<ExponentialRandomVariable> ();
+  m_pareto = CreateObject<ParetoRandomVariable> ();
+}
+
+WorkloadApplication::~WorkloadApplication () {
+}
+
+void WorkloadApplication::DoDispose (void) {
+  m_socket = 0;
+  m_flows.clear ();
+  Application::DoDispose ();
+}
+
+void WorkloadApplication::AddFlow (uint32_t flow, Ipv4Address destination, Arrival arrival, DataRate rate, uint32_t packetSize) {
+  NS_ABORT_MSG_IF (rate.GetBitRate () == 0, "Flow " << flow << " has no rate");
+  NS_ABORT_MSG_IF (packetSize == 0, "Flow " << flow << " has empty packets");
+  Flow f;
+  f.id = flow;
+  f.destination = destination;
+  f.arrival = arrival;
+  f.packetSize = packetSize;
+  f.interval = rate.CalculateBytesTxTime (packetSize).GetSeconds ();
+  m_flows.push_back (f);
+}
+
+uint32_t WorkloadApplication::GetNFlows (void) const {
+  return m_flows.size ();
+}
+
+int64_t WorkloadApplication::AssignStreams (int64_t stream) {
+  m_phase->SetStream (stream);
+  m_exponential->SetStream (stream + 1);
+  m_pareto->SetStream (stream + 2);
+  return 3;
+}
+
+WorkloadApplication::Arrival WorkloadApplication::ParseArrival (const std::string &name) {
+  if (name == "poisson") {
+    return POISSON;
+  }
+  if (name == "pareto") {
+    return PARETO;
+  }
+  NS_ABORT_MSG_IF (name != "cbr", "Unknown arrival process \"" << name << "\", poisson|pareto|cbr");
+  return CBR;
+}
+
+std::string WorkloadApplication::GetArrivalName (Arrival arrival) {
+  switch (arrival) {
+    case POISSON:
+      return "poisson";
+    case PARETO:
+      return "pareto";
+    case CBR:
+      return "cbr";
+  }
+  return "unknown";
+}
+
+void WorkloadApplication::StartApplication (void) {
+  NS_ABORT_MSG_IF (m_paretoShape <= 1, "ParetoShape must be above 1 for the periods to have a mean");
+  if (m_socket == 0) {
+    m_socket = Socket::CreateSocket (GetNode (), UdpSocketFactory::GetTypeId ());
+    NS_ABORT_MSG_IF (m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port)) != 0,
+                     "Node " << GetNode ()->GetId () << " cannot bind the workload port " << m_port);
+    m_socket->SetRecvCallback (MakeCallback (&WorkloadApplication::Receive, this));
+    // Lets the sink tell the hop count from the TTL left
+    m_socket->SetIpRecvTtl (true);
+  }
+  // Spread the first packets so that flows do not start in lockstep
+  for (uint32_t i = 0; i < m_flows.size (); i++) {
+    Flow &flow = m_flows[i];
+    Time first;
+    switch (flow.arrival) {
+      case POISSON:
+        first = Seconds (m_exponential->GetValue (flow.interval, 0));
+        break;
+      case PARETO:
+        first = DrawPareto (m_meanOffTime);
+        flow.onUntil = Simulator::Now () + first + DrawPareto (m_meanOnTime);
+        break;
+      case CBR:
+        first = Seconds (m_phase->GetValue (0, flow.interval));
+        break;
+    }
+    flow.event = Simulator::Schedule (first, &WorkloadApplication::Send, this, i);
+  }
+}
+
+void WorkloadApplication::StopApplication (void) {
+  for (uint32_t i = 0; i < m_flows.size (); i++) {
+    m_flows[i].event.Cancel ();
+  }
+  if (m_socket != 0) {
+    m_socket->Close ();
+    m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    m_socket = 0;
+  }
+}
+
+void WorkloadApplication::Send (uint32_t index) {
+  Flow &flow = m_flows[index];
+  Ptr<Packet> packet = Create<Packet> (flow.packetSize);
+  packet->AddPacketTag (WorkloadTag (flow.id, Simulator::Now ()));
+  // A packet without a route is still offered load, so it is traced anyway
+  m_socket->SendTo (packet, 0, InetSocketAddress (flow.destination, m_port));
+  m_txTrace (packet, flow.id);
+  flow.event = Simulator::Schedule (NextGap (flow), &WorkloadApplication::Send, this, index);
+}
+
+Time WorkloadApplication::NextGap (Flow &flow) {
+  switch (flow.arrival) {
+    case POISSON:
+      return Seconds (m_exponential->GetValue (flow.interval, 0));
+    case PARETO:
+      {
+        Time next = Simulator::Now () + Seconds (flow.interval);
+        if (next > flow.onUntil) {
+          next = flow.onUntil + DrawPareto (m_meanOffTime);
+          flow.onUntil = next + DrawPareto (m_meanOnTime);
+        }
+        return next - Simulator::Now ();
+      }
+    case CBR:
+      break;
+  }
+  return Seconds (flow.interval);
+}
+
+Time WorkloadApplication::DrawPareto (Time mean) {
+  // The mean of a Pareto variable is scale * shape / (shape - 1)
+  double scale = mean.GetSeconds () * (m_paretoShape - 1) / m_paretoShape;
+  return Seconds (m_pareto->GetValue (scale, m_paretoShape, 0));
+}
+
+void WorkloadApplication::Receive (Ptr<Socket> socket) {
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ())) {
+    WorkloadTag tag;
+    if (packet->PeekPacketTag (tag)) {
+      m_rxTrace (packet, tag.GetFlow ());
+    }
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef WORKLOAD_APPLICATION_H
+#define WORKLOAD_APPLICATION_H
+
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Every workload flow that starts at a node, and the sink of every flow that
+ * ends there, over a single UDP socket. Packets carry their flow and send
+ * time in a WorkloadTag, so a flow costs one entry and one pending event at
+ * its source and nothing at its sink. Received packets keep the tag and a
+ * SocketIpTtlTag for the Rx trace.
+ *
+ * POISSON sends with exponential gaps, CBR with constant ones, both at the
+ * flow's rate. PARETO sends at the flow's rate during on periods and not at
+ * all during off periods, both Pareto distributed around MeanOnTime and
+ * MeanOffTime, so its mean rate is lower by on / (on + off).
+ */
+class WorkloadApplication : public Application {
+public:
+  enum Arrival {
+    POISSON,
+    PARETO,
+    CBR
+  };
+
+  typedef void (*FlowTracedCallback) (Ptr<const Packet> packet, uint32_t flow);
+
+  static TypeId GetTypeId (void);
+  WorkloadApplication ();
+  virtual ~WorkloadApplication ();
+
+  // Flow ids are chosen by the caller and only need to be unique per workload.
+  void AddFlow (uint32_t flow, Ipv4Address destination, Arrival arrival, DataRate rate, uint32_t packetSize);
+  uint32_t GetNFlows (void) const;
+  int64_t AssignStreams (int64_t stream);
+
+  static Arrival ParseArrival (const std::string &name);
+  static std::string GetArrivalName (Arrival arrival);
+
+private:
+  struct Flow {
+    uint32_t id;
+    Ipv4Address destination;
+    Arrival arrival;
+    uint32_t packetSize;
+    double interval;    // s per packet at the flow's rate
+    Time onUntil;       // end of the current on period, PARETO only
+    EventId event;
+  };
+
+  void DoDispose (void) override;
+  void StartApplication (void) override;
+  void StopApplication (void) override;
+  void Send (uint32_t index);
+  // Time from now to the flow's next packet.
+  Time NextGap (Flow &flow);
+  Time DrawPareto (Time mean);
+  void Receive (Ptr<Socket> socket);
+
+  uint16_t m_port;
+  double m_paretoShape;
+  Time m_meanOnTime;
+  Time m_meanOffTime;
+  Ptr<Socket> m_socket;
+  std::vector<Flow> m_flows;
+  Ptr<UniformRandomVariable> m_phase;
+  Ptr<ExponentialRandomVariable> m_exponential;
+  Ptr<ParetoRandomVariable> m_pareto;
+
+  TracedCallback<Ptr<const Packet>, uint32_t> m_txTrace;
+  TracedCallback<Ptr<const Packet>, uint32_t> m_rxTrace;
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_APPLICATION_H */
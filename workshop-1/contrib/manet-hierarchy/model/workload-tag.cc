@@ -0,0 +1,67 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "workload-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (WorkloadTag);
+
+TypeId WorkloadTag::GetTypeId (void) {
+  static TypeId tid = TypeId ("ns3::WorkloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("ManetHierarchy")
+    .AddConstructor<WorkloadTag> ()
+  ;
+  return tid;
+}
+
+TypeId WorkloadTag::GetInstanceTypeId (void) const {
+  return GetTypeId ();
+}
+
+WorkloadTag::WorkloadTag ()
+  : m_flow (0),
+    m_sent (0)
+{
+}
+
+WorkloadTag::WorkloadTag (uint32_t flow, Time sent)
+  : m_flow (flow),
+    m_sent (sent.GetTimeStep ())
+{
+}
+
+void WorkloadTag::SetFlow (uint32_t flow) {
+  m_flow = flow;
+}
+
+uint32_t WorkloadTag::GetFlow (void) const {
+  return m_flow;
+}
+
+void WorkloadTag::SetSent (Time sent) {
+  m_sent = sent.GetTimeStep ();
+}
+
+Time WorkloadTag::GetSent (void) const {
+  return TimeStep (m_sent);
+}
+
+uint32_t WorkloadTag::GetSerializedSize (void) const {
+  return 4 + 8;
+}
+
+void WorkloadTag::Serialize (TagBuffer i) const {
+  i.WriteU32 (m_flow);
+  i.WriteU64 (m_sent);
+}
+
+void WorkloadTag::Deserialize (TagBuffer i) {
+  m_flow = i.ReadU32 ();
+  m_sent = i.ReadU64 ();
+}
+
+void WorkloadTag::Print (std::ostream &os) const {
+  os << "flow=" << m_flow << " sent=" << GetSent ().GetSeconds ();
+}
+
+} // namespace ns3
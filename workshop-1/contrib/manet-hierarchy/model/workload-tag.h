@@ -0,0 +1,40 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef WORKLOAD_TAG_H
+#define WORKLOAD_TAG_H
+
+#include "ns3/nstime.h"
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/*
+ * Flow and send time of a packet, as a packet tag so that every flow can
+ * share one socket per node and the sink can take the one-way delay. Twelve
+ * bytes in the tag list, nothing in the packet itself.
+ */
+class WorkloadTag : public Tag {
+public:
+  static TypeId GetTypeId (void);
+  TypeId GetInstanceTypeId (void) const override;
+
+  WorkloadTag ();
+  WorkloadTag (uint32_t flow, Time sent);
+
+  void SetFlow (uint32_t flow);
+  uint32_t GetFlow (void) const;
+  void SetSent (Time sent);
+  Time GetSent (void) const;
+
+  uint32_t GetSerializedSize (void) const override;
+  void Serialize (TagBuffer i) const override;
+  void Deserialize (TagBuffer i) override;
+  void Print (std::ostream &os) const override;
+
+private:
+  uint32_t m_flow;
+  int64_t m_sent;   // time steps
+};
+
+} // namespace ns3
+
+#endif /* WORKLOAD_TAG_H */
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/friis-batch-kernel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/*
+ * FriisBatchKernel::Compute against FriisPropagationLossModel::CalcRxPower
+ * over random geometries, powers and batch sizes, compared for exact
+ * equality. Batch sizes that are not a multiple of the vector width cover
+ * the scalar tail as well.
+ */
+class FriisBatchKernelTestCase : public TestCase {
+public:
+  FriisBatchKernelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckBatch (Ptr<FriisPropagationLossModel> friis, const Vector &tx, double txPowerDbm,
+                   const std::vector<Vector> &rx);
+};
+
+FriisBatchKernelTestCase::FriisBatchKernelTestCase ()
+  : TestCase ("Batched Friis rx power is bit-identical to the per-pair model")
+{
+}
+
+void FriisBatchKernelTestCase::CheckBatch (Ptr<FriisPropagationLossModel> friis, const Vector &tx,
+                                           double txPowerDbm, const std::vector<Vector> &rx) {
+  FriisBatchKernel kernel;
+  kernel.Configure (friis);
+  std::size_t n = rx.size ();
+  std::vector<double> x (n), y (n), z (n), distance (n), rxPower (n);
+  for (std::size_t i = 0; i < n; i++) {
+    x[i] = rx[i].x;
+    y[i] = rx[i].y;
+    z[i] = rx[i].z;
+  }
+  kernel.Compute (tx, txPowerDbm, n, x.data (), y.data (), z.data (), distance.data (), rxPower.data ());
+
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (tx);
+  for (std::size_t i = 0; i < n; i++) {
+    b->SetPosition (rx[i]);
+    NS_TEST_EXPECT_MSG_EQ (distance[i], a->GetDistanceFrom (b), "Distance to receiver " << i << " of " << n);
+    NS_TEST_EXPECT_MSG_EQ (rxPower[i], friis->CalcRxPower (txPowerDbm, a, b), "Rx power of receiver " << i << " of " << n);
+  }
+}
+
+void FriisBatchKernelTestCase::DoRun (void) {
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  double frequencies[] = {2.4e9, 5.18e9, 915e6};
+  double systemLosses[] = {1.0, 1.7};
+  std::size_t sizes[] = {1, 3, 4, 5, 17, 64, 257};
+  for (std::size_t f = 0; f < sizeof (frequencies) / sizeof (frequencies[0]); f++) {
+    for (std::size_t l = 0; l < sizeof (systemLosses) / sizeof (systemLosses[0]); l++) {
+      Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+      friis->SetFrequency (frequencies[f]);
+      friis->SetSystemLoss (systemLosses[l]);
+      friis->SetMinLoss (l == 0 ? 0.0 : 40.0);
+      for (std::size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); s++) {
+        // Areas from a few metres, where MinLoss kicks in, to kilometres
+        double side = rng->GetValue (1.0, 5000.0);
+        Vector tx (rng->GetValue (0, side), rng->GetValue (0, side), rng->GetValue (0, 10));
+        std::vector<Vector> rx;
+        for (std::size_t i = 0; i < sizes[s]; i++) {
+          rx.push_back (Vector (rng->GetValue (0, side), rng->GetValue (0, side), rng->GetValue (0, 10)));
+        }
+        // A co-located receiver takes the zero-distance branch
+        if (sizes[s] > 2) {
+          rx[1] = tx;
+        }
+        CheckBatch (friis, tx, rng->GetValue (-10.0, 30.0), rx);
+      }
+    }
+  }
+}
+
+class FriisBatchKernelTestSuite : public TestSuite {
+public:
+  FriisBatchKernelTestSuite ();
+};
+
+FriisBatchKernelTestSuite::FriisBatchKernelTestSuite ()
+  : TestSuite ("friis-batch-kernel", UNIT)
+{
+  AddTestCase (new FriisBatchKernelTestCase, TestCase::QUICK);
+}
+
+static FriisBatchKernelTestSuite g_friisBatchKernelTestSuite;
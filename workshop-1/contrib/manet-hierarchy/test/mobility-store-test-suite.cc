@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-store.h"
+#include "ns3/node-container.h"
+#include "ns3/pointer.h"
+#include "ns3/position-allocator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <limits>
+
+using namespace ns3;
+
+/*
+ * MobilityStore positions against the per-node GetPosition () of
+ * RandomWaypoint nodes, over walks and pauses. The store evaluates its leg
+ * arrays while the models accumulate their displacement, so they only
+ * agree to rounding.
+ */
+class MobilityStoreTestCase : public TestCase {
+public:
+  MobilityStoreTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (void);
+
+  static const double SIDE;
+  static const double TOLERANCE;
+
+  NodeContainer m_nodes;
+  Ptr<MobilityStore> m_store;
+  uint32_t m_checks;
+};
+
+const double MobilityStoreTestCase::SIDE = 300.0;
+const double MobilityStoreTestCase::TOLERANCE = 1e-6;
+
+MobilityStoreTestCase::MobilityStoreTestCase ()
+  : TestCase ("MobilityStore positions match the per-node mobility models"),
+    m_checks (0)
+{
+}
+
+void MobilityStoreTestCase::Check (void) {
+  // A single node first, before the arrays are evaluated at this time
+  uint32_t s = m_checks % m_store->GetN ();
+  Vector single = m_store->GetPosition (s);
+  m_store->Update ();
+  const double *x = m_store->GetX ();
+  const double *y = m_store->GetY ();
+  const double *z = m_store->GetZ ();
+  for (uint32_t i = 0; i < m_store->GetN (); i++) {
+    Vector expected = m_store->GetMobility (i)->GetPosition ();
+    NS_TEST_EXPECT_MSG_EQ_TOL (x[i], expected.x, TOLERANCE, "x of node " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+    NS_TEST_EXPECT_MSG_EQ_TOL (y[i], expected.y, TOLERANCE, "y of node " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+    NS_TEST_EXPECT_MSG_EQ_TOL (z[i], expected.z, TOLERANCE, "z of node " << i << " at " << Simulator::Now ().GetSeconds () << " s");
+    NS_TEST_EXPECT_MSG_EQ ((x[i] >= -TOLERANCE && x[i] <= SIDE + TOLERANCE && y[i] >= -TOLERANCE && y[i] <= SIDE + TOLERANCE),
+                           true, "Node " << i << " left the bounds");
+  }
+  NS_TEST_EXPECT_MSG_EQ_TOL (single.x, x[s], TOLERANCE, "Single evaluation of node " << s);
+  NS_TEST_EXPECT_MSG_EQ_TOL (single.y, y[s], TOLERANCE, "Single evaluation of node " << s);
+  m_checks++;
+}
+
+void MobilityStoreTestCase::DoRun (void) {
+  m_nodes.Create (30);
+  ObjectFactory pos;
+  pos.SetTypeId ("ns3::RandomRectanglePositionAllocator");
+  pos.Set ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
+  pos.Set ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=300.0]"));
+  Ptr<PositionAllocator> positions = pos.Create ()->GetObject<PositionAllocator> ();
+  positions->AssignStreams (1);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::RandomWaypointMobilityModel",
+                             "Speed", StringValue ("ns3::UniformRandomVariable[Min=1.0|Max=20.0]"),
+                             "Pause", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2.0]"),
+                             "PositionAllocator", PointerValue (positions));
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (m_nodes);
+  mobility.AssignStreams (m_nodes, 10);
+
+  m_store = CreateObject<MobilityStore> ();
+  m_store->SetBounds (Box (0.0, SIDE, 0.0, SIDE,
+                           -std::numeric_limits<double>::infinity (), std::numeric_limits<double>::infinity ()));
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++) {
+    m_store->Add (m_nodes.Get (i)->GetObject<MobilityModel> ());
+  }
+
+  // Off the whole-second grid, so checks land inside legs as well as on them
+  const uint32_t checks = 200;
+  for (uint32_t k = 0; k < checks; k++) {
+    Simulator::Schedule (Seconds (0.37 * k), &MobilityStoreTestCase::Check, this);
+  }
+  Simulator::Stop (Seconds (0.37 * checks));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_checks, checks, "Every check ran");
+  Simulator::Destroy ();
+  m_store = 0;
+  m_nodes = NodeContainer ();
+}
+
+class MobilityStoreTestSuite : public TestSuite {
+public:
+  MobilityStoreTestSuite ();
+};
+
+MobilityStoreTestSuite::MobilityStoreTestSuite ()
+  : TestSuite ("mobility-store", UNIT)
+{
+  AddTestCase (new MobilityStoreTestCase, TestCase::QUICK);
+}
+
+static MobilityStoreTestSuite g_mobilityStoreTestSuite;
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/mobility-store.h"
+#include "ns3/oracle-routing-table.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/*
+ * OracleRoutingTable's incremental updates against a full BFS from scratch
+ * on a random moving graph: after every update, each pair must be at the
+ * reference hop distance, and Lookup must return a neighbor one hop closer
+ * to the destination.
+ */
+class OracleRoutingTableTestCase : public TestCase {
+public:
+  OracleRoutingTableTestCase ();
+
+private:
+  struct TestChannel {
+    std::vector<uint32_t> vertices;
+    double range;
+  };
+
+  virtual void DoRun (void);
+  void Move (void);
+  void Check (void);
+  std::vector<std::vector<uint32_t> > ReferenceNeighbors (void);
+  std::vector<uint16_t> ReferenceBfs (const std::vector<std::vector<uint32_t> > &neighbors, uint32_t source);
+
+  static const uint32_t N = 40;
+  static const double SIDE;
+  static const double STEP;
+
+  Ptr<UniformRandomVariable> m_rng;
+  Ptr<MobilityStore> m_store;
+  std::vector<Ptr<ConstantPositionMobilityModel> > m_nodes;
+  std::vector<TestChannel> m_channels;
+  std::map<Ipv4Address, uint32_t> m_addressVertex;
+  std::vector<std::vector<Ipv4Address> > m_addresses;   // by channel, vertex
+  Ptr<OracleRoutingTable> m_table;
+  uint32_t m_checks;
+};
+
+const double OracleRoutingTableTestCase::SIDE = 500.0;
+const double OracleRoutingTableTestCase::STEP = 40.0;
+
+OracleRoutingTableTestCase::OracleRoutingTableTestCase ()
+  : TestCase ("Incremental oracle routes match a full BFS on a moving graph"),
+    m_checks (0)
+{
+}
+
+std::vector<std::vector<uint32_t> > OracleRoutingTableTestCase::ReferenceNeighbors (void) {
+  std::vector<std::vector<uint32_t> > neighbors (N);
+  for (std::size_t c = 0; c < m_channels.size (); c++) {
+    const std::vector<uint32_t> &vertices = m_channels[c].vertices;
+    for (std::size_t i = 0; i < vertices.size (); i++) {
+      for (std::size_t j = i + 1; j < vertices.size (); j++) {
+        Vector a = m_nodes[vertices[i]]->GetPosition ();
+        Vector b = m_nodes[vertices[j]]->GetPosition ();
+        double dx = a.x - b.x;
+        double dy = a.y - b.y;
+        double dz = a.z - b.z;
+        if (dx * dx + dy * dy + dz * dz <= m_channels[c].range * m_channels[c].range) {
+          neighbors[vertices[i]].push_back (vertices[j]);
+          neighbors[vertices[j]].push_back (vertices[i]);
+        }
+      }
+    }
+  }
+  return neighbors;
+}
+
+std::vector<uint16_t> OracleRoutingTableTestCase::ReferenceBfs (const std::vector<std::vector<uint32_t> > &neighbors,
+                                                                uint32_t source) {
+  std::vector<uint16_t> dist (N, 0xffff);
+  std::vector<uint32_t> queue (1, source);
+  dist[source] = 0;
+  for (std::size_t head = 0; head < queue.size (); head++) {
+    uint32_t u = queue[head];
+    for (std::size_t k = 0; k < neighbors[u].size (); k++) {
+      uint32_t v = neighbors[u][k];
+      if (dist[v] == 0xffff) {
+        dist[v] = dist[u] + 1;
+        queue.push_back (v);
+      }
+    }
+  }
+  return dist;
+}
+
+// Small steps, so most updates go through the incremental repairs
+void OracleRoutingTableTestCase::Move (void) {
+  for (uint32_t i = 0; i < N; i++) {
+    Vector p = m_nodes[i]->GetPosition ();
+    p.x = std::min (SIDE, std::max (0.0, p.x + m_rng->GetValue (-STEP, STEP)));
+    p.y = std::min (SIDE, std::max (0.0, p.y + m_rng->GetValue (-STEP, STEP)));
+    m_nodes[i]->SetPosition (p);
+  }
+}
+
+void OracleRoutingTableTestCase::Check (void) {
+  std::vector<std::vector<uint32_t> > neighbors = ReferenceNeighbors ();
+  for (uint32_t s = 0; s < N; s++) {
+    std::vector<uint16_t> dist = ReferenceBfs (neighbors, s);
+    for (uint32_t d = 0; d < N; d++) {
+      NS_TEST_EXPECT_MSG_EQ (m_table->GetDistance (s, d), dist[d],
+                             "Hops from " << s << " to " << d << " at " << Simulator::Now ().GetSeconds () << " s");
+      if (d == s) {
+        continue;
+      }
+      Ipv4Address nextHop;
+      uint32_t interface;
+      bool found = m_table->Lookup (s, m_addresses[0][d], nextHop, interface);
+      NS_TEST_EXPECT_MSG_EQ (found, dist[d] != 0xffff, "Route from " << s << " to " << d);
+      if (!found || dist[d] == 0xffff) {
+        continue;
+      }
+      std::map<Ipv4Address, uint32_t>::const_iterator hop = m_addressVertex.find (nextHop);
+      NS_TEST_ASSERT_MSG_EQ (hop != m_addressVertex.end (), true, "Next hop " << nextHop << " is no vertex");
+      NS_TEST_EXPECT_MSG_EQ (std::count (neighbors[s].begin (), neighbors[s].end (), hop->second), 1,
+                             "Next hop " << hop->second << " of " << s << " is not in range");
+      NS_TEST_EXPECT_MSG_EQ (ReferenceBfs (neighbors, hop->second)[d] + 1, dist[d],
+                             "Next hop " << hop->second << " of " << s << " is not closer to " << d);
+    }
+  }
+  m_checks++;
+}
+
+void OracleRoutingTableTestCase::DoRun (void) {
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (7);
+  m_store = CreateObject<MobilityStore> ();
+  for (uint32_t i = 0; i < N; i++) {
+    Ptr<ConstantPositionMobilityModel> node = CreateObject<ConstantPositionMobilityModel> ();
+    node->SetPosition (Vector (m_rng->GetValue (0, SIDE), m_rng->GetValue (0, SIDE), 0.0));
+    m_store->Add (node);
+    m_nodes.push_back (node);
+  }
+
+  // A flat channel over everyone, plus a longer-range one over the first ten
+  TestChannel flat;
+  flat.range = 120.0;
+  for (uint32_t i = 0; i < N; i++) {
+    flat.vertices.push_back (i);
+  }
+  TestChannel upper;
+  upper.range = 300.0;
+  for (uint32_t i = 0; i < 10; i++) {
+    upper.vertices.push_back (i);
+  }
+  m_channels.push_back (flat);
+  m_channels.push_back (upper);
+
+  m_table = CreateObject<OracleRoutingTable> ();
+  m_table->SetAttribute ("Interval", TimeValue (Seconds (1.0)));
+  m_table->SetMobilityStore (m_store);
+  m_addresses.resize (m_channels.size ());
+  for (uint32_t c = 0; c < m_channels.size (); c++) {
+    std::vector<uint32_t> interfaces;
+    for (std::size_t i = 0; i < m_channels[c].vertices.size (); i++) {
+      uint32_t v = m_channels[c].vertices[i];
+      Ipv4Address address (((10u << 24) | ((c + 1) << 8)) + v + 1);
+      m_addresses[c].push_back (address);
+      m_addressVertex[address] = v;
+      interfaces.push_back (c + 1);
+    }
+    m_table->AddChannel (m_channels[c].vertices, interfaces, m_addresses[c], m_channels[c].range);
+  }
+  m_table->Start ();
+
+  // Updates run at whole seconds, moves halfway between them
+  const uint32_t updates = 60;
+  for (uint32_t k = 0; k < updates; k++) {
+    Simulator::Schedule (Seconds (k + 0.25), &OracleRoutingTableTestCase::Check, this);
+    Simulator::Schedule (Seconds (k + 0.5), &OracleRoutingTableTestCase::Move, this);
+  }
+  Simulator::Stop (Seconds (updates));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_checks, updates, "Every update checked");
+  NS_TEST_EXPECT_MSG_LT (m_table->GetNRebuilt (), static_cast<uint64_t> (N) * updates,
+                         "Some updates went through the incremental path");
+  Simulator::Destroy ();
+  m_table = 0;
+  m_store = 0;
+  m_nodes.clear ();
+}
+
+class OracleRoutingTableTestSuite : public TestSuite {
+public:
+  OracleRoutingTableTestSuite ();
+};
+
+OracleRoutingTableTestSuite::OracleRoutingTableTestSuite ()
+  : TestSuite ("oracle-routing-table", UNIT)
+{
+  AddTestCase (new OracleRoutingTableTestCase, TestCase::QUICK);
+}
+
+static OracleRoutingTableTestSuite g_oracleRoutingTableTestSuite;
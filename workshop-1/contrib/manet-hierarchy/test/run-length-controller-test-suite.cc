@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/online-statistics.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/replication-runner.h"
+#include "ns3/run-length-controller.h"
+#include "ns3/test.h"
+
+#include <cmath>
+
+using namespace ns3;
+
+/*
+ * Seeded AR(1) series x = MEAN + PHI (x' - MEAN) + e with unit normal
+ * noise, started from its stationary distribution. Its samples are as
+ * correlated as a busy queue's per-interval rates, so plain sample
+ * variances would give intervals far too narrow.
+ */
+class Ar1Series {
+public:
+  Ar1Series (int64_t stream);
+  double Next (void);
+
+  static const double MEAN;
+  static const double PHI;
+
+private:
+  Ptr<NormalRandomVariable> m_noise;
+  double m_x;
+};
+
+const double Ar1Series::MEAN = 10.0;
+const double Ar1Series::PHI = 0.8;
+
+Ar1Series::Ar1Series (int64_t stream)
+  : m_noise (CreateObject<NormalRandomVariable> ())
+{
+  m_noise->SetStream (stream);
+  m_x = MEAN + m_noise->GetValue () / std::sqrt (1 - PHI * PHI);
+}
+
+double Ar1Series::Next (void) {
+  m_x = MEAN + PHI * (m_x - MEAN) + m_noise->GetValue ();
+  return m_x;
+}
+
+/*
+ * The 95% interval of BatchMeans over many independent AR(1) runs must
+ * cover the true mean about 95% of the time. The bounds leave room for
+ * the binomial spread of the replications and the slight undercoverage
+ * of batches that are still a little correlated.
+ */
+class BatchMeansCoverageTestCase : public TestCase {
+public:
+  BatchMeansCoverageTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BatchMeansCoverageTestCase::BatchMeansCoverageTestCase ()
+  : TestCase ("BatchMeans intervals cover the mean of a correlated series")
+{
+}
+
+void BatchMeansCoverageTestCase::DoRun (void) {
+  const uint32_t replications = 400;
+  const uint32_t samples = 2048;
+  uint32_t covered = 0;
+  for (uint32_t r = 0; r < replications; r++) {
+    Ar1Series series (r);
+    BatchMeans batches;
+    for (uint32_t i = 0; i < samples; i++) {
+      batches.Add (series.Next ());
+    }
+    WelfordAccumulator statistics = batches.GetBatchStatistics ();
+    NS_TEST_ASSERT_MSG_GT (statistics.GetCount (), 19, "Merging keeps at least half of the batches");
+    double halfWidth = ReplicationRunner::StudentT95 (statistics.GetCount () - 1) * statistics.GetStdDev ()
+      / std::sqrt (static_cast<double> (statistics.GetCount ()));
+    if (std::fabs (statistics.GetMean () - Ar1Series::MEAN) <= halfWidth) {
+      covered++;
+    }
+  }
+  double coverage = static_cast<double> (covered) / replications;
+  NS_TEST_EXPECT_MSG_GT (coverage, 0.88, "Batch-means intervals cover too rarely");
+  NS_TEST_EXPECT_MSG_LT (coverage, 0.99, "Batch-means intervals are too wide");
+}
+
+/*
+ * RunLengthController on one AR(1) metric: after every sample, IsPrecise
+ * must agree with the relative half-width of a BatchMeans fed the same
+ * samples, so the run stops at the first sample that reaches the target
+ * and the stopped estimate is within reach of the true mean. Reset and a
+ * zero target must never stop.
+ */
+class RunLengthStoppingTestCase : public TestCase {
+public:
+  RunLengthStoppingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RunLengthStoppingTestCase::RunLengthStoppingTestCase ()
+  : TestCase ("RunLengthController stops at the target precision")
+{
+}
+
+void RunLengthStoppingTestCase::DoRun (void) {
+  const double target = 0.01;
+  const uint32_t minBatches = 10;
+  const uint64_t batchSize = 5;
+  const uint32_t cap = 200000;
+
+  RunLengthController controller;
+  controller.SetTarget (target);
+  controller.SetMinBatches (minBatches);
+  controller.SetBatchSize (batchSize);
+  uint32_t metric = controller.AddMetric ("ar1");
+  RunLengthController never;
+  never.SetMinBatches (minBatches);
+  never.SetBatchSize (batchSize);
+  uint32_t neverMetric = never.AddMetric ("ar1");
+  BatchMeans mirror (2 * minBatches, batchSize);
+
+  Ar1Series series (1000);
+  uint32_t n = 0;
+  uint32_t disagreements = 0;
+  double mean = 0.0;
+  double relative = 0.0;
+  while (n < cap) {
+    double x = series.Next ();
+    controller.Add (metric, x);
+    never.Add (neverMetric, x);
+    mirror.Add (x);
+    n++;
+
+    WelfordAccumulator statistics = mirror.GetBatchStatistics ();
+    bool precise = false;
+    if (statistics.GetCount () >= minBatches) {
+      mean = statistics.GetMean ();
+      relative = ReplicationRunner::StudentT95 (statistics.GetCount () - 1) * statistics.GetStdDev ()
+        / std::sqrt (static_cast<double> (statistics.GetCount ())) / std::fabs (mean);
+      precise = relative <= target;
+    }
+    if (precise != controller.IsPrecise ()) {
+      disagreements++;
+    }
+    if (controller.IsPrecise ()) {
+      break;
+    }
+  }
+
+  NS_TEST_EXPECT_MSG_EQ (disagreements, 0, "IsPrecise disagrees with the batch-means half-width");
+  NS_TEST_ASSERT_MSG_LT (n, cap, "The run never reached the target precision");
+  NS_TEST_EXPECT_MSG_GT (n, minBatches * batchSize - 1, "Stopped before the minimum number of batches");
+  NS_TEST_EXPECT_MSG_EQ ((relative <= target), true, "Stopped above the target");
+  NS_TEST_EXPECT_MSG_EQ_TOL (mean, Ar1Series::MEAN, 3 * target * Ar1Series::MEAN, "Stopped estimate is off the mean");
+  NS_TEST_EXPECT_MSG_EQ (never.IsPrecise (), false, "A zero target stopped the run");
+
+  controller.Reset ();
+  NS_TEST_EXPECT_MSG_EQ (controller.IsPrecise (), false, "Reset kept the samples");
+}
+
+class RunLengthControllerTestSuite : public TestSuite {
+public:
+  RunLengthControllerTestSuite ();
+};
+
+RunLengthControllerTestSuite::RunLengthControllerTestSuite ()
+  : TestSuite ("run-length-controller", UNIT)
+{
+  AddTestCase (new BatchMeansCoverageTestCase, TestCase::QUICK);
+  AddTestCase (new RunLengthStoppingTestCase, TestCase::QUICK);
+}
+
+static RunLengthControllerTestSuite g_runLengthControllerTestSuite;
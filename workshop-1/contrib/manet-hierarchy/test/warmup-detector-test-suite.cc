@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include "ns3/warmup-detector.h"
+
+using namespace ns3;
+
+/*
+ * MSER-5 on synthetic one-sample-per-second series: a steady level of 10
+ * with seeded unit normal noise, optionally behind a transient that falls
+ * linearly from 30 to the level over the first TRANSIENT seconds. Single
+ * runs scatter, so each case looks at many seeded runs and bounds the
+ * share that lands near the expected truncation point.
+ */
+class WarmupDetectorTestCase : public TestCase {
+public:
+  WarmupDetectorTestCase (bool transient);
+
+private:
+  virtual void DoRun (void);
+  // Truncation time of one run, -1 when not detected.
+  double Truncate (int64_t stream, uint32_t samples);
+
+  static const double LEVEL;
+  static const double TRANSIENT;
+
+  bool m_transient;
+};
+
+const double WarmupDetectorTestCase::LEVEL = 10.0;
+const double WarmupDetectorTestCase::TRANSIENT = 100.0;
+
+WarmupDetectorTestCase::WarmupDetectorTestCase (bool transient)
+  : TestCase (transient ? "MSER-5 truncates at the end of a known transient"
+              : "MSER-5 barely truncates a series without a transient"),
+    m_transient (transient)
+{
+}
+
+double WarmupDetectorTestCase::Truncate (int64_t stream, uint32_t samples) {
+  Ptr<NormalRandomVariable> noise = CreateObject<NormalRandomVariable> ();
+  noise->SetStream (stream);
+  WarmupDetector detector;
+  uint32_t series = detector.AddSeries ("synthetic");
+  for (uint32_t i = 0; i < samples; i++) {
+    double bias = m_transient && i < TRANSIENT ? 2 * LEVEL * (1 - i / TRANSIENT) : 0.0;
+    detector.Add (series, i, LEVEL + bias + noise->GetValue ());
+  }
+  return detector.IsDetected () ? detector.GetTruncationTime () : -1.0;
+}
+
+void WarmupDetectorTestCase::DoRun (void) {
+  const uint32_t runs = 100;
+  const uint32_t samples = 1000;
+  uint32_t undetected = 0;
+  uint32_t early = 0;
+  uint32_t near = 0;
+  for (uint32_t r = 0; r < runs; r++) {
+    double t = Truncate (r, samples);
+    if (t < 0) {
+      undetected++;
+    }
+    else if (m_transient) {
+      // The bias is still several noise deviations before 85 s
+      if (t < 85) {
+        early++;
+      }
+      if (t >= 85 && t <= TRANSIENT + 25) {
+        near++;
+      }
+    }
+    else if (t <= 25) {
+      near++;
+    }
+  }
+  NS_TEST_EXPECT_MSG_EQ (undetected, 0, "A settled series was not detected");
+  NS_TEST_EXPECT_MSG_EQ (early, 0, "Truncated inside the transient");
+  NS_TEST_EXPECT_MSG_GT (near, 85, "Too few runs truncated near the expected point");
+}
+
+class WarmupDetectorTestSuite : public TestSuite {
+public:
+  WarmupDetectorTestSuite ();
+};
+
+WarmupDetectorTestSuite::WarmupDetectorTestSuite ()
+  : TestSuite ("warmup-detector", UNIT)
+{
+  AddTestCase (new WarmupDetectorTestCase (true), TestCase::QUICK);
+  AddTestCase (new WarmupDetectorTestCase (false), TestCase::QUICK);
+}
+
+static WarmupDetectorTestSuite g_warmupDetectorTestSuite;
@@ -0,0 +1,63 @@
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Runs OLSR and cluster routing on 2-layer shapes of 100, 1000 and 5000 nodes.
+int main (int argc, char *argv[]) {
+  uint32_t repetitions = 1;
+  std::string shapes ("10x10;40x25;100x50");
+  std::string protocols ("1,5");
+  double totalTime = 60.0;
+  std::string output ("cluster-scaling-benchmark.csv");
+  std::string log ("cluster-scaling-benchmark.log");
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("repetitions", "Runs of each case", repetitions);
+  cmd.AddValue ("shapes", "Hierarchy shapes as for --layers, separated by ';'", shapes);
+  cmd.AddValue ("protocols", "Protocol numbers to compare, as for --protocol", protocols);
+  cmd.AddValue ("totalTime", "Simulated time of every run in s", totalTime);
+  cmd.AddValue ("output", "CSV with one row per run", output);
+  cmd.AddValue ("log", "File that takes the output of the runs", log);
+  cmd.Parse (argc, argv);
+
+  ScenarioBenchmark benchmark;
+  benchmark.SetRepetitions (repetitions);
+  benchmark.SetLog (log);
+  std::istringstream shapeList (shapes);
+  std::string shape;
+  while (std::getline (shapeList, shape, ';')) {
+    // The last node is a plain member of the last cluster
+    LayerSpec spec = LayerSpec::Parse (shape);
+    std::ostringstream sender;
+    sender << "--sender=" << spec.GetNTotalNodes () - 1;
+    std::ostringstream time;
+    time << "--totalTime=" << totalTime;
+
+    std::istringstream protocolList (protocols);
+    std::string protocol;
+    while (std::getline (protocolList, protocol, ',')) {
+      RoutingProtocolFactory factory;
+      factory.SetProtocol (std::atoi (protocol.c_str ()));
+      std::ostringstream name;
+      name << spec.GetNTotalNodes () << "-" << factory.GetName ();
+      benchmark.AddCase (name.str (), {"--layers=" + shape, sender.str (), time.str (), "--protocol=" + protocol,
+                                       "--countControl=1", "--lean=1", "--flowProbes=endpoints",
+                                       "--CSVfileName=" + name.str () + ".csv"});
+    }
+  }
+
+  std::vector<BenchmarkResult> results = benchmark.Run ([&] (const std::vector<std::string> &args) {
+    RoutingExperiment experiment;
+    std::vector<char *> caseArgv = ScenarioBenchmark::MakeArgv ("cluster-scaling-benchmark", args);
+    std::string CSVfileName = experiment.CommandSetup (caseArgv.size () - 1, caseArgv.data ());
+    RoutingExperiment::WriteCsvHeader (CSVfileName);
+    experiment.Run (3, 7.5, CSVfileName);
+    return experiment.GetFlowSummary ();
+  });
+  ScenarioBenchmark::WriteCsv (results, output);
+}
@@ -0,0 +1,31 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Prints a --metricsFormat=columnar file as the equivalent CSV.
+int main (int argc, char *argv[]) {
+  std::string input ("manet-routing.output.mcol");
+  std::string output;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "Columnar metrics file", input);
+  cmd.AddValue ("output", "CSV file to write, stdout if empty", output);
+  cmd.Parse (argc, argv);
+
+  std::ifstream in (input.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!in, "Cannot open " << input);
+
+  uint64_t rows;
+  if (output.empty ()) {
+    rows = ColumnarMetricsSink::Decode (in, std::cout);
+  }
+  else {
+    std::ofstream out (output.c_str ());
+    rows = ColumnarMetricsSink::Decode (in, out);
+  }
+  std::cerr << rows << " rows" << std::endl;
+}
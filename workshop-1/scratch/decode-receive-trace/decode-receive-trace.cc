@@ -0,0 +1,31 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Turns a --binaryReceiveTrace file back into the "Tiempo recibido" lines.
+int main (int argc, char *argv[]) {
+  std::string input ("manet-routing-compare.rx");
+  std::string output;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "Binary receive trace", input);
+  cmd.AddValue ("output", "Text file to write, stdout if empty", output);
+  cmd.Parse (argc, argv);
+
+  std::ifstream in (input.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!in, "Cannot open " << input);
+
+  uint64_t records;
+  if (output.empty ()) {
+    records = PacketReceiveTrace::Decode (in, std::cout);
+  }
+  else {
+    std::ofstream out (output.c_str ());
+    records = PacketReceiveTrace::Decode (in, out);
+  }
+  std::cerr << records << " records" << std::endl;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Runs one scenario with FlowMonitor probes on every node and only on the
+// endpoints of the measured flow, and compares their cost.
+int main (int argc, char *argv[]) {
+  std::string layers ("6x6");
+  uint32_t sender = 31;
+  uint32_t repetitions = 3;
+  double probeSampleRatio = 0.0;
+  std::string output ("flow-probe-benchmark.csv");
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("layers", "Hierarchy shape of the benchmarked scenario", layers);
+  cmd.AddValue ("sender", "Index of the layer-1 node that sends the flow", sender);
+  cmd.AddValue ("repetitions", "Runs of each case", repetitions);
+  cmd.AddValue ("probeSampleRatio", "Also benchmark endpoints plus this fraction of sampled hops, 0 skips it", probeSampleRatio);
+  cmd.AddValue ("output", "CSV with one row per run", output);
+  cmd.Parse (argc, argv);
+
+  ScenarioBenchmark benchmark;
+  benchmark.SetRepetitions (repetitions);
+  benchmark.AddCase ("all", {"--flowProbes=all", "--CSVfileName=flow-probe-all.csv"});
+  benchmark.AddCase ("endpoints", {"--flowProbes=endpoints", "--CSVfileName=flow-probe-endpoints.csv"});
+  if (probeSampleRatio > 0) {
+    benchmark.AddCase ("sampled", {"--flowProbes=endpoints", "--probeSampleRatio=" + std::to_string (probeSampleRatio),
+                                   "--CSVfileName=flow-probe-sampled.csv"});
+  }
+
+  std::vector<BenchmarkResult> results = benchmark.Run ([&] (const std::vector<std::string> &args) {
+    RoutingExperiment experiment;
+    experiment.SetLayerSpec (LayerSpec::Parse (layers));
+    experiment.SetSenderIndex (sender);
+    std::vector<char *> caseArgv = ScenarioBenchmark::MakeArgv ("flow-probe-benchmark", args);
+    std::string CSVfileName = experiment.CommandSetup (caseArgv.size () - 1, caseArgv.data ());
+    RoutingExperiment::WriteCsvHeader (CSVfileName);
+    experiment.Run (3, 7.5, CSVfileName);
+    return experiment.GetFlowSummary ();
+  });
+  ScenarioBenchmark::WriteCsv (results, output);
+
+  // Cost of the dropped probes per packet of the measured flow
+  double perPacket[2] = {0.0, 0.0};
+  uint32_t runs[2] = {0, 0};
+  for (std::size_t i = 0; i < results.size (); i++) {
+    int k = results[i].name == "all" ? 0 : results[i].name == "endpoints" ? 1 : -1;
+    if (k >= 0 && results[i].flows.txPackets > 0) {
+      perPacket[k] += results[i].wallSeconds * 1e6 / results[i].flows.txPackets;
+      runs[k]++;
+    }
+  }
+  if (runs[0] > 0 && runs[1] > 0) {
+    std::cout << "Endpoint probes save " << perPacket[0] / runs[0] - perPacket[1] / runs[1]
+              << " us of wall clock per sent packet" << std::endl;
+  }
+}
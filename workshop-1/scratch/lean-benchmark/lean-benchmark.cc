@@ -0,0 +1,44 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Runs the six scenario presets with and without --lean.
+int main (int argc, char *argv[]) {
+  uint32_t repetitions = 3;
+  std::string output ("lean-benchmark.csv");
+  std::string log ("lean-benchmark.log");
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("repetitions", "Runs of each case", repetitions);
+  cmd.AddValue ("output", "CSV with one row per run", output);
+  cmd.AddValue ("log", "File that takes the output of the runs", log);
+  cmd.Parse (argc, argv);
+
+  ScenarioBenchmark benchmark;
+  benchmark.SetRepetitions (repetitions);
+  benchmark.SetLog (log);
+  const std::vector<ScenarioPreset> &presets = ScenarioBenchmark::GetScenarioPresets ();
+  for (std::size_t i = 0; i < presets.size (); i++) {
+    std::ostringstream sender;
+    sender << "--sender=" << presets[i].sender;
+    std::vector<std::string> args = {"--layers=" + presets[i].layers, sender.str (),
+                                     "--CSVfileName=" + presets[i].name + "-bench.csv"};
+    benchmark.AddCase (presets[i].name + "-default", args);
+    args.push_back ("--lean=1");
+    benchmark.AddCase (presets[i].name + "-lean", args);
+  }
+
+  std::vector<BenchmarkResult> results = benchmark.Run ([&] (const std::vector<std::string> &args) {
+    RoutingExperiment experiment;
+    std::vector<char *> caseArgv = ScenarioBenchmark::MakeArgv ("lean-benchmark", args);
+    std::string CSVfileName = experiment.CommandSetup (caseArgv.size () - 1, caseArgv.data ());
+    RoutingExperiment::WriteCsvHeader (CSVfileName);
+    experiment.Run (3, 7.5, CSVfileName);
+    return experiment.GetFlowSummary ();
+  });
+  ScenarioBenchmark::WriteCsv (results, output);
+}
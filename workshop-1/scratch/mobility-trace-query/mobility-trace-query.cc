@@ -0,0 +1,42 @@
+#include <iostream>
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Prints positions from a binary mobility trace: one node at one time, or
+// every node each --step seconds when --time is negative.
+int main (int argc, char *argv[]) {
+  std::string input ("manet-routing-compare.mobb");
+  int32_t node = -1;
+  double time = -1.0;
+  double step = 1.0;
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "Binary mobility trace", input);
+  cmd.AddValue ("node", "Trace index of the node, -1 for every node", node);
+  cmd.AddValue ("time", "Time in s, negative to walk the whole trace", time);
+  cmd.AddValue ("step", "Interval in s when walking the trace", step);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (step <= 0, "--step must be positive");
+  MobilityTraceReader reader;
+  reader.Open (input);
+  NS_ABORT_MSG_IF (node >= static_cast<int32_t> (reader.GetNNodes ()), "The trace has " << reader.GetNNodes () << " nodes");
+
+  double start = time < 0 ? reader.GetStart ().GetSeconds () : time;
+  double end = time < 0 ? reader.GetEnd ().GetSeconds () : time;
+  uint32_t first = node < 0 ? 0 : node;
+  uint32_t last = node < 0 ? reader.GetNNodes () : node + 1;
+
+  std::cout << "Time,Node,X,Y,Z,VelocityX,VelocityY,VelocityZ" << std::endl;
+  for (double t = start; t <= end; t += step) {
+    for (uint32_t i = first; i < last; i++) {
+      Vector p = reader.GetPosition (i, Seconds (t));
+      Vector v = reader.GetVelocity (i, Seconds (t));
+      std::cout << t << "," << reader.GetNodeId (i) << "," << p.x << "," << p.y << "," << p.z << ","
+                << v.x << "," << v.y << "," << v.z << std::endl;
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/manet-hierarchy-module.h"
+
+using namespace ns3;
+
+// Runs the six scenario presets under OLSR, AODV, DSDV and DSR.
+int main (int argc, char *argv[]) {
+  uint32_t repetitions = 3;
+  std::string protocols ("1,2,3,4");
+  std::string output ("routing-benchmark.csv");
+  std::string log ("routing-benchmark.log");
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("repetitions", "Runs of each case", repetitions);
+  cmd.AddValue ("protocols", "Protocol numbers to compare, as for --protocol", protocols);
+  cmd.AddValue ("output", "CSV with one row per run", output);
+  cmd.AddValue ("log", "File that takes the output of the runs", log);
+  cmd.Parse (argc, argv);
+
+  ScenarioBenchmark benchmark;
+  benchmark.SetRepetitions (repetitions);
+  benchmark.SetLog (log);
+  const std::vector<ScenarioPreset> &presets = ScenarioBenchmark::GetScenarioPresets ();
+  for (std::size_t i = 0; i < presets.size (); i++) {
+    std::istringstream list (protocols);
+    std::string protocol;
+    while (std::getline (list, protocol, ',')) {
+      RoutingProtocolFactory factory;
+      factory.SetProtocol (std::atoi (protocol.c_str ()));
+      std::ostringstream sender;
+      sender << "--sender=" << presets[i].sender;
+      std::string name = presets[i].name + "-" + factory.GetName ();
+      benchmark.AddCase (name, {"--layers=" + presets[i].layers, sender.str (), "--protocol=" + protocol,
+                                "--countControl=1", "--CSVfileName=" + name + ".csv"});
+    }
+  }
+
+  std::vector<BenchmarkResult> results = benchmark.Run ([&] (const std::vector<std::string> &args) {
+    RoutingExperiment experiment;
+    std::vector<char *> caseArgv = ScenarioBenchmark::MakeArgv ("routing-benchmark", args);
+    std::string CSVfileName = experiment.CommandSetup (caseArgv.size () - 1, caseArgv.data ());
+    RoutingExperiment::WriteCsvHeader (CSVfileName);
+    experiment.Run (3, 7.5, CSVfileName);
+    return experiment.GetFlowSummary ();
+  });
+  ScenarioBenchmark::WriteCsv (results, output);
+}